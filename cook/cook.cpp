@@ -0,0 +1,427 @@
+#define STB_IMAGE_IMPLEMENTATION
+#include <Rendering/CookedTexture.hpp>
+#include <Rendering/PixelOps.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stb_image.hpp>
+#include <string>
+#include <vector>
+
+using namespace Stardust_Celeste::Rendering;
+
+/**
+ * @brief Cook settings, the platform presets fill these in
+ */
+struct CookOptions {
+    u8 format = COOKED_FORMAT_8888;
+    bool swizzle = false;
+    bool pad = false;
+    bool flip = false;
+    bool premultiply = false;
+    // 0 is the full chain
+    u32 mips = 1;
+};
+
+static auto usage() -> void {
+    printf("Usage: sc-cook [options] <input image> <output.sct>\n"
+           "\n"
+           "  --platform pc|vita|3ds|psp  Preset for a platform (default pc)\n"
+           "  --format 8888|4444|5551|565|bc1|bc3\n"
+           "                              Pixel format\n"
+           "  --swizzle                   PSP block swizzle\n"
+           "  --pad                       Pad to power of two dimensions\n"
+           "  --mips <n>                  Mip levels to store, 0 for all\n"
+           "  --flip                      Flip vertically\n"
+           "  --premultiply               Multiply colors by alpha\n");
+}
+
+// Halves an RGBA8 image with a box filter, odd edges are clamped
+static auto downsample(const std::vector<u8> &src, u32 w, u32 h)
+    -> std::vector<u8> {
+    auto dw = std::max(w / 2, 1u);
+    auto dh = std::max(h / 2, 1u);
+    std::vector<u8> dst(dw * dh * 4);
+
+    for (u32 y = 0; y < dh; y++) {
+        auto y0 = std::min(y * 2, h - 1);
+        auto y1 = std::min(y * 2 + 1, h - 1);
+        for (u32 x = 0; x < dw; x++) {
+            auto x0 = std::min(x * 2, w - 1);
+            auto x1 = std::min(x * 2 + 1, w - 1);
+            for (u32 c = 0; c < 4; c++) {
+                u32 sum = src[(y0 * w + x0) * 4 + c] + src[(y0 * w + x1) * 4 + c] +
+                          src[(y1 * w + x0) * 4 + c] + src[(y1 * w + x1) * 4 + c];
+                dst[(y * dw + x) * 4 + c] = static_cast<u8>((sum + 2) / 4);
+            }
+        }
+    }
+
+    return dst;
+}
+
+// Copies a 4x4 block, repeating the edge texels past the image
+static auto gather_block(const std::vector<u8> &rgba, u32 w, u32 h, u32 bx,
+                         u32 by, u32 texels[16]) -> void {
+    auto src = (const u32 *)rgba.data();
+    for (u32 y = 0; y < 4; y++) {
+        auto sy = std::min(by + y, h - 1);
+        for (u32 x = 0; x < 4; x++)
+            texels[y * 4 + x] = src[sy * w + std::min(bx + x, w - 1)];
+    }
+}
+
+static inline auto channel(u32 texel, u32 c) -> int {
+    return static_cast<int>((texel >> (c * 8)) & 0xFF);
+}
+
+static auto color_distance(u32 a, u32 b) -> int {
+    int d = 0;
+    for (u32 c = 0; c < 3; c++) {
+        auto e = channel(a, c) - channel(b, c);
+        d += e * e;
+    }
+    return d;
+}
+
+static auto to_565(u32 texel) -> u16 {
+    auto r = (channel(texel, 0) * 31 + 127) / 255;
+    auto g = (channel(texel, 1) * 63 + 127) / 255;
+    auto b = (channel(texel, 2) * 31 + 127) / 255;
+    return static_cast<u16>((r << 11) | (g << 5) | b);
+}
+
+// Picks the endpoints at the extremes of the colors along their principal
+// axis, then the nearest palette entry per texel. BC1 blocks with texels
+// below half alpha use the three color mode, whose last entry is clear.
+static auto encode_color_block(const u32 texels[16], bool bc3, u8 *out)
+    -> void {
+    bool clear[16];
+    bool anyClear = false;
+    float mean[3] = {0, 0, 0};
+    int used = 0;
+    for (u32 i = 0; i < 16; i++) {
+        clear[i] = !bc3 && channel(texels[i], 3) < 128;
+        anyClear |= clear[i];
+        if (clear[i])
+            continue;
+        for (u32 c = 0; c < 3; c++)
+            mean[c] += channel(texels[i], c);
+        used++;
+    }
+
+    u32 low = 0, high = 0;
+    if (used > 0) {
+        float cov[6] = {0, 0, 0, 0, 0, 0};
+        for (u32 c = 0; c < 3; c++)
+            mean[c] /= used;
+        for (u32 i = 0; i < 16; i++) {
+            if (clear[i])
+                continue;
+            float d[3];
+            for (u32 c = 0; c < 3; c++)
+                d[c] = channel(texels[i], c) - mean[c];
+            cov[0] += d[0] * d[0], cov[1] += d[0] * d[1], cov[2] += d[0] * d[2];
+            cov[3] += d[1] * d[1], cov[4] += d[1] * d[2], cov[5] += d[2] * d[2];
+        }
+
+        // A few power iterations find the dominant eigenvector
+        float axis[3] = {1, 1, 1};
+        for (int it = 0; it < 8; it++) {
+            float next[3] = {
+                cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2],
+                cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2],
+                cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2]};
+            auto len = std::max({std::fabs(next[0]), std::fabs(next[1]),
+                                 std::fabs(next[2])});
+            if (len < 1e-6f)
+                break;
+            for (u32 c = 0; c < 3; c++)
+                axis[c] = next[c] / len;
+        }
+
+        float lowDot = 1e30f, highDot = -1e30f;
+        for (u32 i = 0; i < 16; i++) {
+            if (clear[i])
+                continue;
+            float dot = 0;
+            for (u32 c = 0; c < 3; c++)
+                dot += channel(texels[i], c) * axis[c];
+            if (dot < lowDot)
+                lowDot = dot, low = texels[i];
+            if (dot > highDot)
+                highDot = dot, high = texels[i];
+        }
+    }
+
+    // Four color blocks need the first endpoint above the second, three
+    // color blocks the reverse
+    u16 c0 = to_565(high);
+    u16 c1 = to_565(low);
+    if (anyClear ? c0 > c1 : c0 < c1)
+        std::swap(c0, c1);
+
+    out[0] = c0 & 0xFF, out[1] = c0 >> 8;
+    out[2] = c1 & 0xFF, out[3] = c1 >> 8;
+
+    u32 palette[4];
+    PixelOps::bc1_palette(out, palette, bc3);
+    auto entries = (bc3 || c0 > c1) ? 4 : 3;
+
+    u32 codes = 0;
+    for (u32 i = 0; i < 16; i++) {
+        u32 best = 3;
+        if (!clear[i]) {
+            auto bestDistance = INT32_MAX;
+            for (int e = 0; e < entries; e++) {
+                auto d = color_distance(texels[i], palette[e]);
+                if (d < bestDistance)
+                    bestDistance = d, best = e;
+            }
+        }
+        codes |= best << (i * 2);
+    }
+
+    for (u32 i = 0; i < 4; i++)
+        out[4 + i] = static_cast<u8>(codes >> (i * 8));
+}
+
+// Spans the block's alpha range with the eight value mode
+static auto encode_alpha_block(const u32 texels[16], u8 *out) -> void {
+    int low = 255, high = 0;
+    for (u32 i = 0; i < 16; i++) {
+        low = std::min(low, channel(texels[i], 3));
+        high = std::max(high, channel(texels[i], 3));
+    }
+
+    out[0] = static_cast<u8>(high);
+    out[1] = static_cast<u8>(low);
+
+    u8 palette[8];
+    PixelOps::bc3_alpha_palette(out, palette);
+
+    u64 codes = 0;
+    for (u32 i = 0; i < 16 && high != low; i++) {
+        u64 best = 0;
+        auto bestDistance = 256;
+        for (u32 e = 0; e < 8; e++) {
+            auto d = std::abs(channel(texels[i], 3) - palette[e]);
+            if (d < bestDistance)
+                bestDistance = d, best = e;
+        }
+        codes |= best << (i * 3);
+    }
+
+    for (u32 i = 0; i < 6; i++)
+        out[2 + i] = static_cast<u8>(codes >> (i * 8));
+}
+
+// Compresses one RGBA8 level into 4x4 blocks
+static auto encode_blocks(const CookedTextureHeader &header,
+                          const std::vector<u8> &rgba, u32 w, u32 h, u8 *out)
+    -> void {
+    auto bc3 = header.format == COOKED_FORMAT_BC3;
+    u32 texels[16];
+
+    for (u32 by = 0; by < h; by += 4) {
+        for (u32 bx = 0; bx < w; bx += 4) {
+            gather_block(rgba, w, h, bx, by, texels);
+            if (bc3) {
+                encode_alpha_block(texels, out);
+                encode_color_block(texels, true, out + 8);
+                out += 16;
+            } else {
+                encode_color_block(texels, false, out);
+                out += 8;
+            }
+        }
+    }
+}
+
+// Converts and swizzles one RGBA8 level into the stored layout
+static auto encode_level(const CookedTextureHeader &header, u32 level,
+                         const std::vector<u8> &rgba, u32 w, u32 h,
+                         std::vector<u8> &out) -> void {
+    u32 sw, sh;
+    auto size = cooked_level_size(header, level, sw, sh);
+    auto bpp = cooked_pixel_size(header.format);
+
+    if (cooked_is_compressed(header.format)) {
+        auto offset = out.size();
+        out.resize(offset + size);
+        encode_blocks(header, rgba, w, h, &out[offset]);
+        return;
+    }
+
+    // Convert, then pad the level out to its stored size
+    std::vector<u8> converted(w * h * bpp);
+    auto src = (const u32 *)rgba.data();
+    auto dst16 = (u16 *)converted.data();
+    switch (header.format) {
+    case COOKED_FORMAT_4444:
+        PixelOps::rgba8888_to_4444(dst16, src, w * h);
+        break;
+    case COOKED_FORMAT_5551:
+        PixelOps::rgba8888_to_5551(dst16, src, w * h);
+        break;
+    case COOKED_FORMAT_565:
+        PixelOps::rgba8888_to_565(dst16, src, w * h);
+        break;
+    default:
+        memcpy(converted.data(), rgba.data(), converted.size());
+        break;
+    }
+
+    std::vector<u8> linear(size);
+    PixelOps::pad_image(linear.data(), sw * bpp, sh, converted.data(), w * bpp,
+                        h);
+
+    auto offset = out.size();
+    out.resize(offset + size);
+    if (header.flags & COOKED_FLAG_SWIZZLED)
+        PixelOps::swizzle(&out[offset], linear.data(), sw * bpp, sh);
+    else
+        memcpy(&out[offset], linear.data(), size);
+}
+
+auto main(int argc, char **argv) -> int {
+    CookOptions options;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                usage();
+                exit(1);
+            }
+            return argv[++i];
+        };
+
+        if (arg == "--platform") {
+            auto platform = next();
+            options = CookOptions();
+            if (platform == "psp") {
+                options.swizzle = true;
+                options.pad = true;
+            } else if (platform != "pc" && platform != "vita" &&
+                       platform != "3ds") {
+                fprintf(stderr, "Unknown platform: %s\n", platform.c_str());
+                return 1;
+            }
+        } else if (arg == "--format") {
+            auto format = next();
+            if (format == "8888") {
+                options.format = COOKED_FORMAT_8888;
+            } else if (format == "4444") {
+                options.format = COOKED_FORMAT_4444;
+            } else if (format == "5551") {
+                options.format = COOKED_FORMAT_5551;
+            } else if (format == "565") {
+                options.format = COOKED_FORMAT_565;
+            } else if (format == "bc1") {
+                options.format = COOKED_FORMAT_BC1;
+            } else if (format == "bc3") {
+                options.format = COOKED_FORMAT_BC3;
+            } else {
+                fprintf(stderr, "Unknown format: %s\n", format.c_str());
+                return 1;
+            }
+        } else if (arg == "--swizzle") {
+            options.swizzle = true;
+        } else if (arg == "--pad") {
+            options.pad = true;
+        } else if (arg == "--flip") {
+            options.flip = true;
+        } else if (arg == "--premultiply") {
+            options.premultiply = true;
+        } else if (arg == "--mips") {
+            options.mips = static_cast<u32>(atoi(next().c_str()));
+        } else if (arg == "--help" || arg == "-h") {
+            usage();
+            return 0;
+        } else {
+            files.push_back(arg);
+        }
+    }
+
+    if (files.size() != 2) {
+        usage();
+        return 1;
+    }
+
+    if (cooked_is_compressed(options.format) && options.swizzle) {
+        fprintf(stderr, "Block compressed formats cannot be swizzled\n");
+        return 1;
+    }
+
+    stbi_set_flip_vertically_on_load(options.flip);
+
+    int width, height, channels;
+    auto data = stbi_load(files[0].c_str(), &width, &height, &channels,
+                          STBI_rgb_alpha);
+    if (data == nullptr) {
+        fprintf(stderr, "Could not load %s: %s\n", files[0].c_str(),
+                stbi_failure_reason());
+        return 1;
+    }
+
+    CookedTextureHeader header;
+    memcpy(header.magic, COOKED_TEXTURE_MAGIC, 4);
+    header.version = COOKED_TEXTURE_VERSION;
+    header.format = options.format;
+    header.flags = (options.swizzle ? COOKED_FLAG_SWIZZLED : 0) |
+                   (options.pad ? COOKED_FLAG_PADDED : 0) |
+                   (options.flip ? COOKED_FLAG_FLIPPED : 0) |
+                   (options.premultiply ? COOKED_FLAG_PREMULTIPLIED : 0);
+    header.width = static_cast<u32>(width);
+    header.height = static_cast<u32>(height);
+    header.pW = options.pad ? PixelOps::pow2(header.width) : header.width;
+    header.pH = options.pad ? PixelOps::pow2(header.height) : header.height;
+
+    if (options.premultiply)
+        PixelOps::premultiply_alpha((u32 *)data, header.width * header.height);
+
+    // The source sits in the top left of the padded first level
+    u32 w = header.pW;
+    u32 h = header.pH;
+    std::vector<u8> rgba(w * h * 4);
+    PixelOps::pad_image(rgba.data(), w * 4, h, data, header.width * 4,
+                        header.height);
+    stbi_image_free(data);
+
+    u32 maxLevels = 1;
+    while ((w >> maxLevels) > 0 || (h >> maxLevels) > 0)
+        maxLevels++;
+    header.levels = options.mips == 0 ? maxLevels : std::min(options.mips, maxLevels);
+
+    std::vector<u8> pixels;
+    for (u32 level = 0; level < header.levels; level++) {
+        encode_level(header, level, rgba, w, h, pixels);
+
+        if (level + 1 < header.levels) {
+            rgba = downsample(rgba, w, h);
+            w = std::max(w / 2, 1u);
+            h = std::max(h / 2, 1u);
+        }
+    }
+    header.dataSize = static_cast<u32>(pixels.size());
+
+    auto file = fopen(files[1].c_str(), "wb");
+    if (file == nullptr) {
+        fprintf(stderr, "Could not write %s\n", files[1].c_str());
+        return 1;
+    }
+
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(pixels.data(), 1, pixels.size(), file);
+    fclose(file);
+
+    printf("%s: %ux%u -> %ux%u, %u levels, %u bytes\n", files[1].c_str(),
+           header.width, header.height, header.pW, header.pH, header.levels,
+           header.dataSize);
+    return 0;
+}
@@ -0,0 +1,127 @@
+#include <Graphics/2D/Sprite.hpp>
+#include <Graphics/2D/SpriteBatch.hpp>
+#include <Stardust-Celeste.hpp>
+#include <Utilities/Input.hpp>
+#include <Utilities/Timer.hpp>
+#include <vector>
+
+using namespace Stardust_Celeste;
+
+// Sprites drawn each frame
+constexpr u32 SPRITE_COUNT = 4000;
+// Frames drawn in each mode before switching
+constexpr u32 FRAMES_PER_MODE = 120;
+
+/**
+ * @brief Draws the same sprites one by one and through a SpriteBatch,
+ * switching every FRAMES_PER_MODE frames and logging GI draw calls, average
+ * frame time and average CPU time of the draws for both
+ */
+class StressState : public Core::ApplicationState {
+
+  public:
+    StressState() : batched(false), frames(0) {}
+
+    void on_update(Core::Application *app, double dt) {
+        Utilities::Input::update();
+    }
+
+    void on_draw(Core::Application *app, double dt) {
+        // GI stats cover the last completed frame, which used this mode
+        if (frames > 0) {
+            auto stats = GI::get_frame_stats();
+            if (batched)
+                batchedCalls = stats.draw_calls;
+            else
+                spriteCalls = stats.draw_calls;
+        }
+
+        // The first frame's dt still belongs to the other mode
+        if (frames > 0)
+            frameTime[batched] += dt;
+
+        Utilities::Timer timer;
+        if (batched)
+            batch.draw();
+        else
+            for (auto &s : sprites)
+                s->draw();
+        drawTime[batched] += timer.elapsed();
+
+        if (++frames == FRAMES_PER_MODE) {
+            frames = 0;
+            batched = !batched;
+
+            if (!batched) {
+                auto count = SPRITE_COUNT;
+                // Averages in milliseconds, frame times miss each first frame
+                auto spriteFrame = frameTime[0] * 1000.0 / (FRAMES_PER_MODE - 1);
+                auto batchedFrame = frameTime[1] * 1000.0 / (FRAMES_PER_MODE - 1);
+                auto spriteDraw = drawTime[0] * 1000.0 / FRAMES_PER_MODE;
+                auto batchedDraw = drawTime[1] * 1000.0 / FRAMES_PER_MODE;
+
+                SC_APP_INFO("{} sprites: {} draw calls one by one, {} with SpriteBatch",
+                            count, spriteCalls, batchedCalls);
+                SC_APP_INFO("Frame {:.2f} ms one by one, {:.2f} ms with SpriteBatch",
+                            spriteFrame, batchedFrame);
+                SC_APP_INFO("Draw CPU {:.2f} ms one by one, {:.2f} ms with SpriteBatch",
+                            spriteDraw, batchedDraw);
+
+                frameTime[0] = frameTime[1] = 0.0;
+                drawTime[0] = drawTime[1] = 0.0;
+            }
+        }
+    }
+
+    void on_start() {
+        Rendering::RenderContext::get().matrix_ortho(0, 480, 0, 272, -1, 1);
+        Rendering::RenderContext::get().set_mode_2D();
+
+        tex_id = Rendering::TextureManager::get().load_texture(
+            "./container.jpg", SC_TEX_FILTER_NEAREST, SC_TEX_FILTER_NEAREST,
+            true);
+
+        // A grid of small sprites covering the screen
+        sprites.reserve(SPRITE_COUNT);
+        for (u32 i = 0; i < SPRITE_COUNT; i++) {
+            auto x = static_cast<float>(i % 80) * 6.0f;
+            auto y = static_cast<float>(i / 80 % 45) * 6.0f;
+            sprites.push_back(create_scopeptr<Graphics::G2D::Sprite>(
+                tex_id, Rendering::Rectangle{{x, y}, {5, 5}}));
+            batch.add(*sprites.back());
+        }
+    }
+
+    void on_cleanup() {}
+
+  private:
+    std::vector<ScopePtr<Graphics::G2D::Sprite>> sprites;
+    Graphics::G2D::SpriteBatch batch;
+    u32 tex_id;
+    bool batched;
+    u32 frames;
+    u32 spriteCalls = 0, batchedCalls = 0;
+    // Seconds summed over a mode, one by one at 0 and batched at 1
+    double frameTime[2] = {0.0, 0.0};
+    double drawTime[2] = {0.0, 0.0};
+};
+
+class StressApplication : public Core::Application {
+  public:
+    void on_start() override {
+        state = create_refptr<StressState>();
+        Application::get().push_state(state);
+    }
+
+  private:
+    RefPtr<StressState> state;
+};
+
+Core::Application *CreateNewSCApp() {
+    Core::AppConfig config;
+    config.headless = false;
+
+    Core::PlatformLayer::get().initialize(config);
+
+    return new StressApplication();
+}
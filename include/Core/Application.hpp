@@ -4,7 +4,9 @@
 #include "../Rendering/Rendering.hpp"
 #include "../Utilities/Utilities.hpp"
 #include "State.hpp"
+#include <atomic>
 #include <future>
+#include <mutex>
 #include "../Rendering/GI.hpp"
 
 /**
@@ -14,13 +16,24 @@ int main(int argc, char **argv);
 
 namespace Stardust_Celeste::Core {
 
+/**
+ * @brief Thread timings of doubletime mode over the last second
+ * overlap -- Lower bound on the time update and draw ran at once
+ */
+struct PipelineStats {
+    double update_time = 0.0;
+    double draw_time = 0.0;
+    double wall_time = 0.0;
+    double overlap = 0.0;
+};
+
 /**
  * @brief Base application class -- must be overriden for users
  *
  */
 class Application {
   public:
-    Application() : running(true), frameTime(0.0f) {
+    Application() : doubletime(false), running(true), frameTime(0.0f), updateBusyUs(0) {
         SC_CORE_ASSERT(!s_Instance, "Instance shouldn't exist!");
         s_Instance = this;
     }
@@ -36,11 +49,13 @@ class Application {
      */
     void set_state(RefPtr<ApplicationState> state) {
         SC_CORE_ASSERT(state.get() != nullptr, "State set was nullptr!");
+        std::lock_guard<std::recursive_mutex> lock(drawMutex);
 
         stateStack.clear();
         state->on_start();
         stateStack.emplace_back(state);
         stateStack.shrink_to_fit();
+        drawState = state;
     }
 
     /**
@@ -50,8 +65,11 @@ class Application {
      */
     void push_state(RefPtr<ApplicationState> state) {
         SC_CORE_ASSERT(state.get() != nullptr, "State pushed was nullptr!");
+        std::lock_guard<std::recursive_mutex> lock(drawMutex);
+
         state->on_start();
         stateStack.emplace_back(state);
+        drawState = state;
     }
 
     /**
@@ -61,8 +79,11 @@ class Application {
     void pop_state() {
         SC_CORE_ASSERT(stateStack.size() > 0,
                        "StateStack.size() == 0, but pop_state was called!");
+        std::lock_guard<std::recursive_mutex> lock(drawMutex);
+
         stateStack.back()->on_cleanup();
         stateStack.pop_back();
+        drawState = stateStack.empty() ? nullptr : stateStack.back();
     }
 
     virtual void on_start() = 0;
@@ -73,6 +94,12 @@ class Application {
      */
     void exit() { pop_state(); running = false; }
 
+    /**
+     * @brief Update / draw thread timings, only filled in doubletime mode
+     *
+     */
+    inline auto get_pipeline_stats() const -> PipelineStats { return pipelineStats; }
+
   private:
 
     void updateAsync() {
@@ -92,9 +119,22 @@ class Application {
                 continue;
             }
 
-            if (!stateStack.empty()) {
-                stateStack.back()->on_update(this, dt);
-            }
+            if (stateStack.empty())
+                continue;
+
+            auto state = stateStack.back();
+
+            // Only pipelined states may update while the draw thread draws
+            std::unique_lock<std::recursive_mutex> lock(drawMutex, std::defer_lock);
+            if (!state->is_pipelined())
+                lock.lock();
+
+            // Started once locked, waiting on the draw thread is not overlap
+            Utilities::Timer busy;
+            state->on_update(this, dt);
+            state->on_publish();
+
+            updateBusyUs += static_cast<u64>(busy.elapsed() * 1000000.0);
         }
     }
 
@@ -106,6 +146,7 @@ class Application {
 
         double fTimer = 0.0;
         int fps = 0;
+        double drawBusy = 0.0;
 
         while(running) {
 
@@ -123,19 +164,33 @@ class Application {
 
             fps++;
             if(fTimer > 1.0) {
+                // Time both threads were busy beyond the wall clock must have overlapped
+                pipelineStats.update_time = updateBusyUs.exchange(0) / 1000000.0;
+                pipelineStats.draw_time = drawBusy;
+                pipelineStats.wall_time = fTimer;
+                pipelineStats.overlap = std::max(0.0, pipelineStats.update_time + drawBusy - fTimer);
+
+                auto overlapPct = 100.0 * pipelineStats.overlap / fTimer;
+                SC_APP_INFO("FPS: {}, Update / Draw overlap: {:.1f}%", fps, overlapPct);
                 fTimer = 0;
-                SC_APP_INFO("FPS: {}", fps);
                 fps = 0;
+                drawBusy = 0.0;
             }
 
             auto rctx = Rendering::RenderContext::get().initialized();
 
             if (rctx) {
-                Rendering::RenderContext::get().clear();
+                std::lock_guard<std::recursive_mutex> lock(drawMutex);
+                Utilities::Timer busy;
 
-                stateStack.back()->on_draw(this, dt);
+                if (drawState != nullptr) {
+                    Rendering::RenderContext::get().clear();
 
-                Rendering::RenderContext::get().render();
+                    drawState->on_draw(this, dt);
+
+                    Rendering::RenderContext::get().render();
+                }
+                drawBusy += busy.elapsed();
             }
         }
     }
@@ -160,8 +215,11 @@ class Application {
         while (running) {
             frameTime = static_cast<float>(timer.get_delta_time());
 
-            if (!stateStack.empty())
-                stateStack.back()->on_update(this, frameTime);
+            if (!stateStack.empty()) {
+                auto state = stateStack.back();
+                state->on_update(this, frameTime);
+                state->on_publish();
+            }
 
             auto rctx = Rendering::RenderContext::get().initialized();
 
@@ -183,11 +241,19 @@ protected:
     int16_t updateRate = 60;
     int16_t drawRate = -1;
     bool doubletime;
-    bool running;
+    std::atomic<bool> running;
     double frameTime;
 
     std::vector<RefPtr<ApplicationState>> stateStack;
 
+    // Held by the draw thread while drawing, and by the update thread for
+    // state changes and non-pipelined updates
+    std::recursive_mutex drawMutex;
+    // Top of the stack as seen by the draw thread, guarded by drawMutex
+    RefPtr<ApplicationState> drawState;
+    std::atomic<u64> updateBusyUs;
+    PipelineStats pipelineStats;
+
     friend int ::main(int argc, char **argv);
 };
 } // namespace Stardust_Celeste::Core
@@ -1,4 +1,5 @@
 #pragma once
+#include "../Utilities/TripleBuffer.hpp"
 
 namespace Stardust_Celeste::Core {
 class Application;
@@ -39,5 +40,62 @@ class ApplicationState {
      * 
      */
     virtual void on_cleanup() = 0;
+
+    /**
+     * @brief Called on the update thread right after on_update
+     *
+     */
+    virtual void on_publish() {}
+
+    /**
+     * @brief Whether on_update and on_draw may run at the same time in
+     * doubletime mode -- other states have the two serialized
+     *
+     */
+    virtual bool is_pipelined() const { return false; }
+};
+
+/**
+ * @brief State whose update and draw only share a render snapshot, so in
+ * doubletime mode both threads run at once. The update thread writes a
+ * snapshot after every update, the draw thread draws the latest one.
+ *
+ * @tparam Snapshot Everything on_draw_snapshot needs -- rewrite it fully in
+ * on_snapshot, the buffer handed out holds an older snapshot
+ */
+template <class Snapshot> class PipelinedState : public ApplicationState {
+  public:
+    /**
+     * @brief Fills a snapshot from the simulation -- runs on the update thread
+     *
+     * @param snapshot Snapshot to write
+     */
+    virtual void on_snapshot(Snapshot &snapshot) = 0;
+
+    /**
+     * @brief Draws a snapshot -- runs on the draw thread and must not read
+     * anything on_update writes
+     *
+     * @param app Application instance
+     * @param snapshot Latest published snapshot
+     * @param dt Delta Time (Frame Time)
+     */
+    virtual void on_draw_snapshot(Application *app, const Snapshot &snapshot,
+                                  double dt) = 0;
+
+    void on_publish() final {
+        on_snapshot(snapshots.write_buffer());
+        snapshots.publish();
+    }
+
+    void on_draw(Application *app, double dt) final {
+        snapshots.acquire();
+        on_draw_snapshot(app, snapshots.read_buffer(), dt);
+    }
+
+    bool is_pipelined() const final { return true; }
+
+  private:
+    Utilities::TripleBuffer<Snapshot> snapshots;
 };
 } // namespace Stardust_Celeste::Core
@@ -4,7 +4,8 @@
 namespace Stardust_Celeste::Graphics::G2D {
 
 /**
- * @brief Animated Sprite
+ * @brief Animated Sprite -- where GI supports atlas animation the frames are
+ * stepped in the vertex shader, so ticking needs no CPU work or uploads
  *
  */
 class AnimatedSprite : public Sprite {
@@ -33,17 +34,15 @@ class AnimatedSprite : public Sprite {
      */
     auto update(double dt) -> void override;
 
+    auto draw() -> void override;
+
     /**
      * @brief Set the animation range of the atlas
      *
      * @param startIDX Starting Index
      * @param endIDX Ending Index
      */
-    inline auto set_animation_range(u32 startIDX, u32 endIDX) -> void {
-        this->startIDX = startIDX;
-        this->endIDX = endIDX;
-        this->currentIDX = startIDX;
-    }
+    auto set_animation_range(u32 startIDX, u32 endIDX) -> void;
 
     /**
      * @brief Ticks per second (default = 4)
@@ -52,9 +51,28 @@ class AnimatedSprite : public Sprite {
     float ticksPerSec;
 
   protected:
+    auto update_mesh() -> void override;
+
+    /**
+     * @brief Selection rectangle of an atlas frame
+     *
+     * @param index Frame index
+     */
+    auto frame_selection(u32 index) const -> Rendering::Rectangle;
+
+    /**
+     * @brief Frames in the animation range, at least 1
+     */
+    auto frame_count() const -> u32;
+
     float tickTimer;
     mathfu::Vector<float, 2> atlas;
     u32 startIDX, endIDX, currentIDX;
+    // Animated by the vertex shader, at the rate stored in the mesh
+    bool gpuAnimated;
+    float gpuRate;
+
+    friend class SpriteBatch;
 };
 
 } // namespace Stardust_Celeste::Graphics::G2D
\ No newline at end of file
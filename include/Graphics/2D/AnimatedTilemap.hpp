@@ -13,7 +13,8 @@ struct AnimatedTile : public Tile {
 };
 
 /**
- * @brief AnimatedTilemap
+ * @brief AnimatedTilemap -- where GI supports atlas animation the frames are
+ * stepped in the vertex shader and the mesh is only rebuilt on changes
  *
  */
 class AnimatedTilemap : public Tilemap {
@@ -64,6 +65,8 @@ class AnimatedTilemap : public Tilemap {
      */
     virtual auto generate_map() -> void override;
 
+    virtual auto draw() -> void override;
+
     /**
      * @brief Ticks every tile to the next animation frame
      *
@@ -79,6 +82,9 @@ class AnimatedTilemap : public Tilemap {
   protected:
     float atime;
     std::vector<AnimatedTile> atileMap;
+    // Animated by the vertex shader, at the rate stored in the meshes
+    bool gpuAnimated;
+    float gpuRate;
 };
 
 } // namespace Stardust_Celeste::Graphics::G2D
@@ -0,0 +1,95 @@
+#pragma once
+#include <Graphics/2D/Tilemap.hpp>
+#include <unordered_map>
+
+namespace Stardust_Celeste::Graphics::G2D {
+
+/**
+ * @brief Tilemap split into square chunks of world space, each with its own
+ * mesh and bounds. Edits only rebuild the chunks they touch, and draw skips
+ * chunks outside the current view, so its cost follows what is on screen
+ * rather than the size of the map.
+ *
+ */
+class ChunkedTilemap : public Tilemap {
+  public:
+    /**
+     * @brief Construct a new Chunked Tilemap object
+     *
+     * @param texture Texture ID
+     * @param atlasSize Texture Atlas Size
+     * @param chunkSize Width and height of a chunk in world units, tiles go
+     * to the chunk holding their position
+     */
+    ChunkedTilemap(u32 texture, mathfu::Vector<float, 2> atlasSize,
+                   float chunkSize = 256.0f);
+    ChunkedTilemap(const Rendering::AtlasRegion &region,
+                   mathfu::Vector<float, 2> atlasSize, float chunkSize = 256.0f);
+    virtual ~ChunkedTilemap();
+
+    auto add_tile(Tile tile) -> void override;
+
+    /**
+     * @brief Replaces a tile, moving it to another chunk if needed -- only
+     * the affected chunks are rebuilt
+     *
+     * @param index Tile index
+     * @param tile New tile
+     */
+    auto set_tile(size_t index, Tile tile) -> void override;
+
+#if USE_EASTL
+    auto add_tiles(eastl::vector<Tile> tiles) -> void override;
+#else
+    auto add_tiles(std::vector<Tile> tiles) -> void override;
+#endif
+
+    auto clear_tiles() -> void override;
+
+    /**
+     * @brief Rebuilds dirty chunks -- draw does this as well, calling it
+     * ahead moves the work off the first draw
+     *
+     */
+    auto generate_map() -> void override;
+
+    /**
+     * @brief Draws the chunks inside the current view
+     *
+     */
+    auto draw() -> void override;
+
+    inline auto get_chunk_count() const -> size_t { return chunks.size(); }
+
+    /**
+     * @brief Chunks drawn by the last draw call
+     *
+     */
+    inline auto get_visible_chunks() const -> size_t { return visibleChunks; }
+
+  protected:
+    // Chunk grid coordinates packed into one key
+    using ChunkKey = u64;
+
+    struct Chunk {
+        // Indices into tileMap
+        std::vector<size_t> tiles;
+        // One per TILES_PER_MESH tiles, so crowded chunks fit 16-bit indices
+        std::vector<ScopePtr<Rendering::Mesh<Rendering::Vertex>>> meshes;
+        mathfu::Vector<float, 3> min, max;
+        bool dirty = true;
+    };
+
+    auto chunk_key(const Tile &tile) const -> ChunkKey;
+    auto insert_tile(size_t index) -> void;
+    auto remove_tile(size_t index) -> void;
+    auto build_chunk(Chunk &chunk) -> void;
+
+    float chunkSize;
+    std::unordered_map<ChunkKey, Chunk> chunks;
+    // Chunk each tile is stored in, parallel to tileMap
+    std::vector<ChunkKey> tileChunks;
+    size_t visibleChunks;
+};
+
+} // namespace Stardust_Celeste::Graphics::G2D
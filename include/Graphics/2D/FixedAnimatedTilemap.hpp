@@ -110,6 +110,9 @@ template <size_t N> class FixedAnimatedTilemap : public FixedTilemap<N> {
             Rendering::Vertex{uvs[4], uvs[5], t.color, x + w, y + h, t.layer});
         FixedTilemap<N>::mesh->vertices.push_back(
             Rendering::Vertex{uvs[6], uvs[7], t.color, x, y + h, t.layer});
+        for (int i = 0; i < 4; i++)
+            Rendering::set_sheet(
+                FixedTilemap<N>::mesh->vertices[idxc + i], t.sheet);
 
         FixedTilemap<N>::mesh->indices.insert(
             FixedTilemap<N>::mesh->indices.end(),
@@ -13,6 +13,9 @@ namespace Stardust_Celeste::Graphics::G2D {
  */
 template <size_t N> class FixedTilemap {
   public:
+    // 32-bit indices only when the map doesn't fit 16-bit ones
+    using Index = std::conditional_t<(N * 4 > 65536), u32, u16>;
+
     FixedTilemap(u32 tex, mathfu::Vector<float, 2> atlasSize) {
         SC_CORE_ASSERT(tex != 0, "FixedTilemap construction: Texture ID is 0!");
         SC_CORE_ASSERT(atlasSize.x * atlasSize.y > 0,
@@ -20,7 +23,8 @@ template <size_t N> class FixedTilemap {
         texture = tex;
         atlasDimensions = atlasSize;
         mesh = create_scopeptr<
-            Rendering::FixedMesh<Rendering::Vertex, N * 4, N * 6>>();
+            Rendering::FixedMesh<Rendering::Vertex, N * 4, N * 6, Index>>(
+            Rendering::BUFFER_USAGE_DYNAMIC);
     }
     virtual ~FixedTilemap() {
         if (mesh != nullptr)
@@ -79,6 +83,8 @@ template <size_t N> class FixedTilemap {
                 uvs[4], uvs[5], t.color, x + w, y + h, t.layer};
             mesh->vertices[idxc + 3] =
                 Rendering::Vertex{uvs[6], uvs[7], t.color, x, y + h, t.layer};
+            for (int i = 0; i < 4; i++)
+                Rendering::set_sheet(mesh->vertices[idxc + i], t.sheet);
 
             mesh->indices[idxc2 + 0] = idxc + 0;
             mesh->indices[idxc2 + 1] = idxc + 1;
@@ -137,7 +143,7 @@ template <size_t N> class FixedTilemap {
   protected:
     int count;
     std::array<Tile, N> tileMap;
-    ScopePtr<Rendering::FixedMesh<Rendering::Vertex, 4 * N, 6 * N>> mesh;
+    ScopePtr<Rendering::FixedMesh<Rendering::Vertex, 4 * N, 6 * N, Index>> mesh;
     mathfu::Vector<float, 2> atlasDimensions;
 };
 
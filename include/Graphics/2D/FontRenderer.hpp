@@ -32,6 +32,16 @@ class FontRenderer : public Tilemap {
      */
     FontRenderer(u32 texture, mathfu::Vector<float, 2> atlasSize);
 
+    /**
+     * @brief Construct a new Font Renderer object from an atlas region --
+     * the atlas must be loaded with needPix
+     *
+     * @param region Atlas region holding the font
+     * @param atlasSize Glyphs across and down the region
+     */
+    FontRenderer(const Rendering::AtlasRegion &region,
+                 mathfu::Vector<float, 2> atlasSize);
+
     /**
      * @brief Destroy the Font Renderer object
      *
@@ -85,11 +95,17 @@ class FontRenderer : public Tilemap {
     float scale_factor;
 
   protected:
+    /**
+     * @brief Fills the kerning map from the glyph pixels of a texture area
+     */
+    auto measure_glyphs(u32 x0, u32 y0, u32 width, u32 height) -> void;
+
 #if USE_EASTL
     eastl::vector<TextData> stringVector;
 #else
     std::vector<TextData> stringVector;
     std::vector<TextData> oldStringVector;
+    std::vector<Tile> glyphs;
     bool rebuildFlag = true;
 #endif
 };
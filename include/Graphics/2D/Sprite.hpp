@@ -1,5 +1,7 @@
 #pragma once
 #include <Rendering/Mesh.hpp>
+#include <Rendering/TextureArray.hpp>
+#include <Rendering/TextureAtlas.hpp>
 #include <Utilities/Types.hpp>
 
 namespace Stardust_Celeste::Graphics::G2D {
@@ -47,6 +49,26 @@ class Sprite {
      */
     Sprite(u32 texture, Rendering::Rectangle bounds, Rendering::Color color);
 
+    /**
+     * @brief Construct a new Sprite object from an atlas region
+     *
+     * @param region Atlas region, its page becomes the texture
+     * @param bounds Bounding rectangle
+     * @param color Tint color
+     */
+    Sprite(const Rendering::AtlasRegion &region, Rendering::Rectangle bounds,
+           Rendering::Color color = Rendering::Color{255, 255, 255, 255});
+
+    /**
+     * @brief Construct a new Sprite object from a texture array layer
+     *
+     * @param sheet Array layer, its array becomes the texture
+     * @param bounds Bounding rectangle
+     * @param color Tint color
+     */
+    Sprite(const Rendering::TextureSheet &sheet, Rendering::Rectangle bounds,
+           Rendering::Color color = Rendering::Color{255, 255, 255, 255});
+
     /**
      * @brief Destroy the Sprite object
      *
@@ -109,6 +131,29 @@ class Sprite {
      */
     virtual auto set_color(Rendering::Color color) -> void;
 
+    /**
+     * @brief Set the texture array layer
+     *
+     * @param sheet Layer within the texture
+     */
+    auto set_sheet(u16 sheet) -> void;
+
+    /**
+     * @brief Builds the four vertices of a sprite quad
+     *
+     * @param texture Texture ID
+     * @param bounds Bounding rectangle
+     * @param selection Selection rectangle in texture coordinates
+     * @param color Tint color
+     * @param layer Layer of the quad
+     * @param sheet Texture array layer
+     * @return Vertices in counter-clockwise winding
+     */
+    static auto build_quad(u32 texture, Rendering::Rectangle bounds,
+                           Rendering::Rectangle selection,
+                           Rendering::Color color, s16 layer, u16 sheet = 0)
+        -> std::array<Rendering::Vertex, 4>;
+
     /**
      * @brief Texture ID
      *
@@ -116,11 +161,21 @@ class Sprite {
     u32 texture;
 
   protected:
+    friend class SpriteBatch;
+
     virtual auto update_mesh() -> void;
+
+    /**
+     * @brief Writes a quad into the mesh and uploads it
+     *
+     * @param quad Vertices from build_quad
+     */
+    auto upload_quad(const std::array<Rendering::Vertex, 4> &quad) -> void;
     Rendering::Rectangle selection;
     Rendering::Rectangle bounds;
     Rendering::Color color;
     s16 layer;
+    u16 sheet;
     ScopePtr<Rendering::FixedMesh<Rendering::Vertex, 4, 6>> mesh;
 };
 
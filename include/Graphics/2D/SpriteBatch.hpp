@@ -0,0 +1,115 @@
+#pragma once
+#include <Graphics/2D/AnimatedSprite.hpp>
+#include <Graphics/2D/Sprite.hpp>
+#include <Rendering/Mesh.hpp>
+#include <Utilities/Types.hpp>
+#include <array>
+#include <vector>
+
+namespace Stardust_Celeste::Graphics::G2D {
+
+/**
+ * @brief Collects sprites and raw quads into one streamed vertex buffer and
+ * draws them with one draw call per texture run. Quads are sorted by layer and
+ * then texture; quads sharing both keep their submission order. Quads from
+ * different layers of one array texture share a run.
+ *
+ */
+class SpriteBatch {
+  public:
+    SpriteBatch();
+    virtual ~SpriteBatch();
+
+    /**
+     * @brief Adds a sprite to the batch
+     *
+     * @param sprite Sprite to add
+     */
+    auto add(const Sprite &sprite) -> void;
+
+    /**
+     * @brief Adds an animated sprite. Where GI animates atlases it keeps
+     * animating in the batch without being added again; elsewhere it is
+     * added at its current frame, like a sprite.
+     *
+     * @param sprite Sprite to add
+     */
+    auto add(const AnimatedSprite &sprite) -> void;
+
+    /**
+     * @brief Adds a raw quad to the batch
+     *
+     * @param texture Texture ID
+     * @param bounds Bounding rectangle
+     * @param selection Selection rectangle in texture coordinates
+     * @param color Tint color
+     * @param layer Layer of the quad
+     * @param sheet Texture array layer
+     */
+    auto add_quad(u32 texture, Rendering::Rectangle bounds,
+                  Rendering::Rectangle selection, Rendering::Color color,
+                  s16 layer = 0, u16 sheet = 0) -> void;
+
+    /**
+     * @brief Removes all quads from the batch
+     *
+     */
+    auto clear() -> void;
+
+    /**
+     * @brief Draws the batch -- the buffer is only rebuilt when quads were
+     * added or cleared since the last draw
+     *
+     */
+    auto draw() -> void;
+
+    /**
+     * @brief Number of quads in the batch
+     *
+     */
+    inline auto get_quad_count() const -> size_t { return quads.size(); }
+
+    /**
+     * @brief Number of draw calls issued by the last draw
+     *
+     */
+    inline auto get_draw_calls() const -> u32 { return drawCalls; }
+
+  protected:
+    // Atlas grid of GPU animated quads, columns 0 for none
+    struct Animation {
+        u32 columns = 0;
+        float frameWidth = 0.0f, frameHeight = 0.0f;
+
+        inline auto operator==(const Animation &o) const -> bool {
+            return columns == o.columns && frameWidth == o.frameWidth &&
+                   frameHeight == o.frameHeight;
+        }
+    };
+
+    struct Quad {
+        u32 texture;
+        s16 layer;
+        std::array<Rendering::Vertex, 4> vertices;
+        Animation animation;
+    };
+
+    struct Run {
+        u32 texture;
+        size_t page;
+        size_t idx_offset;
+        size_t idx_count;
+        Animation animation;
+    };
+
+    auto build() -> void;
+
+    std::vector<Quad> quads;
+    std::vector<size_t> order;
+    std::vector<Run> runs;
+    std::vector<ScopePtr<Rendering::Mesh<Rendering::Vertex>>> pages;
+    bool dirty;
+    u32 drawCalls;
+};
+
+} // namespace Stardust_Celeste::Graphics::G2D
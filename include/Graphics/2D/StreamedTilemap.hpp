@@ -0,0 +1,143 @@
+#pragma once
+#include <Graphics/2D/Tilemap.hpp>
+#include <Graphics/2D/TilemapFile.hpp>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace Stardust_Celeste::Graphics::G2D {
+
+/**
+ * @brief Tilemap whose tiles are streamed from a file written by write_file.
+ * Only chunks around a focus point are kept in memory -- a worker thread
+ * reads them and builds their vertices ahead of the focus, and chunks that
+ * fall behind are dropped, so the main thread only uploads finished meshes.
+ * Tiles added through the Tilemap functions are drawn as well.
+ *
+ */
+class StreamedTilemap : public Tilemap {
+  public:
+    /**
+     * @brief Construct a new Streamed Tilemap object, the file is opened on
+     * the worker thread
+     *
+     * @param filename Tilemap file
+     * @param texture Texture ID
+     * @param atlasSize Texture Atlas Size
+     */
+    StreamedTilemap(std::string filename, u32 texture,
+                    mathfu::Vector<float, 2> atlasSize);
+    StreamedTilemap(std::string filename,
+                    const Rendering::AtlasRegion &region,
+                    mathfu::Vector<float, 2> atlasSize);
+    virtual ~StreamedTilemap();
+
+    /**
+     * @brief Writes tiles as a tilemap file, grouped into chunks by their
+     * position. Positions and sizes are stored as whole world units.
+     *
+     * @param chunkSize Width and height of a chunk in world units
+     * @return false if the file could not be written
+     */
+    static auto write_file(const std::string &filename,
+                           const std::vector<Tile> &tiles, float chunkSize)
+        -> bool;
+
+    /**
+     * @brief Moves the point chunks are kept around, usually the camera
+     *
+     */
+    inline auto set_focus(mathfu::Vector<float, 2> point) -> void {
+        focus = point;
+    }
+
+    /**
+     * @brief Chunks kept around the focus chunk in each direction
+     *
+     * @param visible Chunks that must be loaded to cover the view
+     * @param prefetch Further chunks loaded ahead of time
+     */
+    auto set_radius(u32 visible, u32 prefetch) -> void;
+
+    /**
+     * @brief Requests the chunks around the focus, drops far ones and
+     * uploads chunks the worker has finished
+     *
+     * @param dt Delta Time
+     */
+    auto update(double dt) -> void override;
+
+    /**
+     * @brief Draws the loaded chunks inside the current view and the tiles
+     * added by hand
+     *
+     */
+    auto draw() -> void override;
+
+    inline auto get_loaded_chunks() const -> size_t { return chunks.size(); }
+    inline auto get_pending_chunks() const -> size_t { return requested.size(); }
+
+    // Finished chunks held for upload, bounds the worker's memory use
+    static constexpr size_t MAX_BUILT_CHUNKS = 8;
+    // Chunk meshes uploaded per update
+    static constexpr size_t UPLOADS_PER_UPDATE = 4;
+
+  protected:
+    using ChunkKey = u64;
+
+    struct Chunk {
+        // One mesh per TILES_PER_MESH tiles, as in Tilemap
+        std::vector<ScopePtr<Rendering::Mesh<Rendering::Vertex>>> meshes;
+        mathfu::Vector<float, 3> min, max;
+    };
+
+    struct BuiltMesh {
+        std::vector<Rendering::Vertex> vertices;
+        std::vector<u16> indices;
+    };
+
+    struct BuiltChunk {
+        ChunkKey key;
+        std::vector<BuiltMesh> meshes;
+        mathfu::Vector<float, 3> min, max;
+    };
+
+    static auto make_key(s32 x, s32 y) -> ChunkKey;
+    auto in_range(ChunkKey key, s32 cx, s32 cy, u32 radius) const -> bool;
+
+    auto start_worker() -> void;
+    auto stop_worker() -> void;
+    auto stream_worker() -> void;
+    auto build_chunk(FILE *file, const TilemapChunkEntry &entry,
+                     BuiltChunk &out) const -> void;
+
+    std::string filename;
+    mathfu::Vector<float, 2> focus;
+    u32 visibleRadius, prefetchRadius;
+
+    std::unordered_map<ChunkKey, Chunk> chunks;
+    // Keys sent to the worker and not yet uploaded or dropped
+    std::unordered_set<ChunkKey> requested;
+
+    // Shared with the worker, guarded by queueMutex
+    std::thread worker;
+    std::mutex queueMutex;
+    std::condition_variable jobReady;
+    std::condition_variable resultTaken;
+    std::deque<ChunkKey> jobs;
+    std::deque<BuiltChunk> built;
+    bool stopping = false;
+    // Set by the worker once the chunk index is read, chunkSize stays 0 if
+    // the file could not be read
+    bool indexReady = false;
+    float chunkSize = 0.0f;
+    // Main thread copy of indexReady
+    bool ready = false;
+};
+
+} // namespace Stardust_Celeste::Graphics::G2D
@@ -1,7 +1,12 @@
 #pragma once
 
 #include <Rendering/Mesh.hpp>
+#include <Rendering/TextureAtlas.hpp>
 #include <Utilities/Types.hpp>
+#include <algorithm>
+#include <array>
+#include <thread>
+#include <vector>
 
 #if USE_EASTL
 #include <EASTL/map.h>
@@ -19,6 +24,8 @@ struct Tile {
     Rendering::Color color;
     u16 index;
     float layer;
+    // Texture array layer the tile is cut from
+    u16 sheet = 0;
 };
 
 /**
@@ -29,6 +36,16 @@ struct Tile {
 class Tilemap {
   public:
     Tilemap(u32 texture, mathfu::Vector<float, 2> atlasSize);
+
+    /**
+     * @brief Construct a new Tilemap object whose tile grid covers an atlas
+     * region instead of the whole texture
+     *
+     * @param region Atlas region, its page becomes the texture
+     * @param atlasSize Tiles across and down the region
+     */
+    Tilemap(const Rendering::AtlasRegion &region,
+            mathfu::Vector<float, 2> atlasSize);
     virtual ~Tilemap();
 
     /**
@@ -38,6 +55,15 @@ class Tilemap {
      */
     virtual auto add_tile(Tile tile) -> void;
 
+    /**
+     * @brief Replaces a tile -- once the map is generated only that tile's
+     * vertices are re-uploaded on the next draw
+     *
+     * @param index Tile index
+     * @param tile New tile
+     */
+    virtual auto set_tile(size_t index, Tile tile) -> void;
+
     /**
      * @brief Generates the map mesh -- must be called before draw
      *
@@ -75,6 +101,12 @@ class Tilemap {
      */
     virtual auto draw() -> void;
 
+    /**
+     * @brief Most threads generate_map splits a large map across, 0 for one
+     * per hardware thread
+     */
+    inline auto set_max_threads(u32 count) -> void { maxThreads = count; }
+
     /**
      * @brief Texture ID
      *
@@ -82,13 +114,117 @@ class Tilemap {
     u32 texture;
 
   protected:
+    /**
+     * @brief Writes the four vertices of a tile from the UV table, it only
+     * reads the tilemap so it can run on other threads
+     *
+     * @param t Tile
+     * @param out Destination for 4 vertices
+     */
+    auto build_tile(const Tile &t, Rendering::Vertex *out) const -> void;
+
+    /**
+     * @brief Builds the vertices of the first count tiles into the generated
+     * meshes, split across threads for large maps -- each thread writes its
+     * own range, so resize_meshes must have run first
+     *
+     * @param tiles Tiles, Tile or a type derived from it
+     * @param count Number of tiles
+     */
+    template <typename T>
+    auto build_tiles(const T *tiles, size_t count) -> void {
+        auto build = [this, tiles](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+                build_tile(tiles[i], tile_vertices(i));
+        };
+
+        auto threads = static_cast<size_t>(
+            maxThreads > 0 ? maxThreads : std::thread::hardware_concurrency());
+        threads = std::min(threads, count / TILES_PER_THREAD);
+        if (threads <= 1) {
+            build(0, count);
+            return;
+        }
+
+        // The calling thread takes the last range
+        std::vector<std::thread> workers;
+        workers.reserve(threads - 1);
+        auto range = (count + threads - 1) / threads;
+        for (size_t t = 0; t < threads - 1; t++)
+            workers.emplace_back(build, t * range, (t + 1) * range);
+        build((threads - 1) * range, count);
+
+        for (auto &w : workers)
+            w.join();
+    }
+
+    /**
+     * @brief Scale from tile UVs to the stored texture, which is padded on
+     * the PSP
+     */
+    auto texture_uv_scale() const -> mathfu::Vector<float, 2>;
+
+    /**
+     * @brief Fills atlasUVs from the atlas size, region and texture
+     */
+    auto build_uv_table() -> void;
+
+    /**
+     * @brief Rebuilds the UV table if the texture UV scale changed since it
+     * was built, as it does on the PSP once a pending or evicted texture is
+     * uploaded
+     *
+     * @return true if the table was rebuilt
+     */
+    auto refresh_uv_table() -> bool;
+
+    // 16-bit indices address at most 65536 vertices, larger maps are split
+    static constexpr size_t TILES_PER_MESH = 65536 / 4;
+    // Fewest tiles worth starting another thread for
+    static constexpr size_t TILES_PER_THREAD = 16384;
+
+    /**
+     * @brief Sizes the sub-meshes for a tile count and builds their indices
+     *
+     * @param count Number of tiles
+     */
+    auto resize_meshes(size_t count) -> void;
+
+    /**
+     * @brief Uploads every sub-mesh
+     */
+    auto upload_meshes() -> void;
+
+    /**
+     * @brief The four vertices of a generated tile
+     *
+     * @param index Tile index
+     */
+    auto tile_vertices(size_t index) const -> Rendering::Vertex *;
+
+    /**
+     * @brief Marks a generated tile for re-upload
+     *
+     * @param index Tile index
+     */
+    auto mark_tile_dirty(size_t index) -> void;
+
 #if USE_EASTL
     eastl::vector<Tile> tileMap;
 #else
     std::vector<Tile> tileMap;
 #endif
-    ScopePtr<Rendering::Mesh<Rendering::Vertex>> mesh;
+    std::vector<ScopePtr<Rendering::Mesh<Rendering::Vertex>>> meshes;
+    // Tiles in the generated meshes
+    size_t meshTiles;
+    u32 maxThreads;
     mathfu::Vector<float, 2> atlasDimensions;
+    // Part of the texture the tile grid covers, in texture coordinates
+    Rendering::Rectangle region;
+    // Left, top, right and bottom UVs of each atlas cell
+    std::vector<std::array<float, 4>> atlasUVs;
+    // texture_uv_scale when atlasUVs was built
+    mathfu::Vector<float, 2> uvTableScale;
 };
 
 } // namespace Stardust_Celeste::Graphics::G2D
\ No newline at end of file
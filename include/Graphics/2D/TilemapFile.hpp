@@ -0,0 +1,61 @@
+#pragma once
+#include <Utilities/Types.hpp>
+
+namespace Stardust_Celeste::Graphics::G2D {
+
+/**
+ * @brief Streamed tilemap file (.stm) -- a TilemapFileHeader, then
+ * chunkCount TilemapChunkEntry, then the TileRecord of every chunk. Written
+ * by StreamedTilemap::write_file, read by StreamedTilemap.
+ *
+ */
+constexpr char TILEMAP_FILE_MAGIC[4] = {'S', 'C', 'T', 'M'};
+constexpr u16 TILEMAP_FILE_VERSION = 1;
+
+/**
+ * @brief Header of a streamed tilemap
+ * chunkSize -- Width and height of a chunk in world units, at most 65535
+ * chunkCount -- Chunk entries following the header
+ */
+struct TilemapFileHeader {
+    char magic[4];
+    u16 version;
+    u16 reserved;
+    float chunkSize;
+    u32 chunkCount;
+};
+
+/**
+ * @brief Location of a chunk's tiles
+ * x, y -- Chunk grid coordinates, the chunk starts at x, y * chunkSize
+ * offset -- Byte offset of the first TileRecord from the start of the file
+ * count -- Number of tiles
+ */
+struct TilemapChunkEntry {
+    s32 x, y;
+    u32 offset;
+    u32 count;
+};
+
+/**
+ * @brief Tile as stored on disk
+ * x, y -- Offset from the chunk origin in world units
+ * w, h -- Size in world units
+ * index, sheet, color, layer -- As in Tile
+ */
+struct TileRecord {
+    u16 x, y;
+    u16 w, h;
+    u16 index;
+    u16 sheet;
+    u32 color;
+    float layer;
+};
+
+static_assert(sizeof(TilemapFileHeader) == 16,
+              "TilemapFileHeader must not be padded");
+static_assert(sizeof(TilemapChunkEntry) == 16,
+              "TilemapChunkEntry must not be padded");
+static_assert(sizeof(TileRecord) == 20, "TileRecord must not be padded");
+
+} // namespace Stardust_Celeste::Graphics::G2D
@@ -1,6 +1,9 @@
 #pragma once
 #include <Graphics/2D/AnimatedSprite.hpp>
 #include <Graphics/2D/AnimatedTilemap.hpp>
+#include <Graphics/2D/ChunkedTilemap.hpp>
 #include <Graphics/2D/FontRenderer.hpp>
 #include <Graphics/2D/Sprite.hpp>
+#include <Graphics/2D/SpriteBatch.hpp>
+#include <Graphics/2D/StreamedTilemap.hpp>
 #include <Graphics/2D/Tilemap.hpp>
\ No newline at end of file
@@ -0,0 +1,102 @@
+#pragma once
+#include <Utilities/Types.hpp>
+#include <algorithm>
+
+namespace Stardust_Celeste::Rendering {
+
+/**
+ * @brief Cooked texture file (.sct) -- a CookedTextureHeader followed by the
+ * mip levels, largest first, each ready to hand to the GPU as is. Written by
+ * sc-cook, read by TextureManager::load_cooked.
+ *
+ */
+constexpr char COOKED_TEXTURE_MAGIC[4] = {'S', 'C', 'T', 'X'};
+constexpr u16 COOKED_TEXTURE_VERSION = 1;
+
+enum CookedFormat : u8 {
+    COOKED_FORMAT_8888 = 0,
+    COOKED_FORMAT_4444 = 1,
+    COOKED_FORMAT_5551 = 2,
+    COOKED_FORMAT_565 = 3,
+    // Block compressed, 4x4 texels in 8 bytes, 1-bit alpha
+    COOKED_FORMAT_BC1 = 4,
+    // Block compressed, 4x4 texels in 16 bytes, BC1 color plus alpha
+    COOKED_FORMAT_BC3 = 5,
+};
+
+enum CookedFlags : u8 {
+    // Stored in the PSP's 16 byte x 8 row block order
+    COOKED_FLAG_SWIZZLED = 1 << 0,
+    // Padded to power of two dimensions
+    COOKED_FLAG_PADDED = 1 << 1,
+    // Flipped vertically at cook time
+    COOKED_FLAG_FLIPPED = 1 << 2,
+    // Colors multiplied by alpha at cook time
+    COOKED_FLAG_PREMULTIPLIED = 1 << 3,
+};
+
+/**
+ * @brief Header of a cooked texture
+ * width, height -- Source image size
+ * pW, pH -- Stored size of the first level
+ * levels -- Mip levels stored, at least 1
+ * dataSize -- Bytes of all levels
+ */
+struct CookedTextureHeader {
+    char magic[4];
+    u16 version;
+    u8 format;
+    u8 flags;
+    u32 width, height;
+    u32 pW, pH;
+    u32 levels;
+    u32 dataSize;
+};
+
+static_assert(sizeof(CookedTextureHeader) == 32,
+              "CookedTextureHeader must not be padded");
+
+inline auto cooked_is_compressed(u8 format) -> bool {
+    return format == COOKED_FORMAT_BC1 || format == COOKED_FORMAT_BC3;
+}
+
+/**
+ * @brief Bytes per pixel, or per 4x4 block for compressed formats
+ */
+inline auto cooked_pixel_size(u8 format) -> u32 {
+    switch (format) {
+    case COOKED_FORMAT_8888:
+        return 4;
+    case COOKED_FORMAT_BC1:
+        return 8;
+    case COOKED_FORMAT_BC3:
+        return 16;
+    default:
+        return 2;
+    }
+}
+
+/**
+ * @brief Stored size of a mip level -- swizzled levels are kept at least one
+ * swizzle block large, compressed levels are rounded up to whole blocks
+ *
+ * @return Bytes of the level
+ */
+inline auto cooked_level_size(const CookedTextureHeader &header, u32 level,
+                              u32 &width, u32 &height) -> u32 {
+    auto bpp = cooked_pixel_size(header.format);
+    width = std::max(header.pW >> level, 1u);
+    height = std::max(header.pH >> level, 1u);
+
+    if (cooked_is_compressed(header.format))
+        return ((width + 3) / 4) * ((height + 3) / 4) * bpp;
+
+    if (header.flags & COOKED_FLAG_SWIZZLED) {
+        width = std::max(width, 16 / bpp);
+        height = std::max(height, 8u);
+    }
+
+    return width * height * bpp;
+}
+
+} // namespace Stardust_Celeste::Rendering
@@ -0,0 +1,57 @@
+#pragma once
+#include <mathfu/matrix.h>
+#include <mathfu/vector.h>
+
+namespace Stardust_Celeste::Rendering {
+
+/**
+ * @brief View volume of a projection * view * model matrix as six planes
+ * facing inwards, for orthographic and perspective projections alike.
+ * Coordinates tested against it are in the model space of that matrix.
+ *
+ */
+struct Frustum {
+    // Left, right, bottom, top, near, far -- x, y, z normal and w distance
+    mathfu::Vector<float, 4> planes[6];
+
+    Frustum() = default;
+
+    explicit Frustum(const mathfu::Matrix<float, 4, 4> &m) {
+        auto row = [&m](int r) {
+            return mathfu::Vector<float, 4>(m(r, 0), m(r, 1), m(r, 2), m(r, 3));
+        };
+
+        // Points inside satisfy -w <= x, y, z <= w in clip space
+        auto w = row(3);
+        planes[0] = w + row(0);
+        planes[1] = w - row(0);
+        planes[2] = w + row(1);
+        planes[3] = w - row(1);
+        planes[4] = w + row(2);
+        planes[5] = w - row(2);
+    }
+
+    /**
+     * @brief Tests an axis aligned box -- may report boxes just outside a
+     * corner as visible, never the other way round
+     *
+     * @param min Lowest corner
+     * @param max Highest corner
+     * @return false if the box is entirely outside
+     */
+    inline auto intersects(const mathfu::Vector<float, 3> &min,
+                           const mathfu::Vector<float, 3> &max) const -> bool {
+        for (auto &p : planes) {
+            // Corner furthest along the plane normal
+            auto x = p.x >= 0.0f ? max.x : min.x;
+            auto y = p.y >= 0.0f ? max.y : min.y;
+            auto z = p.z >= 0.0f ? max.z : min.z;
+
+            if (p.x * x + p.y * y + p.z * z + p.w < 0.0f)
+                return false;
+        }
+        return true;
+    }
+};
+
+} // namespace Stardust_Celeste::Rendering
@@ -3,6 +3,7 @@
 #include <Rendering/RenderTypes.hpp>
 #include <Rendering/GI/TextureHandle.hpp>
 #include <Rendering/GI/BufferObject.hpp>
+#include <functional>
 
 #define BUILD_PC (BUILD_PLAT == BUILD_WINDOWS || BUILD_PLAT == BUILD_POSIX)
 
@@ -89,6 +90,9 @@ struct RenderContextSettings {
     u32 height = 720;
     const char *title = "Stardust App";
     RenderingAPI renderingApi = RenderingAPI::DefaultAPI;
+    // Directory compiled programs and pipelines are cached in (desktop only),
+    // nullptr to always build from source
+    const char *shaderCachePath = "shadercache";
 };
 
 /**
@@ -100,6 +104,26 @@ namespace GI {
 
 using namespace Stardust_Celeste::Rendering;
 
+/**
+ * @brief Per-frame statistics gathered by the graphics layer
+ * draw_calls -- Number of draw calls submitted
+ * texture_binds -- Number of texture binds
+ * matrix_uploads -- Number of matrix uniform uploads
+ * buffer_uploads -- Number of vertex / index buffer uploads
+ * bytes_uploaded -- Bytes of vertex / index data sent to the GPU
+ * state_changes -- State changes issued to the driver
+ * state_skipped -- Redundant state changes skipped by the state cache
+ */
+struct FrameStats {
+    u32 draw_calls = 0;
+    u32 texture_binds = 0;
+    u32 matrix_uploads = 0;
+    u32 buffer_uploads = 0;
+    size_t bytes_uploaded = 0;
+    u32 state_changes = 0;
+    u32 state_skipped = 0;
+};
+
 auto init(const RenderContextSettings app) -> void;
 auto terminate() -> void;
 
@@ -118,6 +142,89 @@ auto alpha_func(u32 func, u32 value, u32 mask) -> void;
 auto start_frame(bool dialog = false) -> void;
 auto end_frame(bool vsync, bool dialog = false) -> void;
 
+/**
+ * @brief Appends a uniform block to the per-frame ring and binds it to block
+ * binding 0 for the following draws (desktop OpenGL only)
+ */
+auto stream_uniform_block(const void* data, size_t size) -> void;
+
+/**
+ * @brief Whether the last streamed block is still bound from the ring's
+ * current region. Once the ring moves on, that region may be rewritten
+ * under draws still reading it, so unchanged blocks must be streamed again.
+ */
+auto uniform_block_current() -> bool;
+
+auto get_frame_stats() -> FrameStats;
+
+/**
+ * @brief Number of shader variants compiled so far, one per feature set
+ * drawn with (desktop OpenGL only, 0 elsewhere)
+ */
+auto get_shader_variant_count() -> u32;
+
+/**
+ * @brief Color space of vertex colors. They are sRGB by default and converted
+ * to linear per fragment -- pass false for colors that are already linear,
+ * which draws with variants that skip the conversion (desktop OpenGL only)
+ */
+auto set_srgb_vertex_colors(bool srgb) -> void;
+
+/**
+ * @brief Whether vertices set up with set_animation animate in the vertex
+ * shader (desktop OpenGL only)
+ */
+auto supports_atlas_animation() -> bool;
+
+/**
+ * @brief Animates the following draws by their vertex animation data,
+ * stepping through frames of a grid atlas by the frame time
+ *
+ * @param columns Frames across the atlas
+ * @param frameWidth Width of a frame in texture coordinates
+ * @param frameHeight Height of a frame in texture coordinates
+ */
+auto enable_atlas_animation(u32 columns, float frameWidth, float frameHeight) -> void;
+auto disable_atlas_animation() -> void;
+
+/**
+ * @brief Shader build time avoided by the program and pipeline cache since
+ * launch (desktop only, 0 elsewhere)
+ *
+ * @return Milliseconds
+ */
+auto get_shader_cache_time_saved() -> double;
+
+/**
+ * @brief Receives a captured frame, RGBA8 rows from top to bottom. The
+ * pixels are only valid during the call.
+ */
+using CaptureCallback = std::function<void(const u8* pixels, u32 width, u32 height)>;
+
+/**
+ * @brief Captures the frame being drawn without stalling -- the read is
+ * queued at end_frame and the callback runs at a later end_frame, once the
+ * GPU has finished it (desktop OpenGL only)
+ *
+ * @return false if captures are not supported
+ */
+auto request_capture(CaptureCallback callback) -> bool;
+
+/**
+ * @brief Block compressed texture formats, 4x4 texels per block
+ * BC1 -- 8 bytes per block, 1-bit alpha
+ * BC3 -- 16 bytes per block, BC1 color plus interpolated alpha
+ */
+enum CompressedFormat {
+    GI_COMPRESSED_BC1,
+    GI_COMPRESSED_BC3,
+};
+
+/**
+ * @brief Forgets the cached GL state -- call after changing GL state outside GI
+ */
+auto invalidate_state() -> void;
+
 auto clear_color(Color color) -> void;
 auto clear(u32 mask) -> void;
 auto clearDepth() -> void;
@@ -130,6 +237,19 @@ auto set_tex_scroll(float v) -> void;
 
 auto create_texturehandle(std::string filename, u32 magFilter, u32 minFilter, bool repeat, bool flip) -> TextureHandle*;
 auto create_texturehandle_memory(uint8_t* buf, size_t len, u32 magFilter, u32 minFilter, bool repeat, bool flip) -> TextureHandle*;
-auto create_vertexbuffer(const Stardust_Celeste::Rendering::Vertex* vert_data, size_t vert_size, const uint16_t* indices, size_t idx_size) -> BufferObject*;
-auto create_vertexbuffer(const Stardust_Celeste::Rendering::SimpleVertex* vert_data, size_t vert_size, const uint16_t* indices, size_t idx_size) -> BufferObject*;
+// Uploads already decoded RGBA8 pixels
+auto create_texturehandle_pixels(const uint8_t* pixels, u32 width, u32 height, u32 magFilter, u32 minFilter, bool repeat) -> TextureHandle*;
+// Uploads a precomputed RGBA8 mip chain, levels packed largest first
+auto create_texturehandle_mipchain(const uint8_t* pixels, u32 width, u32 height, u32 levels, u32 magFilter, u32 minFilter, bool repeat) -> TextureHandle*;
+// Whether create_texturehandle_compressed can upload a format as is
+auto supports_compressed_format(CompressedFormat format) -> bool;
+// Uploads a block compressed mip chain, levels packed largest first; nullptr where unsupported
+auto create_texturehandle_compressed(const uint8_t* data, CompressedFormat format, u32 width, u32 height, u32 levels, u32 magFilter, u32 minFilter, bool repeat) -> TextureHandle*;
+// Uploads same-sized RGBA8 images as layers of one array texture, nullptr where unsupported
+auto create_texturehandle_array(const uint8_t* const* layers, u32 count, u32 width, u32 height, u32 magFilter, u32 minFilter, bool repeat) -> TextureHandle*;
+auto create_vertexbuffer(const Stardust_Celeste::Rendering::Vertex* vert_data, size_t vert_size, const uint16_t* indices, size_t idx_size, Stardust_Celeste::Rendering::BufferUsage usage = Stardust_Celeste::Rendering::BUFFER_USAGE_STATIC) -> BufferObject*;
+auto create_vertexbuffer(const Stardust_Celeste::Rendering::SimpleVertex* vert_data, size_t vert_size, const uint16_t* indices, size_t idx_size, Stardust_Celeste::Rendering::BufferUsage usage = Stardust_Celeste::Rendering::BUFFER_USAGE_STATIC) -> BufferObject*;
+// 32-bit indices -- not supported by the PSP GE
+auto create_vertexbuffer(const Stardust_Celeste::Rendering::Vertex* vert_data, size_t vert_size, const uint32_t* indices, size_t idx_size, Stardust_Celeste::Rendering::BufferUsage usage = Stardust_Celeste::Rendering::BUFFER_USAGE_STATIC) -> BufferObject*;
+auto create_vertexbuffer(const Stardust_Celeste::Rendering::SimpleVertex* vert_data, size_t vert_size, const uint32_t* indices, size_t idx_size, Stardust_Celeste::Rendering::BufferUsage usage = Stardust_Celeste::Rendering::BUFFER_USAGE_STATIC) -> BufferObject*;
 } // namespace GI
\ No newline at end of file
@@ -10,9 +10,20 @@ namespace GI {
 
         virtual void bind() = 0;
         virtual void draw(Rendering::PrimType p) = 0;
+        virtual void draw_range(Rendering::PrimType p, size_t idx_offset, size_t idx_count) = 0;
+        // Draws the buffer once per instance, returns false if the backend can't instance
+        virtual bool draw_instanced(Rendering::PrimType p, const Rendering::InstanceData* instances, size_t count) = 0;
 
         virtual void update(const Stardust_Celeste::Rendering::Vertex* vert_data, size_t vert_size, const uint16_t* indices, size_t idx_size) = 0;
         virtual void update(const Stardust_Celeste::Rendering::SimpleVertex* vert_data, size_t vert_size, const uint16_t* indices, size_t idx_size) = 0;
+        virtual void update(const Stardust_Celeste::Rendering::Vertex* vert_data, size_t vert_size, const uint32_t* indices, size_t idx_size) = 0;
+        virtual void update(const Stardust_Celeste::Rendering::SimpleVertex* vert_data, size_t vert_size, const uint32_t* indices, size_t idx_size) = 0;
+
+        // Re-uploads element ranges of the arrays last passed to update -- the pointers are the array starts
+        virtual void update_range(const Stardust_Celeste::Rendering::Vertex* vert_data, size_t vert_offset, size_t vert_count, const uint16_t* indices, size_t idx_offset, size_t idx_count) = 0;
+        virtual void update_range(const Stardust_Celeste::Rendering::SimpleVertex* vert_data, size_t vert_offset, size_t vert_count, const uint16_t* indices, size_t idx_offset, size_t idx_count) = 0;
+        virtual void update_range(const Stardust_Celeste::Rendering::Vertex* vert_data, size_t vert_offset, size_t vert_count, const uint32_t* indices, size_t idx_offset, size_t idx_count) = 0;
+        virtual void update_range(const Stardust_Celeste::Rendering::SimpleVertex* vert_data, size_t vert_offset, size_t vert_count, const uint32_t* indices, size_t idx_offset, size_t idx_count) = 0;
         virtual void destroy() = 0;
     };
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 #if BUILD_PLAT == BUILD_WINDOWS || BUILD_PLAT == BUILD_POSIX
 #include <glad/glad.hpp>
+#include <Rendering/GI/GL/GLRingBuffer.hpp>
+#include <Utilities/Types.hpp>
 #endif
 
 #if PSP
@@ -15,31 +17,63 @@ namespace GI::detail {
     public:
         GLBufferObject() :
 #if BUILD_PLAT == BUILD_WINDOWS || BUILD_PLAT == BUILD_POSIX
-        vbo(0), vao(0), ebo(0),
+        vbo(0), vao(0), ebo(0), ivbo(0), vbo_capacity(0), ebo_capacity(0), ivbo_capacity(0), idx_base(0), ring_frame(0),
 #endif
-        setup(false), idx_count(0) {}
+        usage(Rendering::BUFFER_USAGE_STATIC), setup(false), vtx_count(0), idx_count(0) {}
         ~GLBufferObject() { destroy(); }
 
-        static GLBufferObject* create(const Stardust_Celeste::Rendering::Vertex* vert_data, size_t vert_size, const uint16_t* indices, size_t idx_size);
-        static GLBufferObject* create(const Stardust_Celeste::Rendering::SimpleVertex* vert_data, size_t vert_size, const uint16_t* indices, size_t idx_size);
+        static GLBufferObject* create(const Stardust_Celeste::Rendering::Vertex* vert_data, size_t vert_size, const uint16_t* indices, size_t idx_size, Rendering::BufferUsage usage = Rendering::BUFFER_USAGE_STATIC);
+        static GLBufferObject* create(const Stardust_Celeste::Rendering::SimpleVertex* vert_data, size_t vert_size, const uint16_t* indices, size_t idx_size, Rendering::BufferUsage usage = Rendering::BUFFER_USAGE_STATIC);
+        static GLBufferObject* create(const Stardust_Celeste::Rendering::Vertex* vert_data, size_t vert_size, const uint32_t* indices, size_t idx_size, Rendering::BufferUsage usage = Rendering::BUFFER_USAGE_STATIC);
+        static GLBufferObject* create(const Stardust_Celeste::Rendering::SimpleVertex* vert_data, size_t vert_size, const uint32_t* indices, size_t idx_size, Rendering::BufferUsage usage = Rendering::BUFFER_USAGE_STATIC);
         void bind() override;
         void draw(Rendering::PrimType p) override;
+        void draw_range(Rendering::PrimType p, size_t idx_offset, size_t idx_count) override;
+        bool draw_instanced(Rendering::PrimType p, const Rendering::InstanceData* instances, size_t count) override;
 
         void update(const Stardust_Celeste::Rendering::Vertex* vert_data, size_t vert_size, const uint16_t* indices, size_t idx_size) override;
         void update(const Stardust_Celeste::Rendering::SimpleVertex* vert_data, size_t vert_size, const uint16_t* indices, size_t idx_size) override;
+        void update(const Stardust_Celeste::Rendering::Vertex* vert_data, size_t vert_size, const uint32_t* indices, size_t idx_size) override;
+        void update(const Stardust_Celeste::Rendering::SimpleVertex* vert_data, size_t vert_size, const uint32_t* indices, size_t idx_size) override;
+        void update_range(const Stardust_Celeste::Rendering::Vertex* vert_data, size_t vert_offset, size_t vert_count, const uint16_t* indices, size_t idx_offset, size_t idx_count) override;
+        void update_range(const Stardust_Celeste::Rendering::SimpleVertex* vert_data, size_t vert_offset, size_t vert_count, const uint16_t* indices, size_t idx_offset, size_t idx_count) override;
+        void update_range(const Stardust_Celeste::Rendering::Vertex* vert_data, size_t vert_offset, size_t vert_count, const uint32_t* indices, size_t idx_offset, size_t idx_count) override;
+        void update_range(const Stardust_Celeste::Rendering::SimpleVertex* vert_data, size_t vert_offset, size_t vert_count, const uint32_t* indices, size_t idx_offset, size_t idx_count) override;
         void destroy() override;
 
     private:
+        template <class V, class I>
+        static GLBufferObject* create_buffer(const V* vert_data, size_t vert_size, const I* indices, size_t idx_size, Rendering::BufferUsage usage);
+        template <class V, class I>
+        void store(const V* vert_data, size_t vert_size, const I* indices, size_t idx_size);
+        template <class V, class I>
+        void upload_range(const V* vert_data, size_t vert_offset, size_t vert_count, const I* indices, size_t idx_offset, size_t idx_count);
+
 #if BUILD_PLAT == BUILD_WINDOWS || BUILD_PLAT == BUILD_POSIX
+        template <class V, class I>
+        void upload(const V* vert_data, size_t vert_size, const I* indices, size_t idx_size);
+
         GLuint vbo, vao, ebo;
+        // Per-instance attributes, streamed on every instanced draw
+        GLuint ivbo;
+        size_t vbo_capacity, ebo_capacity, ivbo_capacity;
+        // Byte offset of the index data within the element buffer
+        size_t idx_base;
+        ScopePtr<GLRingBuffer> ring;
+        // GI frame of the last ring upload
+        u64 ring_frame;
 #endif
 #if BUILD_PLAT == BUILD_PSP
         size_t vtx_size;
         const void* vtx_buf;
         const void* idx_buf;
 #endif
+        Rendering::BufferUsage usage;
         bool simple = false;
         bool setup;
+        size_t vtx_count;
         size_t idx_count;
+        // Bytes per index, 2 or 4
+        size_t idx_stride = sizeof(u16);
     };
 }
\ No newline at end of file
@@ -0,0 +1,87 @@
+#pragma once
+#include <Platform/Platform.hpp>
+#if BUILD_PLAT == BUILD_WINDOWS || BUILD_PLAT == BUILD_POSIX
+#include <glad/glad.hpp>
+#include <Rendering/GI.hpp>
+#include <Rendering/GI/GL/GLRingBuffer.hpp>
+#include <Utilities/Singleton.hpp>
+#include <Utilities/Types.hpp>
+#include <deque>
+#include <vector>
+
+namespace GI::detail {
+    /**
+     * @brief Pixel buffer transfers -- texture uploads staged in a fenced
+     * unpack ring, so the driver copies them to the GPU without blocking,
+     * and frame captures read into pack buffers and handed back once their
+     * fence has passed.
+     */
+    class GLPixelTransfer final : public Singleton {
+    public:
+        inline static auto get() -> GLPixelTransfer & {
+            static GLPixelTransfer transfer;
+            return transfer;
+        }
+
+        /**
+         * @brief Copies pixels into the staging ring and binds it to
+         * GL_PIXEL_UNPACK_BUFFER. Small uploads, and ones the ring has no
+         * room for this frame, are left to the caller.
+         *
+         * @param source Pointer to pass to glTex(Sub)Image, an offset into
+         * the ring when staged
+         * @return true if staged, end_upload must then follow the upload
+         */
+        auto begin_upload(const void* pixels, size_t size, const void*& source) -> bool;
+
+        /**
+         * @brief Unbinds the staging ring
+         */
+        auto end_upload() -> void;
+
+        /**
+         * @brief Queues a capture of the frame being drawn
+         */
+        auto request_capture(CaptureCallback callback) -> void;
+
+        /**
+         * @brief Reads back the frame for pending captures, delivers
+         * finished ones and moves the staging ring on -- call before the
+         * buffer swap
+         */
+        auto end_frame() -> void;
+
+        /**
+         * @brief Frees all buffers, pending captures are dropped
+         */
+        auto release() -> void;
+
+        // Smaller uploads are cheaper to hand to the driver directly
+        static constexpr size_t MIN_STAGED_BYTES = 64 * 1024;
+        // Fits one 2048x2048 RGBA8 image per frame
+        static constexpr size_t UPLOAD_REGION_SIZE = 16 * 1024 * 1024;
+        static constexpr u32 MAX_CAPTURES_IN_FLIGHT = 3;
+
+    private:
+        GLPixelTransfer() = default;
+
+        struct Readback {
+            GLuint buffer = 0;
+            size_t capacity = 0;
+            GLsync fence = nullptr;
+            u32 width = 0, height = 0;
+            std::vector<CaptureCallback> callbacks;
+        };
+
+        auto issue_readback() -> void;
+        auto deliver_readbacks() -> void;
+
+        ScopePtr<GLRingBuffer> uploadRing;
+
+        std::vector<CaptureCallback> requests;
+        std::deque<Readback> inFlight;
+        std::vector<Readback> idle;
+        std::vector<u8> captured;
+    };
+}
+#endif
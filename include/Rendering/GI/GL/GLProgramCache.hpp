@@ -0,0 +1,55 @@
+#pragma once
+#include <Platform/Platform.hpp>
+#if BUILD_PLAT == BUILD_WINDOWS || BUILD_PLAT == BUILD_POSIX
+#include <glad/glad.hpp>
+#include <Utilities/Singleton.hpp>
+#include <Utilities/Types.hpp>
+#include <string>
+
+namespace GI::detail {
+    /**
+     * @brief Linked program binaries kept in the ShaderCache, so later
+     * launches skip compiling and linking. Entries are keyed by the driver
+     * vendor, renderer and version and by the sources. Needs GL 4.1 or
+     * GL_ARB_get_program_binary.
+     */
+    class GLProgramCache final : public Singleton {
+    public:
+        inline static auto get() -> GLProgramCache & {
+            static GLProgramCache cache;
+            return cache;
+        }
+
+        auto supported() -> bool;
+
+        /**
+         * @brief Asks the driver to keep the binary retrievable -- call
+         * before linking
+         */
+        auto prepare(GLuint program) -> void;
+
+        /**
+         * @brief Creates a program from a cached binary of these sources
+         *
+         * @return Program ID, 0 on a miss or if the driver rejects it
+         */
+        auto load(const std::string &vert, const std::string &frag) -> GLuint;
+
+        /**
+         * @brief Stores the binary of a program linked from these sources
+         *
+         * @param buildMicros Time compiling and linking took
+         */
+        auto store(const std::string &vert, const std::string &frag, GLuint program, u32 buildMicros) -> void;
+
+    private:
+        GLProgramCache() = default;
+
+        auto name_of(const std::string &vert, const std::string &frag) -> std::string;
+        auto key_of(const std::string &vert, const std::string &frag) -> u64;
+
+        bool checked = false;
+        u64 driverKey = 0;
+    };
+}
+#endif
@@ -0,0 +1,68 @@
+#pragma once
+#include <Platform/Platform.hpp>
+#if BUILD_PLAT == BUILD_WINDOWS || BUILD_PLAT == BUILD_POSIX
+#include <glad/glad.hpp>
+#include <Utilities/NonCopy.hpp>
+#include <Utilities/Types.hpp>
+#include <vector>
+
+namespace GI::detail {
+    /**
+     * @brief GPU buffer split into regions which are written in turn and
+     * protected by fences. Uses a persistently mapped store where
+     * GL_ARB_buffer_storage is available, otherwise unsynchronized maps.
+     */
+    class GLRingBuffer final : public NonCopy {
+    public:
+        GLRingBuffer(GLenum target, size_t region_size, u32 region_count = 3);
+        ~GLRingBuffer();
+
+        /**
+         * @brief Fences the current region and moves on to the next one,
+         * waiting until the GPU has finished reading it
+         */
+        auto next_region() -> void;
+
+        /**
+         * @brief Sub-allocates from the current region
+         *
+         * @param size Bytes needed
+         * @param alignment Offset alignment
+         * @param offset Absolute byte offset into the buffer
+         * @return false if the region is full
+         */
+        auto allocate(size_t size, size_t alignment, size_t& offset) -> bool;
+
+        /**
+         * @brief Writes data at an absolute byte offset
+         */
+        auto write(size_t offset, const void* data, size_t size) -> void;
+
+        inline auto get_id() const -> GLuint { return id; }
+        inline auto get_region_size() const -> size_t { return regionSize; }
+        inline auto get_region_offset() const -> size_t { return regionSize * region; }
+
+        /**
+         * @brief Number of next_region calls so far -- an offset allocated
+         * under an older count may be overwritten once fenced
+         */
+        inline auto get_serial() const -> u64 { return serial; }
+
+        /**
+         * @brief Whether persistent mapping is available on this context
+         */
+        static auto persistent_supported() -> bool;
+
+    private:
+        GLenum target;
+        GLuint id;
+        size_t regionSize;
+        u32 regionCount;
+        u32 region;
+        size_t head;
+        u64 serial;
+        u8* mapped;
+        std::vector<GLsync> fences;
+    };
+}
+#endif
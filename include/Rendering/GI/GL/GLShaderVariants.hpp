@@ -0,0 +1,113 @@
+#pragma once
+#include <Platform/Platform.hpp>
+#if BUILD_PLAT == BUILD_WINDOWS || BUILD_PLAT == BUILD_POSIX
+#include <glad/glad.hpp>
+#include <Utilities/Singleton.hpp>
+#include <Utilities/Types.hpp>
+#include <string>
+#include <unordered_map>
+
+namespace GI::detail {
+    /**
+     * @brief Features a shader variant is compiled for, each one a #define
+     * in the GLSL source
+     */
+    enum ShaderFeature : u32 {
+        // Samples a texture and modulates it by the vertex color
+        SHADER_TEXTURED = 1 << 0,
+        // The texture is a 2D array indexed by the vertex sheet
+        SHADER_TEXTURE_ARRAY = 1 << 1,
+        // Positions and UVs are normalized 16-bit SimpleVertex values
+        SHADER_SIMPLE_VERTEX = 1 << 2,
+        SHADER_FOG = 1 << 3,
+        // Vertex colors are sRGB and converted to linear per fragment
+        SHADER_SRGB_COLORS = 1 << 4,
+        // Vertex UVs step through atlas frames by time
+        SHADER_ANIMATED = 1 << 5,
+    };
+
+    /**
+     * @brief Specialized programs compiled from one source by feature flags
+     * instead of branching on uniforms. GI sets the flags from its state and
+     * the draw picks the matching program, compiled on first use.
+     */
+    class GLShaderVariants final : public Singleton {
+    public:
+        inline static auto get() -> GLShaderVariants & {
+            static GLShaderVariants variants;
+            return variants;
+        }
+
+        /**
+         * @brief Sets the sources variants are built from -- the feature
+         * defines are inserted after their #version line
+         */
+        auto init(const std::string &vert, const std::string &frag) -> void;
+
+        inline auto set_feature(u32 feature, bool enabled) -> void {
+            features = enabled ? (features | feature) : (features & ~feature);
+        }
+
+        inline auto get_features() const -> u32 { return features; }
+
+        inline auto set_scroll(float value) -> void { scroll = value; }
+        /**
+         * @brief Animation time, seconds since the last wrap and the wraps so far
+         */
+        inline auto set_time(float value, s32 wraps) -> void {
+            time = value;
+            timeWraps = wraps;
+        }
+        inline auto set_animation_atlas(float columns, float width, float height) -> void {
+            animAtlas[0] = columns;
+            animAtlas[1] = width;
+            animAtlas[2] = height;
+        }
+        auto set_fog_color(float r, float g, float b, float a) -> void;
+
+        /**
+         * @brief Makes the program for the current features current
+         *
+         * @return Program ID
+         */
+        auto apply() -> GLuint;
+
+        inline auto get_variant_count() const -> u32 {
+            return static_cast<u32>(variants.size());
+        }
+
+        /**
+         * @brief Deletes every compiled program
+         */
+        auto release() -> void;
+
+    private:
+        GLShaderVariants() = default;
+
+        struct Variant {
+            GLuint program;
+            GLint scroll;
+            GLint fogColor;
+            u32 fogVersion;
+            GLint time;
+            GLint timeWraps;
+            GLint animAtlas;
+            float lastAtlas[3];
+        };
+
+        auto compile(u32 key) -> Variant;
+
+        std::string vertSource, fragSource;
+        std::unordered_map<u32, Variant> variants;
+
+        u32 features = SHADER_TEXTURED | SHADER_SRGB_COLORS;
+        float scroll = 0.0f;
+        float time = 0.0f;
+        s32 timeWraps = 0;
+        float animAtlas[3] = {1.0f, 1.0f, 1.0f};
+        float fogColor[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+        // Bumped on every fog color change, variants upload it when behind
+        u32 fogVersion = 1;
+    };
+}
+#endif
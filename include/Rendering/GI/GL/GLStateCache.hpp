@@ -0,0 +1,102 @@
+#pragma once
+#include <Rendering/GI.hpp>
+#include <Utilities/Singleton.hpp>
+#include <string>
+#include <unordered_map>
+
+namespace GI::detail {
+    /**
+     * @brief Shadow copy of the GL state -- calls which would not change
+     * anything are skipped. Issued and skipped calls are counted in
+     * FrameStats.
+     */
+    class GLStateCache final : public Singleton {
+    public:
+        inline static auto get() -> GLStateCache & {
+            static GLStateCache cache;
+            return cache;
+        }
+
+        /**
+         * @brief Forgets all cached state -- call after touching GL directly
+         */
+        auto invalidate() -> void;
+
+        auto enable(u32 cap) -> void;
+        auto disable(u32 cap) -> void;
+        auto blend_func(u32 src, u32 dest) -> void;
+        auto depth_func(u32 func) -> void;
+
+#if BUILD_PLAT != BUILD_PSP
+        auto bind_texture(u32 id) -> void;
+
+        /**
+         * @brief Drops the binding if the deleted texture was bound
+         */
+        auto texture_deleted(u32 id) -> void;
+#endif
+
+#if BUILD_PC
+        /**
+         * @brief Binds a 2D array texture to unit 1, leaving unit 0 active
+         */
+        auto bind_texture_array(u32 id) -> void;
+#endif
+
+#if BUILD_PC || BUILD_PLAT == BUILD_VITA
+        auto use_program(GLuint program) -> void;
+        inline auto get_program() const -> GLuint { return program; }
+
+        /**
+         * @brief Forgets the locations and uniforms of a deleted program, as
+         * GL may hand its ID to a new one
+         */
+        auto program_deleted(GLuint program) -> void;
+
+        /**
+         * @brief Location of a uniform in the current program, looked up once
+         */
+        auto uniform_location(const char* name) -> GLint;
+
+        auto uniform1i(GLint location, int value) -> void;
+        auto uniform1f(GLint location, float value) -> void;
+#endif
+
+#if BUILD_PC
+        auto bind_vertex_array(GLuint vao) -> void;
+        auto vertex_array_deleted(GLuint vao) -> void;
+#endif
+
+    private:
+        GLStateCache();
+
+        auto set_cap(u32 cap, bool enabled) -> void;
+        auto issue() -> void;
+        auto skip() -> void;
+
+        std::unordered_map<u32, bool> caps;
+        bool blendKnown, depthKnown;
+        u32 blendSrc, blendDest, depthFunc;
+
+#if BUILD_PLAT != BUILD_PSP
+        bool textureKnown;
+        u32 texture;
+#endif
+
+#if BUILD_PC || BUILD_PLAT == BUILD_VITA
+        bool programKnown;
+        GLuint program;
+        std::unordered_map<GLuint, std::unordered_map<std::string, GLint>> locations;
+        // Keyed by program << 32 | location, values are the raw 32 bits
+        std::unordered_map<u64, u32> uniforms;
+        auto set_uniform(GLint location, u32 bits) -> bool;
+#endif
+
+#if BUILD_PC
+        bool vaoKnown;
+        GLuint vao;
+        bool arrayKnown;
+        u32 textureArray;
+#endif
+    };
+}
@@ -2,6 +2,7 @@
 #if BUILD_PLAT == BUILD_WINDOWS || BUILD_PLAT == BUILD_POSIX
 #include <glad/glad.hpp>
 #endif
+#include <Rendering/GI.hpp>
 #include <Rendering/GI/TextureHandle.hpp>
 #include "Rendering/RenderTypes.hpp"
 
@@ -13,7 +14,19 @@ namespace GI::detail {
 
         static GLTextureHandle* create(std::string filename, u32 magFilter, u32 minFilter, bool repeat, bool flip);
         static GLTextureHandle* create_ram(uint8_t* buf, size_t len, u32 magFilter, u32 minFilter, bool repeat, bool flip);
+        static GLTextureHandle* create_pixels(const uint8_t* pixels, u32 width, u32 height, u32 magFilter, u32 minFilter, bool repeat);
+        // Levels are packed back to back, largest first, each half the size of the last
+        static GLTextureHandle* create_mipchain(const uint8_t* pixels, u32 width, u32 height, u32 levels, u32 magFilter, u32 minFilter, bool repeat);
+        // nullptr if the driver lacks the format
+        static GLTextureHandle* create_compressed(const uint8_t* data, GI::CompressedFormat format, u32 width, u32 height, u32 levels, u32 magFilter, u32 minFilter, bool repeat);
+        // GL internal format for a compressed format, 0 if the driver lacks it
+        static u32 compressed_internal_format(GI::CompressedFormat format);
+        // One RGBA8 image per layer, all the same size -- desktop GL only
+        static GLTextureHandle* create_array(const uint8_t* const* layers, u32 count, u32 width, u32 height, u32 magFilter, u32 minFilter, bool repeat);
         void bind() override;
         void destroy() override;
+
+        // Bound to GL_TEXTURE_2D_ARRAY on unit 1 rather than GL_TEXTURE_2D
+        bool array = false;
     };
 }
\ No newline at end of file
@@ -0,0 +1,87 @@
+#pragma once
+#include <Platform/Platform.hpp>
+#if BUILD_PLAT == BUILD_WINDOWS || BUILD_PLAT == BUILD_POSIX
+#include <Utilities/Singleton.hpp>
+#include <Utilities/Types.hpp>
+#include <string>
+#include <vector>
+
+namespace GI::detail {
+    /**
+     * @brief Compiled program or pipeline data as stored on disk
+     * format -- Driver specific format of data, the GL binary format
+     * buildMicros -- Time it took to build from source, used to report the
+     * time saved by later loads
+     */
+    struct ShaderCacheEntry {
+        u32 format = 0;
+        u32 buildMicros = 0;
+        std::vector<u8> data;
+    };
+
+    /**
+     * @brief Persistent cache of compiled shader programs and pipelines. Each
+     * entry is stored under a name with the key it was built for, a hash of
+     * the driver and the shader sources, and reads with any other key miss.
+     */
+    class ShaderCache final : public Singleton {
+    public:
+        inline static auto get() -> ShaderCache & {
+            static ShaderCache cache;
+            return cache;
+        }
+
+        /**
+         * @brief FNV-1a hash, chain calls through seed to hash several blocks
+         */
+        static auto hash(const void* data, size_t size, u64 seed = 0xcbf29ce484222325ull) -> u64;
+
+        inline static auto hash(const std::string &str, u64 seed = 0xcbf29ce484222325ull) -> u64 {
+            return hash(str.data(), str.size(), seed);
+        }
+
+        /**
+         * @brief Sets the directory entries are kept in, created on the first
+         * write -- nullptr disables the cache
+         */
+        auto set_directory(const char* path) -> void;
+
+        inline auto enabled() const -> bool { return !directory.empty(); }
+
+        auto read(const std::string &name, u64 key, ShaderCacheEntry &entry) -> bool;
+        auto write(const std::string &name, u64 key, const ShaderCacheEntry &entry) -> bool;
+
+        /**
+         * @brief Drops an entry the driver rejected
+         */
+        auto remove(const std::string &name) -> void;
+
+        /**
+         * @brief Records an entry used in place of a build from source
+         *
+         * @param loadMicros Time the cached load took
+         */
+        auto record_hit(const ShaderCacheEntry &entry, u32 loadMicros) -> void;
+
+        inline auto get_hits() const -> u32 { return hits; }
+
+        /**
+         * @brief Build time avoided by cache hits so far
+         *
+         * @return Milliseconds
+         */
+        inline auto get_time_saved() const -> double {
+            return static_cast<double>(savedMicros) / 1000.0;
+        }
+
+    private:
+        ShaderCache() = default;
+
+        auto path_of(const std::string &name) const -> std::string;
+
+        std::string directory;
+        u32 hits = 0;
+        u64 savedMicros = 0;
+    };
+}
+#endif
@@ -7,22 +7,41 @@
 namespace GI::detail {
     class VKBufferObject final : public BufferObject {
     public:
-        VKBufferObject() : vertexBuffer(VK_NULL_HANDLE), vertexBufferMemory(VK_NULL_HANDLE), indexBuffer(VK_NULL_HANDLE), indexBufferMemory(VK_NULL_HANDLE), setup(false) {}
+        VKBufferObject() : vertexBuffer(VK_NULL_HANDLE), vertexBufferMemory(VK_NULL_HANDLE), indexBuffer(VK_NULL_HANDLE), indexBufferMemory(VK_NULL_HANDLE), idx_type(VK_INDEX_TYPE_UINT16), setup(false) {}
         ~VKBufferObject() { destroy(); }
 
         static VKBufferObject* create(const Stardust_Celeste::Rendering::Vertex* vert_data, size_t vert_size, const uint16_t* indices, size_t idx_size);
+        static VKBufferObject* create(const Stardust_Celeste::Rendering::Vertex* vert_data, size_t vert_size, const uint32_t* indices, size_t idx_size);
         void bind() override;
         void draw(Rendering::PrimType p) override;
+        void draw_range(Rendering::PrimType p, size_t idx_offset, size_t idx_count) override;
+        bool draw_instanced(Rendering::PrimType p, const Rendering::InstanceData* instances, size_t count) override;
 
         void update(const Stardust_Celeste::Rendering::Vertex* vert_data, size_t vert_size, const uint16_t* indices, size_t idx_size) override;
+        void update(const Stardust_Celeste::Rendering::Vertex* vert_data, size_t vert_size, const uint32_t* indices, size_t idx_size) override;
+        void update_range(const Stardust_Celeste::Rendering::Vertex* vert_data, size_t vert_offset, size_t vert_count, const uint16_t* indices, size_t idx_offset, size_t idx_count) override;
+        void update_range(const Stardust_Celeste::Rendering::Vertex* vert_data, size_t vert_offset, size_t vert_count, const uint32_t* indices, size_t idx_offset, size_t idx_count) override;
         void destroy() override;
 
     private:
+        template <class I>
+        static VKBufferObject* create_buffer(const Stardust_Celeste::Rendering::Vertex* vert_data, size_t vert_size, const I* indices, size_t idx_size);
+        template <class I>
+        void store(const Stardust_Celeste::Rendering::Vertex* vert_data, size_t vert_size, const I* indices, size_t idx_size);
+        template <class I>
+        void store_range(const Stardust_Celeste::Rendering::Vertex* vert_data, size_t vert_offset, size_t vert_count, const I* indices, size_t idx_offset, size_t idx_count);
+
+        inline auto index_size() const -> size_t {
+            return idx_type == VK_INDEX_TYPE_UINT32 ? sizeof(uint32_t) : sizeof(uint16_t);
+        }
+
         VkBuffer vertexBuffer;
         VkDeviceMemory vertexBufferMemory;
         VkBuffer indexBuffer;
         VkDeviceMemory indexBufferMemory;
+        size_t vtx_count;
         size_t idx_count;
+        VkIndexType idx_type;
         bool setup;
     };
 }
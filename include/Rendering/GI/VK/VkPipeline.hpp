@@ -3,9 +3,13 @@
 
 #include <vulkan/vulkan.h>
 #include "Utilities/Assertion.hpp"
+#include <Rendering/RenderTypes.hpp>
 
 namespace GI::detail{
 
+    // Instances written per frame across all instanced draws
+    constexpr size_t MAX_INSTANCES_PER_FRAME = 16384;
+
     struct UniformBufferObject {
         glm::mat4 model;
         glm::mat4 projview;
@@ -28,6 +32,14 @@ namespace GI::detail{
         void updateDescriptorSet();
         void updateUniformBuffer();
 
+        /**
+         * @brief Copies instances into this frame's instance buffer
+         *
+         * @param offset Byte offset to bind binding 1 at
+         * @return false if the frame's instance buffer is full
+         */
+        auto allocateInstances(const Stardust_Celeste::Rendering::InstanceData* instances, size_t count, VkDeviceSize& offset) -> bool;
+
         UniformBufferObject ubo{};
 
         VkRenderPass renderPass;
@@ -36,6 +48,11 @@ namespace GI::detail{
         VkPipelineLayout pipelineLayout;
         VkPipeline graphicsPipeline;
 
+        // Seeded from and saved back to the ShaderCache
+        VkPipelineCache pipelineCache;
+        u64 pipelineCacheKey;
+        u32 pipelineBuildMicros;
+
         VkCommandPool commandPool;
 
         VkImage depthImage;
@@ -46,6 +63,14 @@ namespace GI::detail{
         VkDeviceMemory uniformBufferMemory;
         void* uniformBufferMapped;
 
+        VkBuffer instanceBuffer;
+        VkDeviceMemory instanceBufferMemory;
+        void* instanceBufferMapped;
+        size_t instanceHead;
+        // The vertex shader reads the instance attributes at locations 3-6,
+        // without them instanced draws fall back to one draw per instance
+        bool instancedShader = false;
+
         VkDescriptorPool descriptorPool;
         VkDescriptorSet descriptorSet;
 
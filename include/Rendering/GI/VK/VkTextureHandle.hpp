@@ -14,6 +14,7 @@ namespace GI::detail{
         ~VKTextureHandle() override { destroy();};
 
         static VKTextureHandle* create(std::string filename, u32 magFilter, u32 minFilter, bool repeat, bool flip);
+        static VKTextureHandle* create_pixels(const uint8_t* pixels, u32 width, u32 height, u32 magFilter, u32 minFilter, bool repeat);
         void bind() override;
         void destroy() override;
     private:
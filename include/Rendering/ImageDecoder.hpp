@@ -0,0 +1,44 @@
+#pragma once
+#include <Utilities/Types.hpp>
+#include <string>
+
+namespace Stardust_Celeste::Rendering {
+
+/**
+ * @brief RGBA8 pixels decoded from an image file
+ *
+ */
+struct DecodedImage {
+    u8 *pixels = nullptr;
+    u32 width = 0;
+    u32 height = 0;
+};
+
+/**
+ * @brief Decodes an image file to RGBA8 -- safe to call from any thread, the
+ * flip is done per image instead of through stb_image's global flag
+ *
+ * @param filename File to decode
+ * @param flip Flip vertically
+ * @return DecodedImage Pixels are nullptr on failure
+ */
+auto decode_image(const std::string &filename, bool flip) -> DecodedImage;
+
+/**
+ * @brief Decodes an image in memory to RGBA8 -- safe to call from any thread
+ *
+ * @param buffer Encoded image
+ * @param length Buffer length
+ * @param flip Flip vertically
+ * @return DecodedImage Pixels are nullptr on failure
+ */
+auto decode_image_memory(const u8 *buffer, size_t length, bool flip)
+    -> DecodedImage;
+
+/**
+ * @brief Frees decoded pixels
+ *
+ */
+auto free_image(DecodedImage &image) -> void;
+
+} // namespace Stardust_Celeste::Rendering
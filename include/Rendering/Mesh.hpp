@@ -4,7 +4,9 @@
 #include "Utilities/Logger.hpp"
 #include "Utilities/Singleton.hpp"
 #include "Utilities/Types.hpp"
+#include <algorithm>
 #include <array>
+#include <type_traits>
 
 #include "RenderTypes.hpp"
 
@@ -50,15 +52,82 @@ namespace Stardust_Celeste::Rendering {
 // TODO: Optimized Vertex structure - u16 x,y,z - u16 color - u16 u,v
 // TODO: Lit data structure including normals
 
+namespace detail {
+/**
+ * @brief Draws a bound buffer once per instance. Backends without instancing
+ * get one draw per instance with the transform pushed as the model matrix;
+ * instance tint and UV rectangles are not applied on that path.
+ */
+inline auto draw_instances(GI::BufferObject *vbo, const InstanceData *instances,
+                           size_t count, PrimType p) -> void {
+    auto &ctx = Rendering::RenderContext::get();
+    ctx.set_matrices();
+
+    if (vbo->draw_instanced(p, instances, count))
+        return;
+
+    for (size_t i = 0; i < count; i++) {
+        auto &inst = instances[i];
+        auto mat = mathfu::Matrix<float, 4>::Identity();
+        mat(0, 0) = inst.a;
+        mat(0, 1) = inst.b;
+        mat(1, 0) = inst.c;
+        mat(1, 1) = inst.d;
+        mat(0, 3) = inst.x;
+        mat(1, 3) = inst.y;
+        mat(2, 3) = inst.z;
+
+        ctx.matrix_push();
+        ctx.matrix_model(mat);
+        ctx.set_matrices();
+        vbo->draw(p);
+        ctx.matrix_pop();
+    }
+}
+} // namespace detail
+
 /**
  * @brief Mesh takes ownership of vertices and indices
+ *
+ * @tparam T Vertex type
+ * @tparam Index u16, or u32 for meshes above 65536 vertices (not on PSP)
  */
-template <class T> class Mesh : public NonCopy {
+template <class T, class Index = u16> class Mesh : public NonCopy {
+    static_assert(std::is_same_v<Index, u16> || std::is_same_v<Index, u32>,
+                  "Mesh indices must be u16 or u32");
+
   private:
       GI::BufferObject* vbo;
+      BufferUsage usage;
+
+      // Element ranges changed since the last upload, empty when begin == end
+      struct DirtyRange {
+          size_t begin = 0, end = 0;
+
+          auto add(size_t offset, size_t count) -> void {
+              if (count == 0)
+                  return;
+              if (begin == end) {
+                  begin = offset;
+                  end = offset + count;
+              } else {
+                  begin = std::min(begin, offset);
+                  end = std::max(end, offset + count);
+              }
+          }
+      };
+      DirtyRange vtxDirty, idxDirty;
+      size_t uploadedVertices, uploadedIndices;
 
   public:
-    Mesh() : vbo(nullptr) {
+    /**
+     * @brief Creates an empty mesh
+     *
+     * @param usage How often the buffer is rewritten -- meshes rebuilt every
+     * frame should use BUFFER_USAGE_STREAM
+     */
+    explicit Mesh(BufferUsage usage = BUFFER_USAGE_STATIC)
+        : vbo(nullptr), usage(usage), uploadedVertices(0), uploadedIndices(0) {
         vertices.clear();
         vertices.shrink_to_fit();
         indices.clear();
@@ -70,9 +139,52 @@ template <class T> class Mesh : public NonCopy {
     // TODO: Vert type changes enabled attributes
     auto setup_buffer() -> void {
         if(vbo == nullptr)
-            vbo = GI::create_vertexbuffer(vertices.data(), vertices.size(), indices.data(), indices.size());
+            vbo = GI::create_vertexbuffer(vertices.data(), vertices.size(), indices.data(), indices.size(), usage);
         else
             vbo->update(vertices.data(), vertices.size(), indices.data(), indices.size());
+
+        uploadedVertices = vertices.size();
+        uploadedIndices = indices.size();
+        vtxDirty = idxDirty = DirtyRange();
+    }
+
+    /**
+     * @brief Marks vertices as changed since the last upload
+     *
+     * @param offset First changed vertex
+     * @param count Number of changed vertices
+     */
+    auto mark_vertices_dirty(size_t offset, size_t count) -> void {
+        vtxDirty.add(offset, count);
+    }
+
+    /**
+     * @brief Marks indices as changed since the last upload
+     *
+     * @param offset First changed index
+     * @param count Number of changed indices
+     */
+    auto mark_indices_dirty(size_t offset, size_t count) -> void {
+        idxDirty.add(offset, count);
+    }
+
+    /**
+     * @brief Uploads only the dirty ranges -- separate edits are merged into
+     * one span. Does a full upload if the array sizes changed since the last
+     * upload.
+     */
+    auto update_buffer() -> void {
+        if(vtxDirty.begin == vtxDirty.end && idxDirty.begin == idxDirty.end)
+            return;
+
+        if(vbo == nullptr || vertices.size() != uploadedVertices || indices.size() != uploadedIndices) {
+            setup_buffer();
+            return;
+        }
+
+        vbo->update_range(vertices.data(), vtxDirty.begin, vtxDirty.end - vtxDirty.begin,
+                          indices.data(), idxDirty.begin, idxDirty.end - idxDirty.begin);
+        vtxDirty = idxDirty = DirtyRange();
     }
 
     auto clear_data() -> void {
@@ -99,6 +211,43 @@ template <class T> class Mesh : public NonCopy {
         }
     }
 
+    /**
+     * @brief Draws a sub-range of the index buffer
+     *
+     * @param idx_offset First index to draw
+     * @param idx_count Number of indices to draw
+     * @param p Primitive type
+     */
+    auto draw_range(size_t idx_offset, size_t idx_count, PrimType p = PRIM_TYPE_TRIANGLE) -> void {
+        if(vbo != nullptr) {
+            vbo->bind();
+            Rendering::RenderContext::get().set_matrices();
+
+            vbo->draw_range(p, idx_offset, idx_count);
+        }
+    }
+
+    /**
+     * @brief Draws the mesh once per instance in a single call where the
+     * backend supports it
+     *
+     * @param instances Per-instance transform, tint and UV rectangle
+     * @param count Number of instances
+     * @param p Primitive type
+     */
+    auto draw_instanced(const InstanceData *instances, size_t count,
+                        PrimType p = PRIM_TYPE_TRIANGLE) -> void {
+        if(vbo != nullptr && count > 0) {
+            vbo->bind();
+            detail::draw_instances(vbo, instances, count, p);
+        }
+    }
+
+    auto draw_instanced(const std::vector<InstanceData> &instances,
+                        PrimType p = PRIM_TYPE_TRIANGLE) -> void {
+        draw_instanced(instances.data(), instances.size(), p);
+    }
+
     auto bind() -> void {
         if(vbo != nullptr) {
             vbo->bind();
@@ -106,21 +255,26 @@ template <class T> class Mesh : public NonCopy {
     }
 
     inline auto get_index_count() -> s32 { return indices.size(); }
+    inline auto get_buffer() -> GI::BufferObject * { return vbo; }
 #if USE_EASTL
     eastl::vector<T> vertices;
-    eastl::vector<u16> indices;
+    eastl::vector<Index> indices;
 #else
     std::vector<T> vertices;
-    std::vector<u16> indices;
+    std::vector<Index> indices;
 #endif
 };
 
-template <class T, size_t V, size_t I> class FixedMesh : public NonCopy {
+template <class T, size_t V, size_t I, class Index = u16> class FixedMesh : public NonCopy {
+    static_assert(std::is_same_v<Index, u16> || std::is_same_v<Index, u32>,
+                  "Mesh indices must be u16 or u32");
+
   private:
       GI::BufferObject* vbo;
+      BufferUsage usage;
 
   public:
-    FixedMesh() : vbo(nullptr) {
+    explicit FixedMesh(BufferUsage usage = BUFFER_USAGE_STATIC) : vbo(nullptr), usage(usage) {
         for (int i = 0; i < V; i++) {
             vertices[i] = {0};
         }
@@ -134,7 +288,7 @@ template <class T, size_t V, size_t I> class FixedMesh : public NonCopy {
     // TODO: Vert type changes enabled attributes
     auto setup_buffer() -> void {
         if(vbo == nullptr)
-            vbo = GI::create_vertexbuffer(vertices.data(), vertices.size(), indices.data(), indices.size());
+            vbo = GI::create_vertexbuffer(vertices.data(), vertices.size(), indices.data(), indices.size(), usage);
         else
             vbo->update(vertices.data(), vertices.size(), indices.data(), indices.size());
     }
@@ -166,6 +320,27 @@ template <class T, size_t V, size_t I> class FixedMesh : public NonCopy {
         }
     }
 
+    /**
+     * @brief Draws the mesh once per instance in a single call where the
+     * backend supports it
+     *
+     * @param instances Per-instance transform, tint and UV rectangle
+     * @param count Number of instances
+     * @param p Primitive type
+     */
+    auto draw_instanced(const InstanceData *instances, size_t count,
+                        PrimType p = PRIM_TYPE_TRIANGLE) -> void {
+        if(vbo != nullptr && count > 0) {
+            vbo->bind();
+            detail::draw_instances(vbo, instances, count, p);
+        }
+    }
+
+    auto draw_instanced(const std::vector<InstanceData> &instances,
+                        PrimType p = PRIM_TYPE_TRIANGLE) -> void {
+        draw_instanced(instances.data(), instances.size(), p);
+    }
+
     auto bind() -> void {
         if(vbo != nullptr) {
             vbo->bind();
@@ -173,13 +348,14 @@ template <class T, size_t V, size_t I> class FixedMesh : public NonCopy {
     }
 
     inline auto get_index_count() -> s32 { return indices.size(); }
+    inline auto get_buffer() -> GI::BufferObject * { return vbo; }
 
 #if USE_EASTL
     eastl::array<T, V> vertices;
-    eastl::array<u16, I> indices;
+    eastl::array<Index, I> indices;
 #else
     std::array<T, V> vertices;
-    std::array<u16, I> indices;
+    std::array<Index, I> indices;
 #endif
 };
 
@@ -0,0 +1,135 @@
+#pragma once
+#include <Utilities/Types.hpp>
+#include <cstddef>
+
+/**
+ * @brief Pixel format conversion and layout kernels shared by the texture
+ * loaders and sc-cook. RGBA8888 pixels are bytes R, G, B, A in memory; the
+ * 16-bit formats follow the PSP GE layout, red in the low bits. Every SIMD
+ * path (SSE2, AVX2, NEON, picked at compile time) gives the same bits as the
+ * scalar one.
+ *
+ */
+namespace Stardust_Celeste::Rendering::PixelOps {
+
+/**
+ * @brief RGBA8888 to 4444 -- each channel keeps its top 4 bits
+ */
+auto rgba8888_to_4444(u16 *dst, const u32 *src, size_t count) -> void;
+
+/**
+ * @brief RGBA8888 to 5551 -- colors keep their top 5 bits, alpha its top bit
+ */
+auto rgba8888_to_5551(u16 *dst, const u32 *src, size_t count) -> void;
+
+/**
+ * @brief RGBA8888 to 565 -- alpha is dropped
+ */
+auto rgba8888_to_565(u16 *dst, const u32 *src, size_t count) -> void;
+
+/**
+ * @brief 4444 to RGBA8888, channels widened by bit replication
+ */
+auto rgba4444_to_8888(u32 *dst, const u16 *src, size_t count) -> void;
+
+/**
+ * @brief 5551 to RGBA8888, channels widened by bit replication
+ */
+auto rgba5551_to_8888(u32 *dst, const u16 *src, size_t count) -> void;
+
+/**
+ * @brief 565 to RGBA8888, channels widened by bit replication, alpha opaque
+ */
+auto rgba565_to_8888(u32 *dst, const u16 *src, size_t count) -> void;
+
+/**
+ * @brief Colors of a BC1 color block -- the two 565 endpoints and the two
+ * interpolated between them. A block whose first endpoint is not above the
+ * second has one midpoint and transparent black instead, unless fourColor
+ * is set as for BC3.
+ *
+ * @param block 8 byte color block
+ * @param palette Resulting RGBA8888 colors, indexed by the 2-bit codes
+ * @param fourColor Always interpolate two colors
+ */
+auto bc1_palette(const u8 *block, u32 palette[4], bool fourColor) -> void;
+
+/**
+ * @brief Alpha values of a BC3 alpha block, indexed by the 3-bit codes
+ */
+auto bc3_alpha_palette(const u8 *block, u8 palette[8]) -> void;
+
+/**
+ * @brief Decodes BC1 (DXT1) to RGBA8888. Blocks of 4x4 texels are stored
+ * row by row, 8 bytes each; blocks past the image edge are cropped.
+ */
+auto decode_bc1(u32 *dst, const u8 *src, u32 width, u32 height) -> void;
+
+/**
+ * @brief Decodes BC3 (DXT5) to RGBA8888 -- as BC1, with a 8 byte alpha block
+ * before each color block
+ */
+auto decode_bc3(u32 *dst, const u8 *src, u32 width, u32 height) -> void;
+
+/**
+ * @brief Multiplies the colors of RGBA8888 pixels by their alpha, rounded
+ * to nearest
+ */
+auto premultiply_alpha(u32 *pixels, size_t count) -> void;
+
+/**
+ * @brief Flips an image upside down in place
+ *
+ * @param pixels Image
+ * @param stride Bytes per row
+ * @param rows Rows
+ */
+auto flip_vertical(u8 *pixels, size_t stride, u32 rows) -> void;
+
+/**
+ * @brief Copies an image into the top left of a larger one and clears the
+ * rest, as for power of two padding
+ *
+ * @param dst Destination, dstStride * dstRows bytes
+ * @param dstStride Destination bytes per row
+ * @param dstRows Destination rows
+ * @param src Source image
+ * @param srcStride Source bytes per row
+ * @param srcRows Source rows
+ */
+auto pad_image(u8 *dst, size_t dstStride, u32 dstRows, const u8 *src,
+               size_t srcStride, u32 srcRows) -> void;
+
+/**
+ * @brief Reorders pixels into the PSP's swizzled layout of 16 byte x 8 row
+ * blocks
+ *
+ * @param dst Destination, same size as src
+ * @param src Source pixels
+ * @param stride Bytes per row, a multiple of 16
+ * @param rows Rows, a multiple of 8
+ */
+auto swizzle(u8 *dst, const u8 *src, u32 stride, u32 rows) -> void;
+
+/**
+ * @brief The portable versions of the kernels that have SIMD paths, which
+ * those paths must match bit for bit -- used by the host tests
+ */
+namespace Scalar {
+auto rgba8888_to_4444(u16 *dst, const u32 *src, size_t count) -> void;
+auto rgba8888_to_5551(u16 *dst, const u32 *src, size_t count) -> void;
+auto rgba8888_to_565(u16 *dst, const u32 *src, size_t count) -> void;
+auto premultiply_alpha(u32 *pixels, size_t count) -> void;
+} // namespace Scalar
+
+/**
+ * @brief Smallest power of two at least as large as a value
+ */
+inline auto pow2(u32 value) -> u32 {
+    u32 p = 1;
+    while (p < value)
+        p <<= 1;
+    return p;
+}
+
+} // namespace Stardust_Celeste::Rendering::PixelOps
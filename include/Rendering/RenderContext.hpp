@@ -8,6 +8,7 @@
 #include <mathfu/vector.h>
 #include <mathfu/matrix.h>
 
+#include "Frustum.hpp"
 #include "GI.hpp"
 #include "RenderTypes.hpp"
 
@@ -30,11 +31,39 @@ class RenderContext final : public Singleton {
 
     UBOLayout _ubo;
 
+    // Current model matrix -- _ubo.model holds the product uploaded to shaders
+    mathfu::Matrix<float, 4, 4> _model;
+    // Product of all pushed matrices, kept up to date on push / pop
+    mathfu::Matrix<float, 4, 4> _stackProduct;
+
     std::vector<mathfu::Matrix<float, 4, 4>> _matrixStack;
+    std::vector<mathfu::Matrix<float, 4, 4>> _productStack;
+
+    // Bit N marks matrix N of UBOLayout as changed since the last upload
+    enum MatrixDirty : u8 {
+        MATRIX_DIRTY_PROJ = 1 << 0,
+        MATRIX_DIRTY_VIEW = 1 << 1,
+        MATRIX_DIRTY_MODEL = 1 << 2,
+        MATRIX_DIRTY_ALL = MATRIX_DIRTY_PROJ | MATRIX_DIRTY_VIEW | MATRIX_DIRTY_MODEL
+    };
+    u8 _dirty;
+
+    /**
+     * @brief Replaces all matrices -- model is taken as already multiplied
+     * by the stack
+     */
+    auto load_matrices(const mathfu::Matrix<float, 4, 4> &proj,
+                       const mathfu::Matrix<float, 4, 4> &view,
+                       const mathfu::Matrix<float, 4, 4> &model) -> void;
+
+    friend class RenderQueue;
 
   public:
     RenderContext()
-        : _gfx_persp(1), _gfx_ortho(1) {
+        : _gfx_persp(1), _gfx_ortho(1),
+          _model(mathfu::Matrix<float, 4, 4>::Identity()),
+          _stackProduct(mathfu::Matrix<float, 4, 4>::Identity()),
+          _dirty(MATRIX_DIRTY_ALL) {
         c = Rendering::Color{{0xFF, 0xFF, 0xFF, 0xFF}};
         _ubo.proj = mathfu::Matrix<float, 4, 4>(1);
         _ubo.view = mathfu::Matrix<float, 4, 4>(1);
@@ -68,11 +97,22 @@ class RenderContext final : public Singleton {
     inline auto set_color(Color color) -> void { c = color; }
 
     /**
-     * @brief Render final to screen
+     * @brief Flushes the RenderQueue and renders final to screen
      *
      */
     auto render() -> void;
 
+    /**
+     * @brief Captures the current frame without stalling rendering -- the
+     * callback gets its pixels a few frames later
+     *
+     * @param callback Receives RGBA8 rows from top to bottom
+     * @return false if the platform cannot capture
+     */
+    inline auto request_capture(GI::CaptureCallback callback) -> bool {
+        return GI::request_capture(std::move(callback));
+    }
+
     /**
      * @brief Get a static RenderContext
      *
@@ -92,7 +132,8 @@ class RenderContext final : public Singleton {
     inline auto initialized() -> bool { return is_init; }
 
     /**
-     * @brief Set the matrices for shaders
+     * @brief Set the matrices for shaders -- does nothing if no matrix changed
+     * since the last call
      *
      */
     auto set_matrices() -> void;
@@ -186,14 +227,26 @@ class RenderContext final : public Singleton {
      */
     auto set_mode_3D() -> void;
 
+    // The references may be written through, so the matrix is re-uploaded
     inline auto get_projection_matrix() -> mathfu::Matrix<float, 4, 4> & {
+        _dirty |= MATRIX_DIRTY_PROJ;
         return _ubo.proj;
     }
     inline auto get_view_matrix() -> mathfu::Matrix<float, 4, 4> & {
+        _dirty |= MATRIX_DIRTY_VIEW;
         return _ubo.view;
     }
     inline auto get_model_matrix() -> mathfu::Matrix<float, 4, 4> & {
-        return _ubo.model;
+        _dirty |= MATRIX_DIRTY_MODEL;
+        return _model;
+    }
+
+    /**
+     * @brief View volume of the next draw, in the current model space
+     *
+     */
+    inline auto get_frustum() const -> Frustum {
+        return Frustum(_ubo.proj * _ubo.view * _stackProduct * _model);
     }
 
     /**
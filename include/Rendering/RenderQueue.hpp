@@ -0,0 +1,123 @@
+#pragma once
+
+#include "Utilities/Singleton.hpp"
+#include "Utilities/Types.hpp"
+#include <mathfu/matrix.h>
+#include <vector>
+
+#include "GI.hpp"
+#include "RenderTypes.hpp"
+
+namespace Stardust_Celeste::Rendering {
+
+/**
+ * @brief Render state of a queued draw
+ * texture -- Texture ID, 0 draws untextured
+ * layer -- Coarse draw order, lower layers are drawn first
+ * depth -- Distance from the camera, orders draws within a layer
+ * translucent -- Blended draws go after opaque ones, back to front
+ */
+struct DrawState {
+    u32 texture = 0;
+    s16 layer = 0;
+    float depth = 0.0f;
+    bool translucent = false;
+};
+
+/**
+ * @brief Counters of the last flushed queue. State changes count texture,
+ * blend, buffer and matrix switches between consecutive packets.
+ */
+struct RenderQueueStats {
+    u32 packets = 0;
+    u32 state_changes_unsorted = 0;
+    u32 state_changes_sorted = 0;
+};
+
+/**
+ * @brief Records draws during on_draw and submits them sorted at
+ * RenderContext::render(). Keys are ordered as translucency, layer, then
+ * texture / depth front to back for opaque draws and depth back to front /
+ * texture for translucent ones.
+ */
+class RenderQueue final : public Singleton {
+  public:
+    inline static auto get() -> RenderQueue & {
+        static RenderQueue queue;
+        return queue;
+    }
+
+    /**
+     * @brief Queues a mesh with the current matrices -- the mesh must stay
+     * alive and uploaded until the queue is flushed
+     *
+     * @param mesh Mesh or FixedMesh
+     * @param state Render state
+     * @param p Primitive type
+     */
+    template <class M>
+    auto submit(M &mesh, const DrawState &state,
+                PrimType p = PRIM_TYPE_TRIANGLE) -> void {
+        submit(mesh.get_buffer(), 0, mesh.get_index_count(), state, p);
+    }
+
+    /**
+     * @brief Queues an index range of a buffer with the current matrices
+     *
+     * @param vbo Buffer to draw
+     * @param idx_offset First index
+     * @param idx_count Number of indices
+     * @param state Render state
+     * @param p Primitive type
+     */
+    auto submit(GI::BufferObject *vbo, size_t idx_offset, size_t idx_count,
+                const DrawState &state, PrimType p = PRIM_TYPE_TRIANGLE)
+        -> void;
+
+    /**
+     * @brief Sorts and draws all queued packets, then empties the queue
+     */
+    auto flush() -> void;
+
+    /**
+     * @brief Drops all queued packets without drawing them
+     */
+    auto clear() -> void;
+
+    inline auto get_stats() const -> RenderQueueStats { return stats; }
+
+  private:
+    RenderQueue() = default;
+
+    struct Matrices {
+        mathfu::Matrix<float, 4, 4> proj;
+        mathfu::Matrix<float, 4, 4> view;
+        mathfu::Matrix<float, 4, 4> model;
+    };
+
+    struct DrawPacket {
+        u64 key;
+        GI::BufferObject *vbo;
+        size_t idx_offset;
+        size_t idx_count;
+        u32 texture;
+        u32 matrices;
+        PrimType prim;
+        bool translucent;
+    };
+
+    static auto make_key(const DrawState &state) -> u64;
+    auto count_state_changes(const u32 *order) const -> u32;
+    auto sort() -> void;
+
+    std::vector<DrawPacket> packets;
+    std::vector<Matrices> matrices;
+
+    // Radix sort scratch, kept between frames
+    std::vector<u64> keys, keysTemp;
+    std::vector<u32> order, orderTemp;
+
+    RenderQueueStats stats;
+};
+
+} // namespace Stardust_Celeste::Rendering
@@ -1,6 +1,8 @@
 #pragma once
 #include <Utilities/Types.hpp>
+#include <algorithm>
 #include <array>
+#include <cmath>
 #include <string>
 #include <mathfu/vector.h>
 
@@ -8,6 +10,13 @@ namespace Stardust_Celeste::Rendering {
 
     enum PrimType { PRIM_TYPE_TRIANGLE, PRIM_TYPE_LINE };
 
+    /**
+     * @brief How often a vertex buffer is rewritten.
+     * STATIC: uploaded once, DYNAMIC: rewritten occasionally,
+     * STREAM: rewritten every frame.
+     */
+    enum BufferUsage { BUFFER_USAGE_STATIC, BUFFER_USAGE_DYNAMIC, BUFFER_USAGE_STREAM };
+
 /**
  * @brief Color union object
  *
@@ -35,6 +44,16 @@ union Color {
 #define VERT_PACKED
 #endif
 
+// Texture arrays are desktop GL only, other vertex layouts stay untouched
+#if BUILD_PLAT == BUILD_WINDOWS || BUILD_PLAT == BUILD_POSIX
+#define SC_TEXTURE_ARRAYS 1
+#else
+#define SC_TEXTURE_ARRAYS 0
+#endif
+
+// Atlas animation in the vertex shader is desktop GL only as well
+#define SC_GPU_ANIMATION SC_TEXTURE_ARRAYS
+
 /**
  * @brief Packed vertices
  */
@@ -42,8 +61,55 @@ struct VERT_PACKED Vertex {
     float u, v;
     Color color;
     float x, y, z;
+#if SC_TEXTURE_ARRAYS
+    // Texture array layer, ignored when a plain texture is bound
+    float sheet = 0.0f;
+#endif
+#if SC_GPU_ANIMATION
+    // Atlas animation run by the vertex shader, see set_animation
+    u16 frame = 0, frames = 0, rate = 0, phase = 0;
+#endif
 };
 
+/**
+ * @brief Sets the texture array layer a vertex samples, a no-op where
+ * texture arrays are not supported
+ */
+inline auto set_sheet(Vertex &vertex, u16 sheet) -> void {
+#if SC_TEXTURE_ARRAYS
+    vertex.sheet = static_cast<float>(sheet);
+#else
+    (void)vertex;
+    (void)sheet;
+#endif
+}
+
+/**
+ * @brief Makes a vertex step through atlas frames on the GPU while
+ * GI::enable_atlas_animation is on, a no-op where that is not supported
+ *
+ * @param frame Atlas index the vertex UVs were built for
+ * @param frames Frames in the cycle, starting at frame -- 0 or 1 for none
+ * @param fps Frames per second
+ * @param phase Frames the cycle is ahead by
+ */
+inline auto set_animation(Vertex &vertex, u16 frame, u16 frames, float fps,
+                          u16 phase = 0) -> void {
+#if SC_GPU_ANIMATION
+    vertex.frame = frame;
+    vertex.frames = frames;
+    // 12.4 fixed point
+    vertex.rate = static_cast<u16>(std::min(std::max(fps, 0.0f), 4095.0f) * 16.0f);
+    vertex.phase = phase;
+#else
+    (void)vertex;
+    (void)frame;
+    (void)frames;
+    (void)fps;
+    (void)phase;
+#endif
+}
+
 /**
  * @brief Packed simple vertex
  */
@@ -66,6 +132,42 @@ struct Rectangle {
     mathfu::Vector<float, 2> extent;
 };
 
+/**
+ * @brief Per-instance data for instanced draws
+ * a, b, c, d -- 2x2 transform applied to the mesh's x / y (row major)
+ * x, y, z -- Translation, z is added to the layer
+ * color -- Tint multiplied with the vertex color
+ * u, v, u_scale, v_scale -- Atlas rectangle the mesh UVs are mapped into
+ */
+struct VERT_PACKED InstanceData {
+    float a = 1.0f, b = 0.0f, c = 0.0f, d = 1.0f;
+    float x = 0.0f, y = 0.0f, z = 0.0f;
+    Color color = {{0xFF, 0xFF, 0xFF, 0xFF}};
+    float u = 0.0f, v = 0.0f, u_scale = 1.0f, v_scale = 1.0f;
+
+    /**
+     * @brief Sets the transform from a position, scale and rotation
+     *
+     * @param position Translation
+     * @param scale Scale
+     * @param rotation Rotation in radians
+     */
+    inline auto set_transform(mathfu::Vector<float, 3> position,
+                              mathfu::Vector<float, 2> scale, float rotation)
+        -> void {
+        auto cs = std::cos(rotation);
+        auto sn = std::sin(rotation);
+
+        a = cs * scale.x;
+        b = -sn * scale.y;
+        c = sn * scale.x;
+        d = cs * scale.y;
+        x = position.x;
+        y = position.y;
+        z = position.z;
+    }
+};
+
 /**
  * @brief Texture Data
  *
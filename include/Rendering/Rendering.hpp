@@ -2,5 +2,6 @@
 
 #include "Camera.hpp"
 #include "RenderContext.hpp"
+#include "RenderQueue.hpp"
 #include "Mesh.hpp"
 #include "Texture.hpp"
\ No newline at end of file
@@ -1,8 +1,16 @@
 #pragma once
+#include "ImageDecoder.hpp"
 #include "RenderTypes.hpp"
+#include "TextureArray.hpp"
+#include "TextureAtlas.hpp"
 #include <Utilities/Singleton.hpp>
+#include <condition_variable>
+#include <deque>
 #include <map>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 #if (BUILD_PLAT == BUILD_WINDOWS || BUILD_PLAT == BUILD_POSIX)
 #include <glad/glad.hpp>
@@ -32,32 +40,268 @@
 
 namespace Stardust_Celeste::Rendering {
 
+/**
+ * @brief Texture memory in use. GPU bytes count mip levels; CPU bytes are
+ * pixel copies kept with needPix.
+ */
+struct TextureMemoryStats {
+    u64 gpu_bytes = 0;
+    u64 cpu_bytes = 0;
+    u64 budget = 0;
+    u32 textures = 0;
+    u32 evicted = 0;
+};
+
 class TextureManager final : public Singleton {
   public:
     TextureManager() = default;
     ~TextureManager();
 
+    /**
+     * @brief Loads a texture from a file. Loading a path that is already
+     * loaded returns the existing texture with its reference count raised,
+     * keeping the parameters of the first load.
+     *
+     * @return Texture handle, never 0
+     */
     auto load_texture(std::string filename, u32 magFilter, u32 minFilter,
                       bool repeat, bool flip = false, bool vram = false) -> u32;
 
     auto load_texture_ram(u8* buffer, size_t length, u32 magFilter, u32 minFilter,
                           bool repeat, bool flip = false, bool vram = false, bool needPix = false) -> u32;
 
+    /**
+     * @brief Loads a texture cooked by sc-cook. Its pixels are already in
+     * the platform's format, so loading costs little more than the read.
+     */
+    auto load_cooked(std::string filename, u32 magFilter, u32 minFilter,
+                     bool repeat, bool vram = false) -> u32;
+
+    /**
+     * @brief Decodes a texture on a worker thread. The ID is valid
+     * immediately, but draws untextured until the upload in a later frame.
+     */
+    auto load_texture_async(std::string filename, u32 magFilter,
+                            u32 minFilter, bool repeat, bool flip = false,
+                            bool vram = false) -> u32;
+
+    /**
+     * @brief Whether a texture exists and is no longer waiting on its decode
+     */
+    auto is_texture_ready(u32 id) -> bool;
+
+    /**
+     * @brief Uploads decoded textures until the budget is used up
+     */
+    auto process_uploads() -> void;
+
+    /**
+     * @brief Advances the frame counter, uploads finished async textures and
+     * evicts textures over the memory budget -- called once per frame by
+     * RenderContext
+     */
+    auto begin_frame() -> void;
+
+    /**
+     * @brief Texture memory budget in bytes, 0 for none. Past it, textures
+     * loaded from files that have not been bound or uploaded for the eviction
+     * age are unloaded, least recently bound first, and reloaded when next
+     * bound.
+     */
+    inline auto set_memory_budget(u64 bytes) -> void { memoryBudget = bytes; }
+
+    /**
+     * @brief Frames a texture must go unbound before it can be evicted
+     */
+    inline auto set_eviction_age(u32 frames) -> void { evictionAge = frames; }
+
+    auto get_memory_stats() const -> TextureMemoryStats;
+
+    /**
+     * @brief GPU plus CPU bytes of one texture, 0 for an invalid handle
+     */
+    auto get_texture_memory(u32 id) -> u64;
+
+    /**
+     * @brief Frees the CPU pixel copy kept with needPix, once nothing needs
+     * to read it anymore
+     */
+    auto release_pixels(u32 id) -> void;
+
+    /**
+     * @brief Time process_uploads may spend per frame, in milliseconds
+     */
+    inline auto set_upload_budget(double ms) -> void { uploadBudget = ms; }
+
+    /**
+     * @brief Packs images into as few atlas pages as fit them, so sprites,
+     * tilemaps and fonts using different images can share a texture. Each
+     * image gets a 1 pixel border of its edge pixels to stop filtering from
+     * bleeding in its neighbours.
+     *
+     * @param filenames Images to pack
+     * @param needPix Keep the page pixels, as FontRenderer needs
+     * @param pageSize Page width and largest page height
+     */
+    auto load_atlas(const std::vector<std::string> &filenames, u32 magFilter,
+                    u32 minFilter, bool flip = false, bool needPix = false,
+                    u32 pageSize = ATLAS_PAGE_SIZE) -> TextureAtlas;
+
+    /**
+     * @brief Deletes the pages of an atlas and clears it
+     */
+    auto delete_atlas(TextureAtlas &atlas) -> void;
+
+    /**
+     * @brief Loads images as layers of array textures, one per image size, so
+     * a Tilemap or SpriteBatch drawing from several of them needs one bind.
+     * Vertices pick their layer with set_sheet. Where arrays are not
+     * supported each image is a plain texture at sheet 0.
+     *
+     * @param filenames Images to load
+     */
+    auto load_texture_array(const std::vector<std::string> &filenames,
+                            u32 magFilter, u32 minFilter, bool repeat,
+                            bool flip = false) -> TextureArray;
+
+    /**
+     * @brief Deletes the textures of an array group and clears it
+     */
+    auto delete_texture_array(TextureArray &array) -> void;
+
     auto get_texture(std::string name) -> u32;
 
     auto bind_texture(u32 id) -> void;
+
+    /**
+     * @brief Drops one reference, the texture is freed once none are left
+     */
     auto delete_texture(u32 id) -> void;
 
+#if BUILD_PLAT == BUILD_PSP
+    static constexpr u32 ATLAS_PAGE_SIZE = 512;
+#elif BUILD_PLAT == BUILD_3DS
+    static constexpr u32 ATLAS_PAGE_SIZE = 1024;
+#else
+    static constexpr u32 ATLAS_PAGE_SIZE = 2048;
+#endif
+
+    // GL guarantees at least this many layers per array texture
+    static constexpr u32 MAX_ARRAY_LAYERS = 256;
+
     inline static auto get() -> TextureManager & {
         static TextureManager txm;
         return txm;
     }
 
-    inline auto get_texture(unsigned int i) -> Texture * { return fullMap[i]; }
+    /**
+     * @brief Texture of a handle, nullptr if it was deleted or never existed
+     */
+    inline auto get_texture(unsigned int i) -> Texture * { return resolve(i); }
+
+    /**
+     * @brief Slot of a handle, stable for the texture's lifetime and below
+     * 2^20
+     */
+    inline static auto handle_index(u32 id) -> u32 {
+        return id & HANDLE_INDEX_MASK;
+    }
 
   private:
-    std::unordered_map<unsigned int, Texture *> fullMap;
-    u32 texCount = 1;
+    struct DecodeJob {
+        u32 id;
+        std::string filename;
+        bool flip;
+    };
+
+    struct DecodeResult {
+        u32 id;
+        DecodedImage image;
+    };
+
+    // Handles are [31..20] generation | [19..0] slot, generation never 0
+    static constexpr u32 HANDLE_INDEX_BITS = 20;
+    static constexpr u32 HANDLE_INDEX_MASK = (1u << HANDLE_INDEX_BITS) - 1;
+    static constexpr u32 HANDLE_GENERATION_MASK = 0xFFF;
+
+    // Where an evicted texture is reloaded from
+    enum TextureSource : u8 {
+        TEXTURE_SOURCE_MEMORY,
+        TEXTURE_SOURCE_FILE,
+        TEXTURE_SOURCE_COOKED,
+    };
+
+    struct TextureSlot {
+        Texture *texture = nullptr;
+        u32 generation = 1;
+        u32 refs = 0;
+
+        u64 gpuBytes = 0;
+        u64 cpuBytes = 0;
+        u64 lastBound = 0;
+        TextureSource source = TEXTURE_SOURCE_MEMORY;
+        bool flip = false;
+        bool vram = false;
+        bool evicted = false;
+    };
+
+    static constexpr u32 MAX_DECODE_WORKERS = 4;
+    static constexpr size_t MAX_DECODED_TEXTURES = 8;
+
+    inline auto resolve(u32 id) -> Texture * {
+        auto index = handle_index(id);
+        if (index >= slots.size())
+            return nullptr;
+
+        auto &slot = slots[index];
+        if (slot.generation != (id >> HANDLE_INDEX_BITS))
+            return nullptr;
+        return slot.texture;
+    }
+
+    auto insert(Texture *tex) -> u32;
+    auto destroy(u32 id) -> void;
+    auto acquire_existing(const std::string &filename) -> u32;
+
+    auto create_entry(std::string filename, u32 magFilter, u32 minFilter,
+                      bool repeat) -> u32;
+    auto finish_texture(u32 id, DecodedImage &image, bool vram) -> void;
+    auto read_cooked(u32 id, bool vram) -> void;
+
+    auto account(u32 id, u64 gpuBytes) -> void;
+    auto release_gpu(Texture *tex) -> void;
+    auto evict(u32 index) -> void;
+    auto reload(u32 id) -> void;
+    auto enforce_budget() -> void;
+
+    auto start_workers() -> void;
+    auto stop_workers() -> void;
+    auto decode_worker() -> void;
+
+    std::vector<TextureSlot> slots;
+    std::vector<u32> freeSlots;
+    std::unordered_map<std::string, u32> nameIndex;
+
+    // Async IDs still waiting on their upload, mapped to their VRAM flag
+    std::unordered_map<u32, bool> pending;
+    double uploadBudget = 2.0;
+
+    u64 frame = 0;
+    u64 memoryBudget = 0;
+    u32 evictionAge = 300;
+    u64 gpuTotal = 0;
+    u64 cpuTotal = 0;
+    bool overBudget = false;
+    u32 atlasCount = 0;
+    u32 arrayCount = 0;
+
+    std::vector<std::thread> workers;
+    std::mutex queueMutex;
+    std::condition_variable jobReady;
+    std::condition_variable resultTaken;
+    std::deque<DecodeJob> jobs;
+    std::deque<DecodeResult> decoded;
+    bool stopping = false;
 };
 
 } // namespace Stardust_Celeste::Rendering
\ No newline at end of file
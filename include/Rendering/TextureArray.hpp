@@ -0,0 +1,40 @@
+#pragma once
+#include <Utilities/Types.hpp>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Stardust_Celeste::Rendering {
+
+/**
+ * @brief Layer of an array texture
+ * texture -- Texture ID, shared by every image of the same size
+ * sheet -- Layer within it, always 0 where arrays are not supported
+ * width, height -- Image size in pixels
+ */
+struct TextureSheet {
+    u32 texture = 0;
+    u16 sheet = 0;
+    u32 width = 0, height = 0;
+};
+
+/**
+ * @brief Textures and named layers of a group of array textures
+ *
+ */
+struct TextureArray {
+    std::vector<u32> textures;
+    std::unordered_map<std::string, TextureSheet> sheets;
+
+    /**
+     * @brief Layer of a source image, texture 0 if it is not in the group
+     *
+     * @param name Filename the image was loaded from
+     */
+    inline auto get_sheet(const std::string &name) const -> TextureSheet {
+        auto it = sheets.find(name);
+        return it != sheets.end() ? it->second : TextureSheet();
+    }
+};
+
+} // namespace Stardust_Celeste::Rendering
@@ -0,0 +1,90 @@
+#pragma once
+#include "RenderTypes.hpp"
+#include <Utilities/Types.hpp>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Stardust_Celeste::Rendering {
+
+/**
+ * @brief Sub-rectangle of an atlas page
+ * texture -- Page texture ID
+ * selection -- Region in texture coordinates, usable as a Sprite selection
+ * x, y, width, height -- Region in page pixels
+ */
+struct AtlasRegion {
+    u32 texture = 0;
+    Rectangle selection{{0, 0}, {1, 1}};
+    u32 x = 0, y = 0;
+    u32 width = 0, height = 0;
+};
+
+/**
+ * @brief Pages and named regions of a packed atlas
+ *
+ */
+struct TextureAtlas {
+    std::vector<u32> pages;
+    std::unordered_map<std::string, AtlasRegion> regions;
+
+    // Source pixels, and pixels of the pages they were packed into
+    u64 usedArea = 0;
+    u64 pageArea = 0;
+
+    /**
+     * @brief Region of a source image, texture 0 if it is not in the atlas
+     *
+     * @param name Filename the image was loaded from
+     */
+    inline auto get_region(const std::string &name) const -> AtlasRegion {
+        auto it = regions.find(name);
+        return it != regions.end() ? it->second : AtlasRegion();
+    }
+
+    /**
+     * @brief Fraction of the page area covered by source images
+     */
+    inline auto packing_ratio() const -> float {
+        return pageArea > 0 ? (float)usedArea / (float)pageArea : 0.0f;
+    }
+};
+
+/**
+ * @brief Skyline bottom-left rectangle packer -- each rectangle goes where its
+ * top edge ends up lowest, ties broken to the left
+ *
+ */
+class SkylinePacker {
+  public:
+    SkylinePacker(u32 width, u32 height);
+
+    /**
+     * @brief Finds room for a rectangle
+     *
+     * @param w Width
+     * @param h Height
+     * @param x Resulting left edge
+     * @param y Resulting top edge
+     * @return false if it does not fit
+     */
+    auto insert(u32 w, u32 h, u32 &x, u32 &y) -> bool;
+
+    /**
+     * @brief Highest edge of any placed rectangle
+     */
+    inline auto get_used_height() const -> u32 { return usedHeight; }
+
+  private:
+    struct Segment {
+        s32 x, y, width;
+    };
+
+    auto fit(size_t index, s32 w, s32 h, s32 &y) const -> bool;
+
+    s32 width, height;
+    u32 usedHeight;
+    std::vector<Segment> skyline;
+};
+
+} // namespace Stardust_Celeste::Rendering
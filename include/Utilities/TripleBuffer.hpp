@@ -0,0 +1,68 @@
+#pragma once
+#include "NonCopy.hpp"
+#include "Types.hpp"
+#include <atomic>
+
+namespace Stardust_Celeste::Utilities {
+
+/**
+ * @brief Lock-free single producer / single consumer handoff. The producer
+ * fills its buffer and publishes it, the consumer always picks up the
+ * latest published buffer; neither side ever waits for the other.
+ *
+ * @tparam T Buffer type -- the write buffer holds stale data after publish,
+ * so producers should rewrite it completely
+ */
+template <class T> class TripleBuffer final : public NonCopy {
+  public:
+    TripleBuffer() : shared(2), writeIdx(0), readIdx(1) {}
+
+    /**
+     * @brief Buffer owned by the producer
+     */
+    inline auto write_buffer() -> T & { return buffers[writeIdx]; }
+
+    /**
+     * @brief Makes the write buffer the latest snapshot and takes over the
+     * previously shared one
+     *
+     * @return true if the previous snapshot was never consumed
+     */
+    auto publish() -> bool {
+        auto prev = shared.exchange(writeIdx | NEW_BIT, std::memory_order_acq_rel);
+        writeIdx = prev & INDEX_MASK;
+        return (prev & NEW_BIT) != 0;
+    }
+
+    /**
+     * @brief Swaps in the latest snapshot if one was published since the
+     * last call
+     *
+     * @return true if the read buffer changed
+     */
+    auto acquire() -> bool {
+        if ((shared.load(std::memory_order_relaxed) & NEW_BIT) == 0)
+            return false;
+
+        auto prev = shared.exchange(readIdx, std::memory_order_acq_rel);
+        readIdx = prev & INDEX_MASK;
+        return true;
+    }
+
+    /**
+     * @brief Buffer owned by the consumer, valid until the next acquire
+     */
+    inline auto read_buffer() -> const T & { return buffers[readIdx]; }
+
+  private:
+    static constexpr u8 INDEX_MASK = 0x3;
+    static constexpr u8 NEW_BIT = 0x4;
+
+    T buffers[3];
+    // Index of the buffer between producer and consumer, plus NEW_BIT
+    std::atomic<u8> shared;
+    u8 writeIdx;
+    u8 readIdx;
+};
+
+} // namespace Stardust_Celeste::Utilities
@@ -9,4 +9,5 @@
 #include "Profiler.hpp"
 #include "Singleton.hpp"
 #include "Timer.hpp"
+#include "TripleBuffer.hpp"
 #include "Types.hpp"
\ No newline at end of file
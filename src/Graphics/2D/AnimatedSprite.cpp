@@ -1,4 +1,5 @@
 #include <Graphics/2D/AnimatedSprite.hpp>
+#include <Rendering/GI.hpp>
 #include <Rendering/Texture.hpp>
 
 namespace Stardust_Celeste::Graphics::G2D {
@@ -10,10 +11,42 @@ AnimatedSprite::AnimatedSprite(u32 texture, Rendering::Rectangle bounds,
     atlas = atlasSize;
     ticksPerSec = 4.0f;
     currentIDX = 0;
+    gpuAnimated = GI::supports_atlas_animation();
+    gpuRate = 0.0f;
+
+    // The shader steps from the first frame, so the quad starts there
+    if (gpuAnimated)
+        set_selection(frame_selection(startIDX));
 }
 AnimatedSprite::~AnimatedSprite() {}
 
+auto AnimatedSprite::frame_selection(u32 index) const -> Rendering::Rectangle {
+    auto w = 1.0f / atlas.x;
+    auto h = 1.0f / atlas.y;
+
+    auto idx = index % static_cast<int>(atlas.x);
+    auto idy = index / static_cast<int>(atlas.x);
+
+    return {{idx * w, idy * h}, {w, h}};
+}
+
+auto AnimatedSprite::frame_count() const -> u32 {
+    return endIDX >= startIDX ? endIDX - startIDX + 1 : 1;
+}
+
+auto AnimatedSprite::set_animation_range(u32 startIDX, u32 endIDX) -> void {
+    this->startIDX = startIDX;
+    this->endIDX = endIDX;
+    this->currentIDX = startIDX;
+
+    if (gpuAnimated)
+        set_selection(frame_selection(startIDX));
+}
+
 auto AnimatedSprite::tick() -> void {
+    if (gpuAnimated)
+        return;
+
     currentIDX++;
 
     if (currentIDX > endIDX)
@@ -22,17 +55,17 @@ auto AnimatedSprite::tick() -> void {
     if (currentIDX < startIDX)
         currentIDX = startIDX;
 
-    auto w = 1.0f / atlas.x;
-    auto h = 1.0f / atlas.y;
-
-    auto idx = currentIDX % static_cast<int>(atlas.x);
-    auto idy = currentIDX / static_cast<int>(atlas.x);
-
-    Rendering::Rectangle selection = { {idx * w, idy * h}, {w, h}};
-    set_selection(selection);
+    set_selection(frame_selection(currentIDX));
 }
 
 auto AnimatedSprite::update(double dt) -> void {
+    // Only a rate change touches the mesh
+    if (gpuAnimated) {
+        if (ticksPerSec != gpuRate)
+            update_mesh();
+        return;
+    }
+
     tickTimer += dt;
 
     if (tickTimer > 1.0f / ticksPerSec) {
@@ -41,4 +74,31 @@ auto AnimatedSprite::update(double dt) -> void {
     }
 }
 
-} // namespace Stardust_Celeste::Graphics::G2D
\ No newline at end of file
+auto AnimatedSprite::update_mesh() -> void {
+    if (!gpuAnimated) {
+        Sprite::update_mesh();
+        return;
+    }
+
+    auto quad = build_quad(texture, bounds, selection, color, layer, sheet);
+    for (auto &v : quad)
+        Rendering::set_animation(v, static_cast<u16>(startIDX),
+                                 static_cast<u16>(frame_count()), ticksPerSec);
+
+    gpuRate = ticksPerSec;
+    upload_quad(quad);
+}
+
+auto AnimatedSprite::draw() -> void {
+    if (!gpuAnimated) {
+        Sprite::draw();
+        return;
+    }
+
+    GI::enable_atlas_animation(static_cast<u32>(atlas.x), 1.0f / atlas.x,
+                               1.0f / atlas.y);
+    Sprite::draw();
+    GI::disable_atlas_animation();
+}
+
+} // namespace Stardust_Celeste::Graphics::G2D
@@ -1,4 +1,5 @@
 #include <Graphics/2D/AnimatedTilemap.hpp>
+#include <Rendering/GI.hpp>
 #include <Rendering/Texture.hpp>
 
 namespace Stardust_Celeste::Graphics::G2D {
@@ -8,6 +9,8 @@ AnimatedTilemap::AnimatedTilemap(u32 tex, mathfu::Vector<float, 2> atlasSize)
     atileMap.clear();
     atime = 0.0f;
     ticksPerSec = 4.0f;
+    gpuAnimated = GI::supports_atlas_animation();
+    gpuRate = 0.0f;
 }
 
 AnimatedTilemap::~AnimatedTilemap() { atileMap.clear(); }
@@ -32,6 +35,13 @@ auto AnimatedTilemap::clear_tiles() -> void {
 }
 
 auto AnimatedTilemap::update(double dt) -> void {
+    // Only new tiles or a rate change touch the mesh
+    if (gpuAnimated) {
+        if (meshTiles != atileMap.size() || ticksPerSec != gpuRate)
+            generate_map();
+        return;
+    }
+
     atime += dt;
 
     if (atime > 1.0f / ticksPerSec) {
@@ -41,6 +51,10 @@ auto AnimatedTilemap::update(double dt) -> void {
 }
 
 auto AnimatedTilemap::tick() -> void {
+    // The shader keeps the frames, a CPU step would fight it
+    if (gpuAnimated)
+        return;
+
     for (auto &t : atileMap) {
         t.index++;
 
@@ -49,56 +63,58 @@ auto AnimatedTilemap::tick() -> void {
         }
     }
 
-    generate_map();
+    if (meshTiles != atileMap.size()) {
+        generate_map();
+        return;
+    }
+
+    // Only the UVs move, so the index buffers stay as they are
+    build_tiles(atileMap.data(), atileMap.size());
+    for (auto &m : meshes)
+        m->mark_vertices_dirty(0, m->vertices.size());
 }
 
 auto AnimatedTilemap::generate_map() -> void {
-    mesh->delete_data();
-
-    auto idxc = 0;
-
-    for (auto &t : atileMap) {
-        auto x = t.bounds.position.x;
-        auto y = t.bounds.position.y;
-        auto w = t.bounds.extent.x;
-        auto h = t.bounds.extent.y;
+    refresh_uv_table();
+    resize_meshes(atileMap.size());
 
-        auto uvs = Rendering::Texture::get_tile_uvs(atlasDimensions, t.index);
-
-#if PSP
-        auto tInfo = Rendering::TextureManager::get().get_texture(texture);
-
-        float wRatio = 1.0f;
-        float hRatio = 1.0f;
+    if (!gpuAnimated) {
+        build_tiles(atileMap.data(), atileMap.size());
+        upload_meshes();
+        return;
+    }
 
-        if (tInfo != nullptr) {
-            wRatio = (float)tInfo->width / (float)tInfo->pW;
-            hRatio = (float)tInfo->height / (float)tInfo->pH;
-        }
+    // UVs point at the first frame, the shader offsets them from there
+    for (size_t i = 0; i < atileMap.size(); i++) {
+        auto t = atileMap[i];
+        auto frames = t.final_idx > t.start_idx ? t.final_idx - t.start_idx : 1;
+        auto phase = t.index > t.start_idx && t.index < t.final_idx
+                         ? t.index - t.start_idx
+                         : 0;
+        t.index = t.start_idx;
+
+        auto v = tile_vertices(i);
+        build_tile(t, v);
+        for (int j = 0; j < 4; j++)
+            Rendering::set_animation(v[j], t.start_idx, static_cast<u16>(frames),
+                                     ticksPerSec, static_cast<u16>(phase));
+    }
 
-        for (int i = 0; i < 4; i++) {
-            uvs[i * 2 + 0] *= wRatio;
-            uvs[i * 2 + 1] *= hRatio;
-        }
-#endif
+    gpuRate = ticksPerSec;
+    upload_meshes();
+}
 
-        mesh->vertices.push_back(
-            Rendering::Vertex{uvs[0], uvs[1], t.color, x, y, t.layer});
-        mesh->vertices.push_back(
-            Rendering::Vertex{uvs[2], uvs[3], t.color, x + w, y, t.layer});
-        mesh->vertices.push_back(
-            Rendering::Vertex{uvs[4], uvs[5], t.color, x + w, y + h, t.layer});
-        mesh->vertices.push_back(
-            Rendering::Vertex{uvs[6], uvs[7], t.color, x, y + h, t.layer});
-
-        mesh->indices.insert(mesh->indices.end(),
-                             {(u16)(idxc + 0), (u16)(idxc + 1), (u16)(idxc + 2),
-                              (u16)(idxc + 2), (u16)(idxc + 3),
-                              (u16)(idxc + 0)});
-        idxc += 4;
+auto AnimatedTilemap::draw() -> void {
+    if (!gpuAnimated) {
+        Tilemap::draw();
+        return;
     }
 
-    mesh->setup_buffer();
+    GI::enable_atlas_animation(static_cast<u32>(atlasDimensions.x),
+                               region.extent.x / atlasDimensions.x,
+                               region.extent.y / atlasDimensions.y);
+    Tilemap::draw();
+    GI::disable_atlas_animation();
 }
 
-} // namespace Stardust_Celeste::Graphics::G2D
\ No newline at end of file
+} // namespace Stardust_Celeste::Graphics::G2D
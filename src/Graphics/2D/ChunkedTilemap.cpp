@@ -0,0 +1,182 @@
+#include <Graphics/2D/ChunkedTilemap.hpp>
+#include <Rendering/Texture.hpp>
+#include <Utilities/Assertion.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace Stardust_Celeste::Graphics::G2D {
+
+ChunkedTilemap::ChunkedTilemap(u32 tex, mathfu::Vector<float, 2> atlasSize,
+                               float size)
+    : Tilemap(tex, atlasSize), chunkSize(size), visibleChunks(0) {
+    SC_CORE_ASSERT(size > 0, "ChunkedTilemap construction: Chunk size is <= 0!");
+}
+
+ChunkedTilemap::ChunkedTilemap(const Rendering::AtlasRegion &atlasRegion,
+                               mathfu::Vector<float, 2> atlasSize, float size)
+    : Tilemap(atlasRegion, atlasSize), chunkSize(size), visibleChunks(0) {
+    SC_CORE_ASSERT(size > 0, "ChunkedTilemap construction: Chunk size is <= 0!");
+}
+
+ChunkedTilemap::~ChunkedTilemap() { chunks.clear(); }
+
+auto ChunkedTilemap::chunk_key(const Tile &tile) const -> ChunkKey {
+    auto cx = static_cast<s32>(std::floor(tile.bounds.position.x / chunkSize));
+    auto cy = static_cast<s32>(std::floor(tile.bounds.position.y / chunkSize));
+    return (static_cast<ChunkKey>(static_cast<u32>(cx)) << 32) |
+           static_cast<u32>(cy);
+}
+
+auto ChunkedTilemap::insert_tile(size_t index) -> void {
+    auto key = chunk_key(tileMap[index]);
+    tileChunks[index] = key;
+
+    auto &chunk = chunks[key];
+    chunk.tiles.push_back(index);
+    chunk.dirty = true;
+}
+
+auto ChunkedTilemap::remove_tile(size_t index) -> void {
+    auto it = chunks.find(tileChunks[index]);
+    if (it == chunks.end())
+        return;
+
+    auto &tiles = it->second.tiles;
+    tiles.erase(std::find(tiles.begin(), tiles.end(), index));
+    it->second.dirty = true;
+
+    if (tiles.empty())
+        chunks.erase(it);
+}
+
+auto ChunkedTilemap::add_tile(Tile tile) -> void {
+    tileMap.push_back(tile);
+    tileChunks.push_back(0);
+    insert_tile(tileMap.size() - 1);
+}
+
+#if USE_EASTL
+auto ChunkedTilemap::add_tiles(eastl::vector<Tile> tiles) -> void {
+#else
+auto ChunkedTilemap::add_tiles(std::vector<Tile> tiles) -> void {
+#endif
+    SC_CORE_ASSERT(tiles.size() > 0,
+                   "ChunkedTilemap, tile array insertion is of size() <= 0");
+    for (auto &t : tiles)
+        add_tile(t);
+}
+
+auto ChunkedTilemap::set_tile(size_t index, Tile tile) -> void {
+    SC_CORE_ASSERT(index < tileMap.size(),
+                   "ChunkedTilemap: tile index out of range!");
+    tileMap[index] = tile;
+
+    if (chunk_key(tile) != tileChunks[index]) {
+        remove_tile(index);
+        insert_tile(index);
+    } else {
+        chunks[tileChunks[index]].dirty = true;
+    }
+}
+
+auto ChunkedTilemap::clear_tiles() -> void {
+    Tilemap::clear_tiles();
+    tileChunks.clear();
+    tileChunks.shrink_to_fit();
+    chunks.clear();
+    visibleChunks = 0;
+}
+
+auto ChunkedTilemap::build_chunk(Chunk &chunk) -> void {
+    auto count = chunk.tiles.size();
+    auto meshCount = (count + TILES_PER_MESH - 1) / TILES_PER_MESH;
+    while (chunk.meshes.size() < meshCount)
+        chunk.meshes.push_back(create_scopeptr<Rendering::Mesh<Rendering::Vertex>>(
+            Rendering::BUFFER_USAGE_DYNAMIC));
+    chunk.meshes.resize(meshCount);
+
+    for (size_t m = 0; m < meshCount; m++) {
+        auto &mesh = chunk.meshes[m];
+        auto tiles = std::min(TILES_PER_MESH, count - m * TILES_PER_MESH);
+        mesh->vertices.resize(tiles * 4);
+
+        if (mesh->indices.size() != tiles * 6) {
+            mesh->indices.resize(tiles * 6);
+            for (size_t i = 0; i < tiles; i++) {
+                auto v = static_cast<u16>(i * 4);
+                auto idx = &mesh->indices[i * 6];
+                idx[0] = v + 0;
+                idx[1] = v + 1;
+                idx[2] = v + 2;
+                idx[3] = v + 2;
+                idx[4] = v + 3;
+                idx[5] = v + 0;
+            }
+        }
+    }
+
+    // Bounds cover whole tiles, which may reach past the chunk's grid cell
+    chunk.min = mathfu::Vector<float, 3>(INFINITY, INFINITY, INFINITY);
+    chunk.max = mathfu::Vector<float, 3>(-INFINITY, -INFINITY, -INFINITY);
+
+    for (size_t i = 0; i < count; i++) {
+        auto &t = tileMap[chunk.tiles[i]];
+        auto &mesh = chunk.meshes[i / TILES_PER_MESH];
+        build_tile(t, &mesh->vertices[(i % TILES_PER_MESH) * 4]);
+
+        auto a = t.bounds.position;
+        auto b = t.bounds.position + t.bounds.extent;
+        chunk.min = mathfu::Vector<float, 3>(std::min({chunk.min.x, a.x, b.x}),
+                                             std::min({chunk.min.y, a.y, b.y}),
+                                             std::min(chunk.min.z, t.layer));
+        chunk.max = mathfu::Vector<float, 3>(std::max({chunk.max.x, a.x, b.x}),
+                                             std::max({chunk.max.y, a.y, b.y}),
+                                             std::max(chunk.max.z, t.layer));
+    }
+
+    for (auto &mesh : chunk.meshes)
+        mesh->setup_buffer();
+    chunk.dirty = false;
+}
+
+auto ChunkedTilemap::generate_map() -> void {
+    // Built chunks carry UVs from the old table
+    if (refresh_uv_table())
+        for (auto &c : chunks)
+            c.second.dirty = true;
+
+    bool built = false;
+    for (auto &c : chunks) {
+        if (c.second.dirty) {
+            build_chunk(c.second);
+            built = true;
+        }
+    }
+
+#if PSP
+    if (built)
+        sceKernelDcacheWritebackInvalidateAll();
+#else
+    UNUSED(built);
+#endif // PSP
+}
+
+auto ChunkedTilemap::draw() -> void {
+    generate_map();
+
+    auto frustum = Rendering::RenderContext::get().get_frustum();
+    Rendering::TextureManager::get().bind_texture(texture);
+
+    visibleChunks = 0;
+    for (auto &c : chunks) {
+        auto &chunk = c.second;
+        if (!frustum.intersects(chunk.min, chunk.max))
+            continue;
+
+        for (auto &mesh : chunk.meshes)
+            mesh->draw();
+        visibleChunks++;
+    }
+}
+
+} // namespace Stardust_Celeste::Graphics::G2D
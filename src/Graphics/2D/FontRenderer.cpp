@@ -2,6 +2,7 @@
 #include <Rendering/Texture.hpp>
 #include <cstdlib>
 #include <stb_image.hpp>
+#include <utility>
 
 namespace Stardust_Celeste::Graphics::G2D {
 
@@ -12,28 +13,44 @@ namespace Stardust_Celeste::Graphics::G2D {
         SC_CORE_ASSERT(atlasSize.x * atlasSize.y > 0,
                        "Tilemap construction: Atlas Size is <= 0!");
 
-        size_map = (float *)malloc(atlasSize.x * atlasSize.y * sizeof(float));
+        auto tex = Rendering::TextureManager::get().get_texture(texture);
+        measure_glyphs(0, 0, tex->width, tex->height);
+    }
+
+    FontRenderer::FontRenderer(const Rendering::AtlasRegion &region,
+                               mathfu::Vector<float, 2> atlasSize)
+            : Tilemap(region, atlasSize) {
+
+        SC_CORE_ASSERT(atlasSize.x * atlasSize.y > 0,
+                       "Tilemap construction: Atlas Size is <= 0!");
+
+        measure_glyphs(region.x, region.y, region.width, region.height);
+    }
+
+    auto FontRenderer::measure_glyphs(u32 x0, u32 y0, u32 width, u32 height) -> void {
+        size_map = (float *)malloc(atlasDimensions.x * atlasDimensions.y * sizeof(float));
         scale_factor = 1.0f;
 
-        for (int i = 0; i < atlasSize.x * atlasSize.y; i++)
+        for (int i = 0; i < atlasDimensions.x * atlasDimensions.y; i++)
             size_map[i] = 8;
 
         auto tex = Rendering::TextureManager::get().get_texture(texture);
+        SC_CORE_ASSERT(tex->pixData, "FontRenderer: texture was loaded without its pixels!");
         Rendering::Color *data = (Rendering::Color *)tex->pixData;
 
-        int w_per_char = tex->width / atlasSize.x;
-        int h_per_char = tex->height / atlasSize.y;
+        int w_per_char = width / atlasDimensions.x;
+        int h_per_char = height / atlasDimensions.y;
 
-        for (int i = 0; i < atlasSize.x * atlasSize.y; i++) {
-            int x = i % (int)atlasSize.x;
-            int y = i / atlasSize.x;
+        for (int i = 0; i < atlasDimensions.x * atlasDimensions.y; i++) {
+            int x = i % (int)atlasDimensions.x;
+            int y = i / atlasDimensions.x;
 
             auto len_cal = 1;
 
             for (int sx = x * w_per_char; sx < (x + 1) * w_per_char; sx++) {
                 bool hit = false;
                 for (int sy = y * h_per_char; sy < (y + 1) * h_per_char; sy++) {
-                    auto idx = sx + sy * tex->width;
+                    auto idx = (x0 + sx) + (y0 + sy) * tex->width;
                     if (data[idx].rgba.a != 0)
                         hit = true;
                 }
@@ -50,14 +67,14 @@ namespace Stardust_Celeste::Graphics::G2D {
 
     auto FontRenderer::add_text(std::string text, mathfu::Vector<float, 2> position,
                                 Rendering::Color color, float layer) -> void {
-        stringVector.push_back({text, position, color, layer});
+        stringVector.push_back({std::move(text), position, color, layer});
     }
 
     auto FontRenderer::clear_tiles() -> void {
         rebuildFlag = true;
-        oldStringVector = stringVector;
+        // Swap rather than copy, so both vectors keep their capacity between frames
+        std::swap(oldStringVector, stringVector);
         stringVector.clear();
-        stringVector.shrink_to_fit();
     }
 
     bool areVectorsEqual(const std::vector<TextData>& vec1, const std::vector<TextData>& vec2) {
@@ -86,6 +103,12 @@ namespace Stardust_Celeste::Graphics::G2D {
         return true;
     }
 
+    static bool areTilesEqual(const Tile& a, const Tile& b) {
+        return a.index == b.index && a.color.color == b.color.color && a.layer == b.layer &&
+               a.bounds.position.x == b.bounds.position.x && a.bounds.position.y == b.bounds.position.y &&
+               a.bounds.extent.x == b.bounds.extent.x && a.bounds.extent.y == b.bounds.extent.y;
+    }
+
     auto FontRenderer::generate_map() -> void {
         if(rebuildFlag) {
             rebuildFlag = false;
@@ -94,11 +117,15 @@ namespace Stardust_Celeste::Graphics::G2D {
             // If they are we don't need to generate again.
             if(areVectorsEqual(stringVector, oldStringVector)) {
                 return;
-            } else {
-                Tilemap::clear_tiles();
             }
         }
 
+        size_t count = 0;
+        for (auto &s : stringVector)
+            count += s.text.length();
+
+        glyphs.clear();
+        glyphs.reserve(count);
         for (auto &s : stringVector) {
             auto pos = s.pos;
             for (int i = 0; i < s.text.length(); i++) {
@@ -110,14 +137,24 @@ namespace Stardust_Celeste::Graphics::G2D {
                     c = 127;
                 }
 
-                add_tile({{pos, mathfu::Vector<float, 2>(8 * scale_factor, 8 * scale_factor)},
-                          s.color,
-                          static_cast<u16>(c),
-                          s.layer});
+                glyphs.push_back({{pos, mathfu::Vector<float, 2>(8 * scale_factor, 8 * scale_factor)},
+                                  s.color,
+                                  static_cast<u16>(c),
+                                  s.layer});
                 pos.x += size_map[c] * scale_factor;
             }
         }
 
+        // Same glyph count as the built mesh: only upload the glyphs that changed
+        if(glyphs.size() == tileMap.size() && meshTiles == tileMap.size()) {
+            for (size_t i = 0; i < glyphs.size(); i++) {
+                if(!areTilesEqual(glyphs[i], tileMap[i]))
+                    set_tile(i, glyphs[i]);
+            }
+            return;
+        }
+
+        tileMap.assign(glyphs.begin(), glyphs.end());
         Tilemap::generate_map();
     }
 
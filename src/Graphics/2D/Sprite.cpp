@@ -12,6 +12,7 @@ Sprite::Sprite(u32 tex, Rendering::Rectangle bnd) {
     color = Rendering::Color{255, 255, 255, 255};
 
     layer = 0;
+    sheet = 0;
     update_mesh();
 }
 
@@ -23,6 +24,7 @@ Sprite::Sprite(u32 tex, Rendering::Rectangle bnd, Rendering::Rectangle sel) {
     color = Rendering::Color{255, 255, 255, 255};
 
     layer = 0;
+    sheet = 0;
     update_mesh();
 }
 
@@ -36,6 +38,7 @@ Sprite::Sprite(u32 tex, Rendering::Rectangle bnd, Rendering::Rectangle sel,
     color = col;
 
     layer = 0;
+    sheet = 0;
     update_mesh();
 }
 Sprite::Sprite(u32 tex, Rendering::Rectangle bnd, Rendering::Color col) {
@@ -46,6 +49,18 @@ Sprite::Sprite(u32 tex, Rendering::Rectangle bnd, Rendering::Color col) {
     color = col;
 
     layer = 0;
+    sheet = 0;
+    update_mesh();
+}
+
+Sprite::Sprite(const Rendering::AtlasRegion &region, Rendering::Rectangle bnd,
+               Rendering::Color col)
+    : Sprite(region.texture, bnd, region.selection, col) {}
+
+Sprite::Sprite(const Rendering::TextureSheet &sh, Rendering::Rectangle bnd,
+               Rendering::Color col)
+    : Sprite(sh.texture, bnd, col) {
+    sheet = sh.sheet;
     update_mesh();
 }
 
@@ -90,28 +105,34 @@ auto Sprite::set_color(Rendering::Color col) -> void {
     update_mesh();
 }
 
-auto Sprite::update_mesh() -> void {
-    if (mesh.get() == nullptr)
-        mesh = create_scopeptr<Rendering::FixedMesh<Rendering::Vertex, 4, 6>>();
+auto Sprite::set_sheet(u16 sh) -> void {
+    sheet = sh;
+    update_mesh();
+}
+
+auto Sprite::build_quad(u32 texture, Rendering::Rectangle bounds,
+                        Rendering::Rectangle selection, Rendering::Color color,
+                        s16 layer, u16 sheet) -> std::array<Rendering::Vertex, 4> {
+    std::array<Rendering::Vertex, 4> quad;
 
-    mesh->vertices[0] = Rendering::Vertex{
+    quad[0] = Rendering::Vertex{
         selection.position.x, selection.position.y + selection.extent.y, color,
         bounds.position.x,    bounds.position.y,    (float)layer};
-    mesh->vertices[1] =
+    quad[1] =
         Rendering::Vertex{selection.position.x + selection.extent.x,
                           selection.position.y + selection.extent.y,
                           color,
                           bounds.position.x + bounds.extent.x,
                           bounds.position.y,
                           (float)layer};
-    mesh->vertices[2] =
+    quad[2] =
         Rendering::Vertex{selection.position.x + selection.extent.x,
                           selection.position.y ,
                           color,
                           bounds.position.x + bounds.extent.x,
                           bounds.position.y + bounds.extent.y,
                           (float)layer};
-    mesh->vertices[3] =
+    quad[3] =
         Rendering::Vertex{selection.position.x ,
                           selection.position.y ,
                           color,
@@ -131,11 +152,29 @@ auto Sprite::update_mesh() -> void {
     }
 
     for (int i = 0; i < 4; i++) {
-        mesh->vertices[i].u *= wRatio;
-        mesh->vertices[i].v *= hRatio;
+        quad[i].u *= wRatio;
+        quad[i].v *= hRatio;
     }
 #endif
 
+    for (auto &v : quad)
+        Rendering::set_sheet(v, sheet);
+
+    return quad;
+}
+
+auto Sprite::update_mesh() -> void {
+    upload_quad(build_quad(texture, bounds, selection, color, layer, sheet));
+}
+
+auto Sprite::upload_quad(const std::array<Rendering::Vertex, 4> &quad) -> void {
+    if (mesh.get() == nullptr)
+        mesh = create_scopeptr<Rendering::FixedMesh<Rendering::Vertex, 4, 6>>(
+            Rendering::BUFFER_USAGE_DYNAMIC);
+
+    for (int i = 0; i < 4; i++)
+        mesh->vertices[i] = quad[i];
+
     mesh->indices[0] = 0;
     mesh->indices[1] = 1;
     mesh->indices[2] = 2;
@@ -0,0 +1,145 @@
+#include <Graphics/2D/SpriteBatch.hpp>
+#include <Rendering/GI.hpp>
+#include <Rendering/Texture.hpp>
+#include <Utilities/Assertion.hpp>
+#include <algorithm>
+
+namespace Stardust_Celeste::Graphics::G2D {
+
+// 16-bit indices address at most 65536 vertices per page
+constexpr size_t QUADS_PER_PAGE = 65536 / 4;
+
+SpriteBatch::SpriteBatch() : dirty(false), drawCalls(0) {}
+
+SpriteBatch::~SpriteBatch() {
+    for (auto &p : pages)
+        p->delete_data();
+}
+
+auto SpriteBatch::add(const Sprite &sprite) -> void {
+    add_quad(sprite.texture, sprite.bounds, sprite.selection, sprite.color,
+             sprite.layer, sprite.sheet);
+}
+
+auto SpriteBatch::add(const AnimatedSprite &sprite) -> void {
+    if (!sprite.gpuAnimated) {
+        add(static_cast<const Sprite &>(sprite));
+        return;
+    }
+
+    SC_CORE_ASSERT(sprite.texture != 0, "SpriteBatch: Texture ID is 0!");
+
+    // Same vertices as the sprite's own mesh, stepped by the shader per run
+    auto quad = Sprite::build_quad(sprite.texture, sprite.bounds,
+                                   sprite.selection, sprite.color,
+                                   sprite.layer, sprite.sheet);
+    for (auto &v : quad)
+        Rendering::set_animation(v, static_cast<u16>(sprite.startIDX),
+                                 static_cast<u16>(sprite.frame_count()),
+                                 sprite.ticksPerSec);
+
+    Animation animation{static_cast<u32>(sprite.atlas.x), 1.0f / sprite.atlas.x,
+                        1.0f / sprite.atlas.y};
+    quads.push_back({sprite.texture, sprite.layer, quad, animation});
+    dirty = true;
+}
+
+auto SpriteBatch::add_quad(u32 texture, Rendering::Rectangle bounds,
+                           Rendering::Rectangle selection,
+                           Rendering::Color color, s16 layer, u16 sheet) -> void {
+    SC_CORE_ASSERT(texture != 0, "SpriteBatch: Texture ID is 0!");
+
+    quads.push_back(
+        {texture, layer,
+         Sprite::build_quad(texture, bounds, selection, color, layer, sheet)});
+    dirty = true;
+}
+
+auto SpriteBatch::clear() -> void {
+    quads.clear();
+    dirty = true;
+}
+
+auto SpriteBatch::build() -> void {
+    order.resize(quads.size());
+    for (size_t i = 0; i < order.size(); i++)
+        order[i] = i;
+
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        if (quads[a].layer != quads[b].layer)
+            return quads[a].layer < quads[b].layer;
+        return quads[a].texture < quads[b].texture;
+    });
+
+    auto pageCount = (quads.size() + QUADS_PER_PAGE - 1) / QUADS_PER_PAGE;
+    while (pages.size() < pageCount)
+        pages.push_back(create_scopeptr<Rendering::Mesh<Rendering::Vertex>>(
+            Rendering::BUFFER_USAGE_STREAM));
+
+    runs.clear();
+    for (size_t p = 0; p < pageCount; p++) {
+        auto &mesh = pages[p];
+        auto first = p * QUADS_PER_PAGE;
+        auto last = std::min(first + QUADS_PER_PAGE, quads.size());
+        auto count = last - first;
+
+        mesh->vertices.clear();
+        mesh->vertices.reserve(count * 4);
+
+        // Indices only depend on the quad count
+        if (mesh->indices.size() != count * 6) {
+            mesh->indices.resize(count * 6);
+            for (size_t i = 0; i < count; i++) {
+                auto v = static_cast<u16>(i * 4);
+                auto idx = &mesh->indices[i * 6];
+                idx[0] = v + 0;
+                idx[1] = v + 1;
+                idx[2] = v + 2;
+                idx[3] = v + 2;
+                idx[4] = v + 3;
+                idx[5] = v + 0;
+            }
+        }
+
+        for (size_t i = first; i < last; i++) {
+            auto &q = quads[order[i]];
+            mesh->vertices.insert(mesh->vertices.end(), q.vertices.begin(),
+                                  q.vertices.end());
+
+            auto local = i - first;
+            // Runs also split where the animation grid changes, plain quads
+            // are drawn without it
+            if (runs.empty() || runs.back().page != p ||
+                runs.back().texture != q.texture ||
+                !(runs.back().animation == q.animation)) {
+                runs.push_back({q.texture, p, local * 6, 0, q.animation});
+            }
+            runs.back().idx_count += 6;
+        }
+
+        mesh->setup_buffer();
+    }
+
+    dirty = false;
+}
+
+auto SpriteBatch::draw() -> void {
+    if (dirty)
+        build();
+
+    drawCalls = 0;
+    for (auto &r : runs) {
+        Rendering::TextureManager::get().bind_texture(r.texture);
+
+        auto &anim = r.animation;
+        if (anim.columns > 0)
+            GI::enable_atlas_animation(anim.columns, anim.frameWidth,
+                                       anim.frameHeight);
+        pages[r.page]->draw_range(r.idx_offset, r.idx_count);
+        if (anim.columns > 0)
+            GI::disable_atlas_animation();
+        drawCalls++;
+    }
+}
+
+} // namespace Stardust_Celeste::Graphics::G2D
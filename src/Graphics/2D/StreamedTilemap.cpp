@@ -0,0 +1,358 @@
+#include <Graphics/2D/StreamedTilemap.hpp>
+#include <Rendering/Texture.hpp>
+#include <Utilities/Assertion.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+
+namespace Stardust_Celeste::Graphics::G2D {
+
+StreamedTilemap::StreamedTilemap(std::string file, u32 tex,
+                                 mathfu::Vector<float, 2> atlasSize)
+    : Tilemap(tex, atlasSize), filename(std::move(file)), focus(0, 0),
+      visibleRadius(1), prefetchRadius(1) {
+    start_worker();
+}
+
+StreamedTilemap::StreamedTilemap(std::string file,
+                                 const Rendering::AtlasRegion &atlasRegion,
+                                 mathfu::Vector<float, 2> atlasSize)
+    : Tilemap(atlasRegion, atlasSize), filename(std::move(file)),
+      focus(0, 0), visibleRadius(1), prefetchRadius(1) {
+    start_worker();
+}
+
+StreamedTilemap::~StreamedTilemap() {
+    stop_worker();
+    chunks.clear();
+}
+
+auto StreamedTilemap::make_key(s32 x, s32 y) -> ChunkKey {
+    return (static_cast<ChunkKey>(static_cast<u32>(x)) << 32) |
+           static_cast<u32>(y);
+}
+
+auto StreamedTilemap::in_range(ChunkKey key, s32 cx, s32 cy, u32 radius) const
+    -> bool {
+    auto x = static_cast<s32>(static_cast<u32>(key >> 32));
+    auto y = static_cast<s32>(static_cast<u32>(key));
+    return static_cast<u32>(std::abs(x - cx)) <= radius &&
+           static_cast<u32>(std::abs(y - cy)) <= radius;
+}
+
+auto StreamedTilemap::set_radius(u32 visible, u32 prefetch) -> void {
+    visibleRadius = visible;
+    prefetchRadius = prefetch;
+}
+
+auto StreamedTilemap::write_file(const std::string &filename,
+                                 const std::vector<Tile> &tiles,
+                                 float chunkSize) -> bool {
+    SC_CORE_ASSERT(chunkSize > 0 && chunkSize <= 65535.0f,
+                   "StreamedTilemap: chunk size must be within 1 to 65535!");
+
+    // Ordered, so the file is laid out row by row
+    std::map<std::pair<s32, s32>, std::vector<TileRecord>> grouped;
+    for (auto &t : tiles) {
+        auto cx = static_cast<s32>(std::floor(t.bounds.position.x / chunkSize));
+        auto cy = static_cast<s32>(std::floor(t.bounds.position.y / chunkSize));
+
+        auto clamp16 = [](float v) {
+            return static_cast<u16>(std::min(std::max(std::round(v), 0.0f), 65535.0f));
+        };
+
+        TileRecord record;
+        record.x = clamp16(t.bounds.position.x - cx * chunkSize);
+        record.y = clamp16(t.bounds.position.y - cy * chunkSize);
+        record.w = clamp16(t.bounds.extent.x);
+        record.h = clamp16(t.bounds.extent.y);
+        record.index = t.index;
+        record.sheet = t.sheet;
+        record.color = t.color.color;
+        record.layer = t.layer;
+        grouped[{cy, cx}].push_back(record);
+    }
+
+    TilemapFileHeader header{};
+    memcpy(header.magic, TILEMAP_FILE_MAGIC, 4);
+    header.version = TILEMAP_FILE_VERSION;
+    header.chunkSize = chunkSize;
+    header.chunkCount = static_cast<u32>(grouped.size());
+
+    std::vector<TilemapChunkEntry> entries;
+    entries.reserve(grouped.size());
+    auto offset = static_cast<u32>(sizeof(header) + grouped.size() * sizeof(TilemapChunkEntry));
+    for (auto &g : grouped) {
+        entries.push_back({g.first.second, g.first.first, offset,
+                           static_cast<u32>(g.second.size())});
+        offset += static_cast<u32>(g.second.size() * sizeof(TileRecord));
+    }
+
+    auto file = fopen(filename.c_str(), "wb");
+    if (file == nullptr)
+        return false;
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              (entries.empty() ||
+               fwrite(entries.data(), sizeof(TilemapChunkEntry), entries.size(), file) == entries.size());
+    for (auto &g : grouped) {
+        if (!ok)
+            break;
+        ok = fwrite(g.second.data(), sizeof(TileRecord), g.second.size(), file) == g.second.size();
+    }
+
+    fclose(file);
+    return ok;
+}
+
+auto StreamedTilemap::start_worker() -> void {
+    stopping = false;
+    worker = std::thread(&StreamedTilemap::stream_worker, this);
+}
+
+auto StreamedTilemap::stop_worker() -> void {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    jobReady.notify_all();
+    resultTaken.notify_all();
+
+    if (worker.joinable())
+        worker.join();
+
+    jobs.clear();
+    built.clear();
+    requested.clear();
+}
+
+auto StreamedTilemap::build_chunk(FILE *file, const TilemapChunkEntry &entry,
+                                  BuiltChunk &out) const -> void {
+    size_t count = entry.count;
+    std::vector<TileRecord> records(count);
+
+    if (count == 0 || fseek(file, entry.offset, SEEK_SET) != 0 ||
+        fread(records.data(), sizeof(TileRecord), count, file) != count)
+        return;
+
+    auto originX = static_cast<float>(entry.x) * chunkSize;
+    auto originY = static_cast<float>(entry.y) * chunkSize;
+
+    // Split like Tilemap, so 16-bit indices cover chunks of any size
+    out.meshes.resize((count + TILES_PER_MESH - 1) / TILES_PER_MESH);
+    for (size_t m = 0; m < out.meshes.size(); m++) {
+        auto tiles = std::min(TILES_PER_MESH, count - m * TILES_PER_MESH);
+        out.meshes[m].vertices.resize(tiles * 4);
+        out.meshes[m].indices.resize(tiles * 6);
+    }
+
+    out.min = mathfu::Vector<float, 3>(INFINITY, INFINITY, INFINITY);
+    out.max = mathfu::Vector<float, 3>(-INFINITY, -INFINITY, -INFINITY);
+
+    for (size_t i = 0; i < count; i++) {
+        auto &r = records[i];
+
+        Tile t;
+        t.bounds.position = mathfu::Vector<float, 2>(originX + r.x, originY + r.y);
+        t.bounds.extent = mathfu::Vector<float, 2>(r.w, r.h);
+        t.color.color = r.color;
+        t.index = r.index;
+        t.layer = r.layer;
+        t.sheet = r.sheet;
+        auto &mesh = out.meshes[i / TILES_PER_MESH];
+        auto local = i % TILES_PER_MESH;
+        build_tile(t, &mesh.vertices[local * 4]);
+
+        auto v = static_cast<u16>(local * 4);
+        auto idx = &mesh.indices[local * 6];
+        idx[0] = v + 0;
+        idx[1] = v + 1;
+        idx[2] = v + 2;
+        idx[3] = v + 2;
+        idx[4] = v + 3;
+        idx[5] = v + 0;
+
+        auto pos = t.bounds.position;
+        auto end = t.bounds.position + t.bounds.extent;
+        out.min = mathfu::Vector<float, 3>(std::min(out.min.x, pos.x),
+                                           std::min(out.min.y, pos.y),
+                                           std::min(out.min.z, t.layer));
+        out.max = mathfu::Vector<float, 3>(std::max(out.max.x, end.x),
+                                           std::max(out.max.y, end.y),
+                                           std::max(out.max.z, t.layer));
+    }
+}
+
+auto StreamedTilemap::stream_worker() -> void {
+    std::unordered_map<ChunkKey, TilemapChunkEntry> index;
+    float size = 0.0f;
+
+    auto file = fopen(filename.c_str(), "rb");
+    TilemapFileHeader header;
+    if (file != nullptr && fread(&header, sizeof(header), 1, file) == 1 &&
+        memcmp(header.magic, TILEMAP_FILE_MAGIC, 4) == 0 &&
+        header.version == TILEMAP_FILE_VERSION && header.chunkSize > 0) {
+        std::vector<TilemapChunkEntry> entries(header.chunkCount);
+        if (entries.empty() ||
+            fread(entries.data(), sizeof(TilemapChunkEntry), entries.size(), file) == entries.size()) {
+            for (auto &e : entries)
+                index.emplace(make_key(e.x, e.y), e);
+            size = header.chunkSize;
+        }
+    }
+
+    if (size == 0.0f)
+        SC_CORE_ERROR("Could not read tilemap file {}", filename);
+
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        chunkSize = size;
+        indexReady = true;
+    }
+
+    while (size > 0.0f) {
+        ChunkKey key;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            jobReady.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (stopping)
+                break;
+
+            key = jobs.front();
+            jobs.pop_front();
+        }
+
+        // Chunks missing from the file come back empty, so they count as loaded
+        BuiltChunk chunk;
+        chunk.key = key;
+        auto it = index.find(key);
+        if (it != index.end())
+            build_chunk(file, it->second, chunk);
+
+        // Bounded, so reading can't run arbitrarily far ahead of uploads
+        std::unique_lock<std::mutex> lock(queueMutex);
+        resultTaken.wait(lock, [this] {
+            return stopping || built.size() < MAX_BUILT_CHUNKS;
+        });
+        if (stopping)
+            break;
+        built.push_back(std::move(chunk));
+    }
+
+    if (file != nullptr)
+        fclose(file);
+}
+
+auto StreamedTilemap::update(double dt) -> void {
+    UNUSED(dt);
+
+    if (!ready) {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        ready = indexReady;
+    }
+    if (!ready || chunkSize <= 0.0f)
+        return;
+
+    auto cx = static_cast<s32>(std::floor(focus.x / chunkSize));
+    auto cy = static_cast<s32>(std::floor(focus.y / chunkSize));
+    auto loadRadius = visibleRadius + prefetchRadius;
+    // One chunk of slack, so moving along a border doesn't reload chunks
+    auto keepRadius = loadRadius + 1;
+
+    for (auto it = chunks.begin(); it != chunks.end();) {
+        if (!in_range(it->first, cx, cy, keepRadius))
+            it = chunks.erase(it);
+        else
+            ++it;
+    }
+
+    // Nearest first, so the visible chunks arrive before the prefetched ones
+    std::vector<ChunkKey> wanted;
+    for (s32 r = 0; r <= static_cast<s32>(loadRadius); r++) {
+        for (s32 y = cy - r; y <= cy + r; y++) {
+            for (s32 x = cx - r; x <= cx + r; x++) {
+                if (std::abs(x - cx) != r && std::abs(y - cy) != r)
+                    continue;
+
+                auto key = make_key(x, y);
+                if (chunks.find(key) == chunks.end() && requested.insert(key).second)
+                    wanted.push_back(key);
+            }
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+
+        // Queued chunks the focus has moved away from are not read at all
+        for (auto it = jobs.begin(); it != jobs.end();) {
+            if (!in_range(*it, cx, cy, keepRadius)) {
+                requested.erase(*it);
+                it = jobs.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        jobs.insert(jobs.end(), wanted.begin(), wanted.end());
+    }
+    if (!wanted.empty())
+        jobReady.notify_one();
+
+    for (size_t i = 0; i < UPLOADS_PER_UPDATE; i++) {
+        BuiltChunk result;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            if (built.empty())
+                break;
+
+            result = std::move(built.front());
+            built.pop_front();
+        }
+        resultTaken.notify_one();
+
+        // Dropped while the worker was reading it
+        if (requested.erase(result.key) == 0 ||
+            !in_range(result.key, cx, cy, keepRadius))
+            continue;
+
+        auto &chunk = chunks[result.key];
+        if (result.meshes.empty())
+            continue;
+
+        for (auto &built : result.meshes) {
+            auto mesh = create_scopeptr<Rendering::Mesh<Rendering::Vertex>>(
+                Rendering::BUFFER_USAGE_STATIC);
+            mesh->vertices = std::move(built.vertices);
+            mesh->indices = std::move(built.indices);
+            mesh->setup_buffer();
+            chunk.meshes.push_back(std::move(mesh));
+        }
+        chunk.min = result.min;
+        chunk.max = result.max;
+
+#if PSP
+        sceKernelDcacheWritebackInvalidateAll();
+#endif // PSP
+    }
+}
+
+auto StreamedTilemap::draw() -> void {
+    if (!meshes.empty())
+        Tilemap::draw();
+
+    auto frustum = Rendering::RenderContext::get().get_frustum();
+    Rendering::TextureManager::get().bind_texture(texture);
+
+    for (auto &c : chunks) {
+        auto &chunk = c.second;
+        if (chunk.meshes.empty() || !frustum.intersects(chunk.min, chunk.max))
+            continue;
+
+        for (auto &m : chunk.meshes)
+            m->draw();
+    }
+}
+
+} // namespace Stardust_Celeste::Graphics::G2D
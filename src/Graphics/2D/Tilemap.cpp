@@ -1,6 +1,7 @@
 #include <Graphics/2D/Tilemap.hpp>
 #include <Rendering/Texture.hpp>
 #include <Utilities/Assertion.hpp>
+#include <algorithm>
 
 namespace Stardust_Celeste::Graphics::G2D {
 
@@ -10,11 +11,21 @@ Tilemap::Tilemap(u32 tex, mathfu::Vector<float, 2> atlasSize) {
                    "Tilemap construction: Atlas Size is <= 0!");
     texture = tex;
     atlasDimensions = atlasSize;
-    mesh = create_scopeptr<Rendering::Mesh<Rendering::Vertex>>();
+    region = Rendering::Rectangle{{0, 0}, {1, 1}};
+    meshTiles = 0;
+    maxThreads = 0;
+    build_uv_table();
+}
+
+Tilemap::Tilemap(const Rendering::AtlasRegion &atlasRegion,
+                 mathfu::Vector<float, 2> atlasSize)
+    : Tilemap(atlasRegion.texture, atlasSize) {
+    region = atlasRegion.selection;
+    build_uv_table();
 }
 
 Tilemap::~Tilemap() {
-    mesh->delete_data();
+    meshes.clear();
     tileMap.clear();
 }
 
@@ -33,7 +44,8 @@ auto Tilemap::add_tiles(std::vector<Tile> tiles) -> void {
 auto Tilemap::clear_tiles() -> void {
     tileMap.clear();
     tileMap.shrink_to_fit();
-    mesh->clear_data();
+    meshes.clear();
+    meshTiles = 0;
 }
 
 auto Tilemap::update(double dt) -> void {
@@ -42,61 +54,146 @@ auto Tilemap::update(double dt) -> void {
 
 auto Tilemap::draw() -> void {
     Rendering::TextureManager::get().bind_texture(texture);
-    if (mesh != nullptr)
-        mesh->draw();
+    for (auto &m : meshes) {
+        m->update_buffer();
+        m->draw();
+    }
 }
 
-auto Tilemap::generate_map() -> void {
-    mesh->delete_data();
+auto Tilemap::set_tile(size_t index, Tile tile) -> void {
+    SC_CORE_ASSERT(index < tileMap.size(), "Tilemap: tile index out of range!");
+    tileMap[index] = tile;
 
-    auto idxc = 0;
+    // Not generated yet, generate_map picks the tile up
+    if (index >= meshTiles)
+        return;
 
-    for (auto &t : tileMap) {
-        auto x = t.bounds.position.x;
-        auto y = t.bounds.position.y;
-        auto w = t.bounds.extent.x;
-        auto h = t.bounds.extent.y;
+    build_tile(tile, tile_vertices(index));
+    mark_tile_dirty(index);
+}
 
-        auto uvs = Rendering::Texture::get_tile_uvs(atlasDimensions, t.index);
+auto Tilemap::resize_meshes(size_t count) -> void {
+    auto meshCount = (count + TILES_PER_MESH - 1) / TILES_PER_MESH;
+    while (meshes.size() < meshCount)
+        meshes.push_back(create_scopeptr<Rendering::Mesh<Rendering::Vertex>>(
+            Rendering::BUFFER_USAGE_DYNAMIC));
+    meshes.resize(meshCount);
+
+    for (size_t m = 0; m < meshCount; m++) {
+        auto &mesh = meshes[m];
+        auto tiles = std::min(TILES_PER_MESH, count - m * TILES_PER_MESH);
+
+        // Keep the GPU buffer and vector capacity, only the contents change
+        mesh->vertices.resize(tiles * 4);
+
+        // Indices only depend on the tile count
+        if (mesh->indices.size() != tiles * 6) {
+            mesh->indices.resize(tiles * 6);
+            for (size_t i = 0; i < tiles; i++) {
+                auto v = static_cast<u16>(i * 4);
+                auto idx = &mesh->indices[i * 6];
+                idx[0] = v + 0;
+                idx[1] = v + 1;
+                idx[2] = v + 2;
+                idx[3] = v + 2;
+                idx[4] = v + 3;
+                idx[5] = v + 0;
+            }
+        }
+    }
+
+    meshTiles = count;
+}
+
+auto Tilemap::upload_meshes() -> void {
+    for (auto &m : meshes)
+        m->setup_buffer();
 
 #if PSP
-        auto tInfo = Rendering::TextureManager::get().get_texture(texture);
+    sceKernelDcacheWritebackInvalidateAll();
+#endif // PSP
+}
 
-        float wRatio = 1.0f;
-        float hRatio = 1.0f;
+auto Tilemap::tile_vertices(size_t index) const -> Rendering::Vertex * {
+    return &meshes[index / TILES_PER_MESH]->vertices[(index % TILES_PER_MESH) * 4];
+}
 
-        if (tInfo != nullptr) {
-            wRatio = (float)tInfo->width / (float)tInfo->pW;
-            hRatio = (float)tInfo->height / (float)tInfo->pH;
-        }
+auto Tilemap::mark_tile_dirty(size_t index) -> void {
+    meshes[index / TILES_PER_MESH]->mark_vertices_dirty(
+        (index % TILES_PER_MESH) * 4, 4);
+}
 
-        for (int i = 0; i < 4; i++) {
-            uvs[i * 2 + 0] *= wRatio;
-            uvs[i * 2 + 1] *= hRatio;
-        }
+auto Tilemap::texture_uv_scale() const -> mathfu::Vector<float, 2> {
+#if PSP
+    auto tInfo = Rendering::TextureManager::get().get_texture(texture);
+
+    if (tInfo != nullptr)
+        return mathfu::Vector<float, 2>((float)tInfo->width / (float)tInfo->pW,
+                                        (float)tInfo->height / (float)tInfo->pH);
 #endif
+    return mathfu::Vector<float, 2>(1.0f, 1.0f);
+}
 
-        mesh->vertices.push_back(
-            Rendering::Vertex{uvs[0], uvs[1], t.color, x, y, t.layer});
-        mesh->vertices.push_back(
-            Rendering::Vertex{uvs[2], uvs[3], t.color, x + w, y, t.layer});
-        mesh->vertices.push_back(
-            Rendering::Vertex{uvs[4], uvs[5], t.color, x + w, y + h, t.layer});
-        mesh->vertices.push_back(
-            Rendering::Vertex{uvs[6], uvs[7], t.color, x, y + h, t.layer});
-
-        mesh->indices.insert(mesh->indices.end(),
-                             {(u16)(idxc + 0), (u16)(idxc + 1), (u16)(idxc + 2),
-                              (u16)(idxc + 2), (u16)(idxc + 3),
-                              (u16)(idxc + 0)});
-        idxc += 4;
+auto Tilemap::build_uv_table() -> void {
+    auto uvScale = texture_uv_scale();
+    uvTableScale = uvScale;
+    auto count = static_cast<size_t>(atlasDimensions.x * atlasDimensions.y);
+
+    atlasUVs.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        auto uvs = Rendering::Texture::get_tile_uvs(atlasDimensions, static_cast<int>(i));
+        // get_tile_uvs gives {x, h, w, h, w, y, x, y}
+        atlasUVs[i] = {(region.position.x + uvs[0] * region.extent.x) * uvScale.x,
+                       (region.position.y + uvs[5] * region.extent.y) * uvScale.y,
+                       (region.position.x + uvs[2] * region.extent.x) * uvScale.x,
+                       (region.position.y + uvs[1] * region.extent.y) * uvScale.y};
     }
+}
 
-    mesh->setup_buffer();
-
+auto Tilemap::refresh_uv_table() -> bool {
 #if PSP
-    sceKernelDcacheWritebackInvalidateAll();
-#endif // PSP
+    auto uvScale = texture_uv_scale();
+    if (uvScale.x != uvTableScale.x || uvScale.y != uvTableScale.y) {
+        build_uv_table();
+        return true;
+    }
+#endif
+    return false;
+}
+
+auto Tilemap::build_tile(const Tile &t, Rendering::Vertex *out) const -> void {
+    auto x = t.bounds.position.x;
+    auto y = t.bounds.position.y;
+    auto w = t.bounds.extent.x;
+    auto h = t.bounds.extent.y;
+
+    // Indices past the atlas keep wrapping into further rows as before
+    std::array<float, 4> uv;
+    if (t.index < atlasUVs.size()) {
+        uv = atlasUVs[t.index];
+    } else {
+        auto uvs = Rendering::Texture::get_tile_uvs(atlasDimensions, t.index);
+        auto uvScale = texture_uv_scale();
+        uv = {(region.position.x + uvs[0] * region.extent.x) * uvScale.x,
+              (region.position.y + uvs[5] * region.extent.y) * uvScale.y,
+              (region.position.x + uvs[2] * region.extent.x) * uvScale.x,
+              (region.position.y + uvs[1] * region.extent.y) * uvScale.y};
+    }
+
+    out[0] = Rendering::Vertex{uv[0], uv[3], t.color, x, y, t.layer};
+    out[1] = Rendering::Vertex{uv[2], uv[3], t.color, x + w, y, t.layer};
+    out[2] = Rendering::Vertex{uv[2], uv[1], t.color, x + w, y + h, t.layer};
+    out[3] = Rendering::Vertex{uv[0], uv[1], t.color, x, y + h, t.layer};
+
+    for (int i = 0; i < 4; i++)
+        Rendering::set_sheet(out[i], t.sheet);
+}
+
+auto Tilemap::generate_map() -> void {
+    refresh_uv_table();
+    resize_meshes(tileMap.size());
+    build_tiles(tileMap.data(), tileMap.size());
+    upload_meshes();
 }
 
-} // namespace Stardust_Celeste::Graphics::G2D
\ No newline at end of file
+} // namespace Stardust_Celeste::Graphics::G2D
@@ -7,6 +7,7 @@
 
 #define BUILD_PC (BUILD_PLAT == BUILD_WINDOWS || BUILD_PLAT == BUILD_POSIX)
 #include <Rendering/GI.hpp>
+#include <Rendering/GI/GL/GLStateCache.hpp>
 
 #if BUILD_PC
 #define GLFW_INCLUDE_NONE
@@ -14,6 +15,13 @@
 #include "glad/glad.hpp"
 
 #include <Rendering/GI/GL/GLTextureHandle.hpp>
+#include <Rendering/GI/GL/GLPixelTransfer.hpp>
+#include <Rendering/GI/GL/GLProgramCache.hpp>
+#include <Rendering/GI/GL/GLShaderVariants.hpp>
+#include <Rendering/GI/ShaderCache.hpp>
+#include <chrono>
+#include <cmath>
+#include <Rendering/GI/GL/GLRingBuffer.hpp>
 #include <Rendering/GI/VK/VkTextureHandle.hpp>
 #include "Core/Application.hpp"
 #include "Rendering/GI/GL/GLBufferObject.hpp"
@@ -34,12 +42,34 @@
 #endif
 
 #if BUILD_PC
+// Specialized per feature set by GLShaderVariants, which defines TEXTURED,
+// TEXTURE_ARRAY, SIMPLE_VERTEX, FOG, SRGB_COLORS and ANIMATED after the
+// #version line
 const std::string vert_source = R"(
     #version 400
     layout (location = 0) in vec3 aPos;
     layout (location = 1) in vec4 aCol;
     layout (location = 2) in vec2 aTex;
 
+    // Per-instance attributes, constant identity values when not instancing
+    layout (location = 3) in vec4 iTransform;
+    layout (location = 4) in vec3 iOffset;
+    layout (location = 5) in vec4 iColor;
+    layout (location = 6) in vec4 iUV;
+
+    // Texture array layer, 0 for vertices without one
+    layout (location = 7) in float aSheet;
+
+    #ifdef ANIMATED
+    // First frame, frame count, frames per second * 16, phase
+    layout (location = 8) in uvec4 aAnim;
+    // Seconds since the last wrap, and wraps so far -- see ANIMATION_TIME_WRAP
+    uniform float time;
+    uniform int timeWraps;
+    // Atlas columns, then the size of a frame in texture coordinates
+    uniform vec3 animAtlas;
+    #endif
+
     layout (std140) uniform Matrices {
         uniform mat4 proj;
         uniform mat4 view;
@@ -49,19 +79,42 @@ const std::string vert_source = R"(
     out vec2 uv;
     out vec4 color;
     out vec3 position;
-    uniform int simple;
+    flat out float sheet;
 
     void main() {
         vec3 aPos2 = aPos;
         vec2 aTex2 = aTex;
 
-        color = aCol;
-        if(simple == 1) {
-            aPos2 *= 2.0f;
-            aTex2 *= 2.0f;
+        color = aCol * iColor;
+
+    #ifdef SIMPLE_VERTEX
+        aPos2 *= 2.0f;
+        aTex2 *= 2.0f;
+    #endif
+
+    #ifdef ANIMATED
+        if(aAnim.y > 1u) {
+            // Each wrap is 4096 / 16 * rate steps, counted modulo the frames
+            // so the cycle carries on across it without overflowing
+            uint frames = aAnim.y;
+            uint wrapSteps = (uint(timeWraps) % frames) * ((256u * aAnim.z) % frames);
+            uint step = uint(time * float(aAnim.z) / 16.0f) % frames;
+            uint frame = aAnim.x + (aAnim.w + wrapSteps + step) % frames;
+            uint columns = max(uint(animAtlas.x), 1u);
+
+            // Offset from the frame the UVs were built for
+            ivec2 cell = ivec2(frame % columns, frame / columns) -
+                         ivec2(aAnim.x % columns, aAnim.x / columns);
+            aTex2 += vec2(cell) * animAtlas.yz;
         }
+    #endif
+
+        aPos2.xy = vec2(iTransform.x * aPos2.x + iTransform.y * aPos2.y,
+                        iTransform.z * aPos2.x + iTransform.w * aPos2.y) + iOffset.xy;
+        aPos2.z += iOffset.z;
 
-        uv = aTex2;
+        uv = aTex2 * iUV.zw + iUV.xy;
+        sheet = aSheet;
         gl_Position = proj * view * model * vec4(aPos2, 1.0);
         position = gl_Position.xyz;
     }
@@ -69,43 +122,52 @@ const std::string vert_source = R"(
 
 const std::string frag_source = R"(
     #version 400
+    #ifdef TEXTURED
+    #ifdef TEXTURE_ARRAY
+    uniform sampler2DArray sheets;
+    #else
     uniform sampler2D tex;
-    uniform int noTex;
+    #endif
     uniform float scroll;
-    uniform int fog;
+    #endif
 
+    #ifdef FOG
     uniform vec4 fogColor;
+    #endif
 
     in vec2 uv;
     in vec4 color;
     in vec3 position;
+    flat in float sheet;
 
     out vec4 FragColor;
 
-    float Convert_sRGB_ToLinear (float thesRGBValue) {
-        return thesRGBValue <= 0.04045f
-                ? thesRGBValue / 12.92f
-                : pow ((thesRGBValue + 0.055f) / 1.055f, 2.4f);
-    }
-
     void main() {
-        vec4 texColor = texture(tex, vec2(uv.x + scroll, uv.y));
-
-        vec4 color1 = vec4(Convert_sRGB_ToLinear(color.r), Convert_sRGB_ToLinear(color.g), Convert_sRGB_ToLinear(color.b), color.a);
-        if(noTex == 0) {
-            texColor *= color1;
-        } else if(noTex == 1) {
-            texColor = color1;
-        }
-
-        if(fog == 1) {
-            float dist = abs(position.z);
-            const float fogMax = (192.0f * 0.8);
-            const float fogMin = (192.0f * 0.2);
-            float fogFactor = (fogMax - dist) / (fogMax - fogMin);
-            fogFactor = clamp(fogFactor, 0.0f, 1.0f);
-            texColor = vec4(mix(fogColor.rgb, texColor.rgb, fogFactor), texColor.a);
-        }
+        vec4 tint = color;
+    #ifdef SRGB_COLORS
+        // Per fragment, so gradients interpolate in sRGB as they always have
+        tint.rgb = mix(tint.rgb / 12.92, pow((tint.rgb + 0.055) / 1.055, vec3(2.4)),
+                       step(vec3(0.04045), tint.rgb));
+    #endif
+
+    #ifdef TEXTURED
+    #ifdef TEXTURE_ARRAY
+        vec4 texColor = texture(sheets, vec3(uv.x + scroll, uv.y, sheet)) * tint;
+    #else
+        vec4 texColor = texture(tex, vec2(uv.x + scroll, uv.y)) * tint;
+    #endif
+    #else
+        vec4 texColor = tint;
+    #endif
+
+    #ifdef FOG
+        float dist = abs(position.z);
+        const float fogMax = (192.0f * 0.8);
+        const float fogMin = (192.0f * 0.2);
+        float fogFactor = (fogMax - dist) / (fogMax - fogMin);
+        fogFactor = clamp(fogFactor, 0.0f, 1.0f);
+        texColor = vec4(mix(fogColor.rgb, texColor.rgb, fogFactor), texColor.a);
+    #endif
 
         FragColor = texColor;
 
@@ -152,14 +214,26 @@ float4 main(float2 vTexcoord : TEXCOORD0, float4 vColor : COLOR0, uniform sample
 
 namespace GI {
     RenderContextSettings rctxSettings;
+    FrameStats frameStats, lastFrameStats;
+    // Frames ended so far, stream buffers advance their rings once per frame
+    u64 frameCount = 0;
 
     Rendering::Color fogcol;
 #if BUILD_PC
     GLFWwindow *window;
     GLuint programID;
-    GLuint ubo;
     u32 projLoc, viewLoc, modLoc;
-    u32 noTex, scroll;
+
+    // Per-draw uniform blocks are appended here and bound by range
+    constexpr size_t UBO_RING_REGION_SIZE = 1 << 20;
+    ScopePtr<detail::GLRingBuffer> uboRing;
+
+    // Period of the shader's animation time, the vertex shader assumes 4096
+    constexpr double ANIMATION_TIME_WRAP = 4096.0;
+    GLint uboAlignment = 256;
+    // Ring serial of the bound block, stale once the ring moves on
+    u64 uboBoundSerial = 0;
+    bool uboBound = false;
 
     namespace detail {
         extern GLFWwindow* window;
@@ -173,6 +247,7 @@ namespace GI {
     unsigned int __attribute__((aligned(16))) list[0x10000];
 #elif BUILD_PLAT == BUILD_VITA
     GLuint programID;
+    u32 noTex, scroll;
 #endif
 
 
@@ -207,6 +282,8 @@ namespace GI {
         glBindAttribLocation(prog, 0, "position");
         glBindAttribLocation(prog, 1, "color");
         glBindAttribLocation(prog, 2, "uv");
+#else
+        detail::GLProgramCache::get().prepare(prog);
 #endif
 
         glLinkProgram(prog);
@@ -232,6 +309,16 @@ namespace GI {
     }
 
     auto loadShaders(const std::string& vs, const std::string& fs) -> GLuint {
+#if BUILD_PC
+        auto &programCache = detail::GLProgramCache::get();
+        auto cached = programCache.load(vs, fs);
+        if (cached != 0) {
+            detail::GLStateCache::get().use_program(cached);
+            return cached;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+#endif
         GLuint vertShader, fragShader;
 
         vertShader = compileShader(vs.c_str(), GL_VERTEX_SHADER);
@@ -242,7 +329,13 @@ namespace GI {
         glDeleteShader(vertShader);
         glDeleteShader(fragShader);
 
-        glUseProgram(pID);
+#if BUILD_PC
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count();
+        programCache.store(vs, fs, pID, static_cast<u32>(elapsed));
+#endif
+
+        detail::GLStateCache::get().use_program(pID);
 
         return pID;
     }
@@ -252,6 +345,8 @@ namespace GI {
         rctxSettings = app;
 
 #if BUILD_PC
+        detail::ShaderCache::get().set_directory(app.shaderCachePath);
+
         if(rctxSettings.renderingApi == Vulkan) {
 #ifndef NO_EXPERIMENTAL_GRAPHICS
             detail::VKContext::get().init(app);
@@ -312,22 +407,32 @@ namespace GI {
         // Extended setup: Vita / Desktop Shaders
 #if BUILD_PC || BUILD_PLAT == BUILD_VITA
         if(rctxSettings.renderingApi == OpenGL || rctxSettings.renderingApi == DefaultAPI) {
+#if BUILD_PC
+            // Variants are compiled on first use, this builds the default one
+            auto &variants = detail::GLShaderVariants::get();
+            variants.init(vert_source, frag_source);
+            GI::programID = variants.apply();
+#else
             GI::programID = loadShaders(vert_source, frag_source);
-            glUseProgram(GI::programID);
+            detail::GLStateCache::get().use_program(GI::programID);
 
             noTex = glGetUniformLocation(GI::programID, "noTex");
             scroll = glGetUniformLocation(GI::programID, "scroll");
+#endif
 
 #if BUILD_PLAT != BUILD_VITA
-            GLuint ubi = glGetUniformBlockIndex(GI::programID, "Matrices");
-            glUniformBlockBinding(GI::programID, ubi, 0);
-            glGenBuffers(1, &ubo);
-            glBindBuffer(GL_UNIFORM_BUFFER, ubo);
-            glBufferData(GL_UNIFORM_BUFFER, 3 * sizeof(mathfu::Matrix<float, 4>), NULL,
-                         GL_STATIC_DRAW);
-            glBindBuffer(GL_UNIFORM_BUFFER, 0);
-            glBindBufferRange(GL_UNIFORM_BUFFER, 0, ubo, 0, 3 * sizeof(mathfu::Matrix<float, 4>));
-            glBindBuffer(GL_UNIFORM_BUFFER, GI::programID);
+            glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uboAlignment);
+            uboRing = create_scopeptr<detail::GLRingBuffer>(GL_UNIFORM_BUFFER, UBO_RING_REGION_SIZE);
+            uboBound = false;
+
+            // Disabled instance arrays read these, giving an identity instance
+            glVertexAttrib4f(3, 1.0f, 0.0f, 0.0f, 1.0f);
+            glVertexAttrib3f(4, 0.0f, 0.0f, 0.0f);
+            glVertexAttrib4f(5, 1.0f, 1.0f, 1.0f, 1.0f);
+            glVertexAttrib4f(6, 0.0f, 0.0f, 1.0f, 1.0f);
+            glVertexAttrib1f(7, 0.0f);
+            glVertexAttribI4ui(8, 0, 0, 0, 0);
+
             glEnable(GL_FRAMEBUFFER_SRGB);
 #else
             projLoc = glGetUniformLocation(GI::programID, "proj");
@@ -339,6 +444,10 @@ namespace GI {
     }
     auto terminate() -> void {
 #if BUILD_PC
+        uboRing.reset();
+        detail::GLPixelTransfer::get().release();
+        detail::GLShaderVariants::get().release();
+
         if(rctxSettings.renderingApi == Vulkan) {
 #ifndef NO_EXPERIMENTAL_GRAPHICS
             detail::VKPipeline::get().deinit();
@@ -372,24 +481,29 @@ namespace GI {
 #endif
             }
         } else if(rctxSettings.renderingApi == OpenGL || rctxSettings.renderingApi == DefaultAPI) {
+            auto &cache = detail::GLStateCache::get();
 #if BUILD_PC
+            auto &variants = detail::GLShaderVariants::get();
             if(state == GI_FOG) {
-                glUniform1i(glGetUniformLocation(GI::programID, "fog"), 1);
-                glUniform4f(glGetUniformLocation(GI::programID, "fogColor"), (float)fogcol.rgba.r / 255.0f,
-                            (float)fogcol.rgba.g / 255.0f, (float)fogcol.rgba.b / 255.0f, (float)fogcol.rgba.a / 255.0f);
+                variants.set_feature(detail::SHADER_FOG, true);
+                variants.set_fog_color((float)fogcol.rgba.r / 255.0f, (float)fogcol.rgba.g / 255.0f,
+                                       (float)fogcol.rgba.b / 255.0f, (float)fogcol.rgba.a / 255.0f);
             }
 
             if (state == GI_TEXTURE_2D) {
-                glUniform1i(noTex, 0);
+                variants.set_feature(detail::SHADER_TEXTURED, true);
             }
+
+            // Fog and texturing select a shader variant in the core profile
+            if (state == GI_FOG || state == GI_TEXTURE_2D)
+                return;
 #elif BUILD_PLAT == BUILD_PSP
             if(state == GI_FOG) {
-                glEnable(GL_FOG);
                 auto renderDistance = 3.707f * 16.0f;
                 sceGuFog(0.2f * renderDistance, 0.8f * renderDistance, fogcol.color);
             }
 #endif
-            glEnable(state);
+            cache.enable(state);
         }
     }
     auto disable(u32 state) -> void {
@@ -400,17 +514,26 @@ namespace GI {
 #endif
             }
         } else if(rctxSettings.renderingApi == OpenGL || rctxSettings.renderingApi == DefaultAPI) {
+            auto &cache = detail::GLStateCache::get();
 #ifndef PSP
             if (state == GI_TEXTURE_2D) {
-                glBindTexture(GL_TEXTURE_2D, 0);
-                glUniform1i(noTex, 1);
+                cache.bind_texture(0);
+            }
+#endif
+#if BUILD_PC
+            auto &variants = detail::GLShaderVariants::get();
+            if (state == GI_TEXTURE_2D) {
+                variants.set_feature(detail::SHADER_TEXTURED, false);
             }
 
             if(state == GI_FOG) {
-                glUniform1i(glGetUniformLocation(GI::programID, "fog"), 0);
+                variants.set_feature(detail::SHADER_FOG, false);
             }
+
+            if (state == GI_FOG || state == GI_TEXTURE_2D)
+                return;
 #endif
-            glDisable(state);
+            cache.disable(state);
         }
     }
 
@@ -432,9 +555,9 @@ namespace GI {
 #endif
         } else if(rctxSettings.renderingApi == OpenGL || rctxSettings.renderingApi == DefaultAPI) {
             if (enabled) {
-                glEnable(GL_CULL_FACE);
+                detail::GLStateCache::get().enable(GL_CULL_FACE);
             } else {
-                glDisable(GL_CULL_FACE);
+                detail::GLStateCache::get().disable(GL_CULL_FACE);
             }
 #ifndef PSP
             glCullFace(GL_BACK);
@@ -445,7 +568,7 @@ namespace GI {
 
     auto depth_func(u32 mode) -> void {
         if (rctxSettings.renderingApi == OpenGL || rctxSettings.renderingApi == DefaultAPI) {
-            glDepthFunc(mode);
+            detail::GLStateCache::get().depth_func(mode);
         }
     }
 
@@ -508,11 +631,7 @@ namespace GI {
             fn(detail::VKPipeline::get().commandBuffer, 0, 1, &blendEquationExt);
 #endif
         } else if(rctxSettings.renderingApi == OpenGL || rctxSettings.renderingApi == DefaultAPI) {
-#ifndef PSP
-            glBlendFunc(src, dest);
-#else
-            glBlendFunc(GU_ADD, src, dest, 0, 0);
-#endif
+            detail::GLStateCache::get().blend_func(src, dest);
         }
     }
 
@@ -534,6 +653,14 @@ namespace GI {
         } else {
 #if BUILD_PLAT == BUILD_PSP
             guglStartFrame(list, dialog);
+#elif BUILD_PC
+            // Wrapped so the float keeps sub-frame precision, the shader adds
+            // the wraps back in so animations keep their phase
+            auto now = glfwGetTime();
+            auto wraps = std::floor(now / ANIMATION_TIME_WRAP);
+            detail::GLShaderVariants::get().set_time(
+                static_cast<float>(now - wraps * ANIMATION_TIME_WRAP),
+                static_cast<s32>(wraps));
 #endif
         }
     }
@@ -572,6 +699,14 @@ namespace GI {
         if (glfwWindowShouldClose(window))
             Stardust_Celeste::Core::Application::get().exit();
 
+        // This frame's uniform blocks are fenced, the next frame writes a new region
+        if(uboRing != nullptr)
+            uboRing->next_region();
+
+        // Captures read the back buffer, so this comes before the swap
+        if(rctxSettings.renderingApi == OpenGL || rctxSettings.renderingApi == DefaultAPI)
+            detail::GLPixelTransfer::get().end_frame();
+
         glfwSwapBuffers(window);
 #elif BUILD_PLAT == BUILD_PSP
         guglSwapBuffers(vsync, dialog);
@@ -583,6 +718,65 @@ namespace GI {
         if (vsync)
             gspWaitForVBlank();
 #endif
+
+        lastFrameStats = frameStats;
+        frameStats = FrameStats();
+        frameCount++;
+    }
+
+    auto stream_uniform_block(const void* data, size_t size) -> void {
+#if BUILD_PC
+        if(uboRing == nullptr)
+            return;
+
+        size_t offset;
+        if(!uboRing->allocate(size, uboAlignment, offset)) {
+            // Region full: move on, waiting on its fence if the GPU still reads it
+            uboRing->next_region();
+            uboRing->allocate(size, uboAlignment, offset);
+        }
+
+        uboRing->write(offset, data, size);
+        glBindBufferRange(GL_UNIFORM_BUFFER, 0, uboRing->get_id(), offset, size);
+        uboBoundSerial = uboRing->get_serial();
+        uboBound = true;
+#endif
+    }
+
+    auto uniform_block_current() -> bool {
+#if BUILD_PC
+        if(uboRing == nullptr)
+            return true;
+        return uboBound && uboBoundSerial == uboRing->get_serial();
+#else
+        return true;
+#endif
+    }
+
+    auto get_frame_stats() -> FrameStats {
+        return lastFrameStats;
+    }
+
+    auto get_shader_cache_time_saved() -> double {
+#if BUILD_PC
+        return detail::ShaderCache::get().get_time_saved();
+#else
+        return 0.0;
+#endif
+    }
+
+    auto get_shader_variant_count() -> u32 {
+#if BUILD_PC
+        if(rctxSettings.renderingApi == OpenGL || rctxSettings.renderingApi == DefaultAPI)
+            return detail::GLShaderVariants::get().get_variant_count();
+#endif
+        return 0;
+    }
+
+    auto invalidate_state() -> void {
+        if(rctxSettings.renderingApi == OpenGL || rctxSettings.renderingApi == DefaultAPI) {
+            detail::GLStateCache::get().invalidate();
+        }
     }
 
     auto to_vec4(Color &c) -> mathfu::Vector<float, 4> {
@@ -635,28 +829,67 @@ namespace GI {
 
     auto enable_textures() -> void {
         if(rctxSettings.renderingApi == OpenGL || rctxSettings.renderingApi == DefaultAPI) {
-#if BUILD_PLAT == BUILD_VITA || BUILD_PC
-            glUniform1i(noTex, 0);
+#if BUILD_PC
+            detail::GLShaderVariants::get().set_feature(detail::SHADER_TEXTURED, true);
+#elif BUILD_PLAT == BUILD_VITA
+            detail::GLStateCache::get().uniform1i(noTex, 0);
 #endif
         }
     }
 
     auto disable_textures() -> void {
         if(rctxSettings.renderingApi == OpenGL || rctxSettings.renderingApi == DefaultAPI) {
-#if BUILD_PLAT == BUILD_VITA || BUILD_PC
-            glUniform1i(noTex, 1);
+#if BUILD_PC
+            detail::GLShaderVariants::get().set_feature(detail::SHADER_TEXTURED, false);
+#elif BUILD_PLAT == BUILD_VITA
+            detail::GLStateCache::get().uniform1i(noTex, 1);
 #endif
         }
     }
 
     auto set_tex_scroll(float v) -> void {
         if(rctxSettings.renderingApi == OpenGL || rctxSettings.renderingApi == DefaultAPI) {
-#if BUILD_PLAT == BUILD_VITA || BUILD_PC
-            glUniform1f(scroll, v);
+#if BUILD_PC
+            detail::GLShaderVariants::get().set_scroll(v);
+#elif BUILD_PLAT == BUILD_VITA
+            detail::GLStateCache::get().uniform1f(scroll, v);
 #endif
         }
     }
 
+    auto set_srgb_vertex_colors(bool srgb) -> void {
+#if BUILD_PC
+        detail::GLShaderVariants::get().set_feature(detail::SHADER_SRGB_COLORS, srgb);
+#else
+        (void)srgb;
+#endif
+    }
+
+    auto supports_atlas_animation() -> bool {
+#if BUILD_PC
+        return rctxSettings.renderingApi == OpenGL || rctxSettings.renderingApi == DefaultAPI;
+#else
+        return false;
+#endif
+    }
+
+    auto enable_atlas_animation(u32 columns, float frameWidth, float frameHeight) -> void {
+#if BUILD_PC
+        if(supports_atlas_animation()) {
+            auto &variants = detail::GLShaderVariants::get();
+            variants.set_animation_atlas(static_cast<float>(columns), frameWidth, frameHeight);
+            variants.set_feature(detail::SHADER_ANIMATED, true);
+        }
+#endif
+    }
+
+    auto disable_atlas_animation() -> void {
+#if BUILD_PC
+        if(supports_atlas_animation())
+            detail::GLShaderVariants::get().set_feature(detail::SHADER_ANIMATED, false);
+#endif
+    }
+
     auto create_texturehandle(std::string filename, u32 magFilter, u32 minFilter, bool repeat, bool flip) -> TextureHandle* {
         if(rctxSettings.renderingApi == Vulkan) {
 #ifndef NO_EXPERIMENTAL_GRAPHICS
@@ -681,25 +914,110 @@ namespace GI {
         return nullptr;
     }
 
-    auto create_vertexbuffer(const Stardust_Celeste::Rendering::Vertex* vert_data, size_t vert_size, const uint16_t* indices, size_t idx_size) -> BufferObject* {
+    auto create_texturehandle_pixels(const uint8_t* pixels, u32 width, u32 height, u32 magFilter, u32 minFilter, bool repeat) -> TextureHandle* {
+        if(rctxSettings.renderingApi == Vulkan) {
+#ifndef NO_EXPERIMENTAL_GRAPHICS
+            return detail::VKTextureHandle::create_pixels(pixels, width, height, magFilter, minFilter, repeat);
+#endif
+        } else if(rctxSettings.renderingApi == OpenGL || rctxSettings.renderingApi == DefaultAPI) {
+            return detail::GLTextureHandle::create_pixels(pixels, width, height, magFilter, minFilter, repeat);
+        }
+
+        return nullptr;
+    }
+
+    auto create_texturehandle_mipchain(const uint8_t* pixels, u32 width, u32 height, u32 levels, u32 magFilter, u32 minFilter, bool repeat) -> TextureHandle* {
+        if(rctxSettings.renderingApi == Vulkan) {
+#ifndef NO_EXPERIMENTAL_GRAPHICS
+            // Only the first level, the Vulkan path has no mip support yet
+            return detail::VKTextureHandle::create_pixels(pixels, width, height, magFilter, minFilter, repeat);
+#endif
+        } else if(rctxSettings.renderingApi == OpenGL || rctxSettings.renderingApi == DefaultAPI) {
+            return detail::GLTextureHandle::create_mipchain(pixels, width, height, levels, magFilter, minFilter, repeat);
+        }
+
+        return nullptr;
+    }
+
+    auto request_capture(CaptureCallback callback) -> bool {
+#if BUILD_PC
+        if(rctxSettings.renderingApi == OpenGL || rctxSettings.renderingApi == DefaultAPI) {
+            detail::GLPixelTransfer::get().request_capture(std::move(callback));
+            return true;
+        }
+#endif
+
+        return false;
+    }
+
+    auto supports_compressed_format(CompressedFormat format) -> bool {
+        if(rctxSettings.renderingApi == OpenGL || rctxSettings.renderingApi == DefaultAPI) {
+            return detail::GLTextureHandle::compressed_internal_format(format) != 0;
+        }
+
+        return false;
+    }
+
+    auto create_texturehandle_compressed(const uint8_t* data, CompressedFormat format, u32 width, u32 height, u32 levels, u32 magFilter, u32 minFilter, bool repeat) -> TextureHandle* {
+        if(rctxSettings.renderingApi == OpenGL || rctxSettings.renderingApi == DefaultAPI) {
+            return detail::GLTextureHandle::create_compressed(data, format, width, height, levels, magFilter, minFilter, repeat);
+        }
+
+        return nullptr;
+    }
+
+    auto create_texturehandle_array(const uint8_t* const* layers, u32 count, u32 width, u32 height, u32 magFilter, u32 minFilter, bool repeat) -> TextureHandle* {
+        if(rctxSettings.renderingApi == OpenGL || rctxSettings.renderingApi == DefaultAPI) {
+            return detail::GLTextureHandle::create_array(layers, count, width, height, magFilter, minFilter, repeat);
+        }
+
+        // The Vulkan path has no array textures, callers fall back to separate ones
+        return nullptr;
+    }
+
+    auto create_vertexbuffer(const Stardust_Celeste::Rendering::Vertex* vert_data, size_t vert_size, const uint16_t* indices, size_t idx_size, Stardust_Celeste::Rendering::BufferUsage usage) -> BufferObject* {
+        if (rctxSettings.renderingApi == Vulkan) {
+#ifndef NO_EXPERIMENTAL_GRAPHICS
+            return detail::VKBufferObject::create(vert_data, vert_size, indices, idx_size);
+#endif
+        } else if(rctxSettings.renderingApi == OpenGL || rctxSettings.renderingApi == DefaultAPI) {
+            return detail::GLBufferObject::create(vert_data, vert_size, indices, idx_size, usage);
+        }
+
+        return nullptr;
+    }
+
+    auto create_vertexbuffer(const Stardust_Celeste::Rendering::SimpleVertex* vert_data, size_t vert_size, const uint16_t* indices, size_t idx_size, Stardust_Celeste::Rendering::BufferUsage usage) -> BufferObject* {
+        if (rctxSettings.renderingApi == Vulkan) {
+#ifndef NO_EXPERIMENTAL_GRAPHICS
+            return detail::VKBufferObject::create(vert_data, vert_size, indices, idx_size);
+#endif
+        } else if(rctxSettings.renderingApi == OpenGL || rctxSettings.renderingApi == DefaultAPI) {
+            return detail::GLBufferObject::create(vert_data, vert_size, indices, idx_size, usage);
+        }
+
+        return nullptr;
+    }
+
+    auto create_vertexbuffer(const Stardust_Celeste::Rendering::Vertex* vert_data, size_t vert_size, const uint32_t* indices, size_t idx_size, Stardust_Celeste::Rendering::BufferUsage usage) -> BufferObject* {
         if (rctxSettings.renderingApi == Vulkan) {
 #ifndef NO_EXPERIMENTAL_GRAPHICS
             return detail::VKBufferObject::create(vert_data, vert_size, indices, idx_size);
 #endif
         } else if(rctxSettings.renderingApi == OpenGL || rctxSettings.renderingApi == DefaultAPI) {
-            return detail::GLBufferObject::create(vert_data, vert_size, indices, idx_size);
+            return detail::GLBufferObject::create(vert_data, vert_size, indices, idx_size, usage);
         }
 
         return nullptr;
     }
 
-    auto create_vertexbuffer(const Stardust_Celeste::Rendering::SimpleVertex* vert_data, size_t vert_size, const uint16_t* indices, size_t idx_size) -> BufferObject* {
+    auto create_vertexbuffer(const Stardust_Celeste::Rendering::SimpleVertex* vert_data, size_t vert_size, const uint32_t* indices, size_t idx_size, Stardust_Celeste::Rendering::BufferUsage usage) -> BufferObject* {
         if (rctxSettings.renderingApi == Vulkan) {
 #ifndef NO_EXPERIMENTAL_GRAPHICS
             return detail::VKBufferObject::create(vert_data, vert_size, indices, idx_size);
 #endif
         } else if(rctxSettings.renderingApi == OpenGL || rctxSettings.renderingApi == DefaultAPI) {
-            return detail::GLBufferObject::create(vert_data, vert_size, indices, idx_size);
+            return detail::GLBufferObject::create(vert_data, vert_size, indices, idx_size, usage);
         }
 
         return nullptr;
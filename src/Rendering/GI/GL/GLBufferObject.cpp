@@ -1,7 +1,13 @@
 #include <Platform/Platform.hpp>
 #include <Rendering/GI/GL/GLBufferObject.hpp>
+#include <Rendering/GI.hpp>
+#include <Rendering/GI/GL/GLStateCache.hpp>
+#include <Rendering/GI/GL/GLShaderVariants.hpp>
 #include "Rendering/RenderTypes.hpp"
 #include <Utilities/Logger.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
 #define BUILD_PC (BUILD_PLAT == BUILD_WINDOWS || BUILD_PLAT == BUILD_POSIX)
 
 #if BUILD_PC
@@ -10,26 +16,190 @@ namespace GI {
 }
 #endif
 
+namespace GI {
+    extern FrameStats frameStats;
+    extern u64 frameCount;
+}
+
 namespace GI::detail{
-    GLBufferObject* GLBufferObject::create(const Stardust_Celeste::Rendering::Vertex* vert_data, size_t vert_size, const uint16_t* indices, size_t idx_size) {
-        GLBufferObject* vbo = new GLBufferObject();
-        vbo->setup = false;
+#if BUILD_PC || BUILD_PLAT == BUILD_VITA
+    static auto to_gl_usage(Rendering::BufferUsage usage) -> GLenum {
+        switch (usage) {
+            case Rendering::BUFFER_USAGE_DYNAMIC:
+                return GL_DYNAMIC_DRAW;
+            case Rendering::BUFFER_USAGE_STREAM:
+                return GL_STREAM_DRAW;
+            default:
+                return GL_STATIC_DRAW;
+        }
+    }
 
-        vbo->update(vert_data, vert_size, indices, idx_size);
-        return vbo;
+    static auto to_gl_index_type(size_t stride) -> GLenum {
+        return stride == sizeof(u32) ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
+    }
+#endif
+
+#if BUILD_PC
+    static void set_attributes(const Stardust_Celeste::Rendering::Vertex*, size_t base) {
+        const auto stride = sizeof(Stardust_Celeste::Rendering::Vertex);
+
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride,
+                              reinterpret_cast<void *>(base + sizeof(float) * 3));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride,
+                              reinterpret_cast<void *>(base + sizeof(float) * 2));
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void *>(base));
+        glEnableVertexAttribArray(7);
+        glVertexAttribPointer(7, 1, GL_FLOAT, GL_FALSE, stride,
+                              reinterpret_cast<void *>(base + offsetof(Stardust_Celeste::Rendering::Vertex, sheet)));
+        glEnableVertexAttribArray(8);
+        glVertexAttribIPointer(8, 4, GL_UNSIGNED_SHORT, stride,
+                               reinterpret_cast<void *>(base + offsetof(Stardust_Celeste::Rendering::Vertex, frame)));
+    }
+
+    static void set_attributes(const Stardust_Celeste::Rendering::SimpleVertex*, size_t base) {
+        const auto stride = sizeof(Stardust_Celeste::Rendering::SimpleVertex);
+
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, stride,
+                              reinterpret_cast<void *>(base + sizeof(uint16_t) * 2 + sizeof(uint32_t)));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride,
+                              reinterpret_cast<void *>(base + sizeof(uint16_t) * 2));
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_UNSIGNED_SHORT, GL_TRUE, stride, reinterpret_cast<void *>(base));
+        glDisableVertexAttribArray(7);
+        glDisableVertexAttribArray(8);
+    }
+
+    /**
+     * Uploads into the buffer bound to target. Static buffers are respecified
+     * every time; dynamic buffers keep their store and only reallocate to
+     * grow; stream buffers orphan the old store so the driver never stalls on
+     * a buffer the GPU is still reading.
+     */
+    static void upload_store(GLenum target, size_t& capacity, const void* data, size_t size, Rendering::BufferUsage usage) {
+        if (usage == Rendering::BUFFER_USAGE_STATIC) {
+            glBufferData(target, size, data, GL_STATIC_DRAW);
+            capacity = size;
+            return;
+        }
+
+        if (size > capacity) {
+            capacity = std::max(size, capacity * 2);
+            glBufferData(target, capacity, nullptr, to_gl_usage(usage));
+        } else if (usage == Rendering::BUFFER_USAGE_STREAM) {
+            glBufferData(target, capacity, nullptr, to_gl_usage(usage));
+        }
+
+        if (size > 0)
+            glBufferSubData(target, 0, size, data);
+    }
+
+    // Largest region a stream buffer grows its ring to, beyond it uploads wrap
+    constexpr size_t STREAM_RING_MAX_REGION = 4 << 20;
+
+    static auto next_pow2(size_t v) -> size_t {
+        size_t p = 1;
+        while (p < v)
+            p <<= 1;
+        return p;
+    }
+
+    template <class V, class I>
+    void GLBufferObject::upload(const V* vert_data, size_t vert_size, const I* indices, size_t idx_size) {
+        simple = std::is_same_v<V, Stardust_Celeste::Rendering::SimpleVertex>;
+        const auto vtx_bytes = sizeof(V) * vert_size;
+        const auto idx_bytes = sizeof(I) * idx_size;
+
+        if (!setup) {
+            glGenVertexArrays(1, &vao);
+            glGenBuffers(1, &vbo);
+            glGenBuffers(1, &ebo);
+            setup = true;
+        }
+        GLStateCache::get().bind_vertex_array(vao);
+
+        if (usage == Rendering::BUFFER_USAGE_STREAM && GLRingBuffer::persistent_supported()) {
+            // Vertices and indices share one region of the ring
+            const size_t align = 16;
+            const auto needed = (vtx_bytes + align - 1) / align * align + idx_bytes;
+
+            if (ring == nullptr || ring->get_region_size() < needed) {
+                ring = create_scopeptr<GLRingBuffer>(GL_ARRAY_BUFFER, next_pow2(needed));
+            } else if (ring_frame != frameCount) {
+                // Once per frame, like the uniform ring -- the region left
+                // behind was fenced frames ago, so this rarely waits
+                ring->next_region();
+            }
+            ring_frame = frameCount;
+
+            // Later uploads in the frame go after the earlier ones
+            size_t vtx_offset = 0, idx_offset = 0;
+            if (!ring->allocate(vtx_bytes, align, vtx_offset) ||
+                !ring->allocate(idx_bytes, align, idx_offset)) {
+                // Region full: grow it so the next frames fit, up to a cap,
+                // and only wrap onto a fenced region past that
+                if (ring->get_region_size() < STREAM_RING_MAX_REGION) {
+                    auto size = std::max(next_pow2(needed), ring->get_region_size() * 2);
+                    ring = create_scopeptr<GLRingBuffer>(GL_ARRAY_BUFFER, size);
+                } else {
+                    ring->next_region();
+                }
+
+                ring->allocate(vtx_bytes, align, vtx_offset);
+                ring->allocate(idx_bytes, align, idx_offset);
+            }
+            ring->write(vtx_offset, vert_data, vtx_bytes);
+            ring->write(idx_offset, indices, idx_bytes);
+
+            glBindBuffer(GL_ARRAY_BUFFER, ring->get_id());
+            set_attributes(vert_data, vtx_offset);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ring->get_id());
+            idx_base = idx_offset;
+        } else {
+            glBindBuffer(GL_ARRAY_BUFFER, vbo);
+            upload_store(GL_ARRAY_BUFFER, vbo_capacity, vert_data, vtx_bytes, usage);
+            set_attributes(vert_data, 0);
+
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+            upload_store(GL_ELEMENT_ARRAY_BUFFER, ebo_capacity, indices, idx_bytes, usage);
+            idx_base = 0;
+        }
+
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
     }
-    GLBufferObject* GLBufferObject::create(const Stardust_Celeste::Rendering::SimpleVertex* vert_data, size_t vert_size, const uint16_t* indices, size_t idx_size) {
+#endif
+
+    template <class V, class I>
+    GLBufferObject* GLBufferObject::create_buffer(const V* vert_data, size_t vert_size, const I* indices, size_t idx_size, Rendering::BufferUsage usage) {
         GLBufferObject* vbo = new GLBufferObject();
         vbo->setup = false;
+        vbo->usage = usage;
 
-        vbo->update(vert_data, vert_size, indices, idx_size);
+        vbo->store(vert_data, vert_size, indices, idx_size);
         return vbo;
     }
 
+    GLBufferObject* GLBufferObject::create(const Stardust_Celeste::Rendering::Vertex* vert_data, size_t vert_size, const uint16_t* indices, size_t idx_size, Rendering::BufferUsage usage) {
+        return create_buffer(vert_data, vert_size, indices, idx_size, usage);
+    }
+    GLBufferObject* GLBufferObject::create(const Stardust_Celeste::Rendering::SimpleVertex* vert_data, size_t vert_size, const uint16_t* indices, size_t idx_size, Rendering::BufferUsage usage) {
+        return create_buffer(vert_data, vert_size, indices, idx_size, usage);
+    }
+    GLBufferObject* GLBufferObject::create(const Stardust_Celeste::Rendering::Vertex* vert_data, size_t vert_size, const uint32_t* indices, size_t idx_size, Rendering::BufferUsage usage) {
+        return create_buffer(vert_data, vert_size, indices, idx_size, usage);
+    }
+    GLBufferObject* GLBufferObject::create(const Stardust_Celeste::Rendering::SimpleVertex* vert_data, size_t vert_size, const uint32_t* indices, size_t idx_size, Rendering::BufferUsage usage) {
+        return create_buffer(vert_data, vert_size, indices, idx_size, usage);
+    }
+
     void GLBufferObject::bind() {
         if(setup) {
 #if BUILD_PC
-            glBindVertexArray(vao);
+            GLStateCache::get().bind_vertex_array(vao);
 #elif BUILD_PLAT == BUILD_VITA
             glBindBuffer(GL_ARRAY_BUFFER, vbo);
             glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
@@ -38,47 +208,58 @@ namespace GI::detail{
     }
 
     void GLBufferObject::draw(Rendering::PrimType p) {
+        draw_range(p, 0, idx_count);
+    }
+
+    void GLBufferObject::draw_range(Rendering::PrimType p, size_t idx_offset, size_t count) {
+        if (count == 0 || idx_offset + count > idx_count)
+            return;
+
+        frameStats.draw_calls++;
+
         #if BUILD_PC
-        if(simple) {
-            glUniform1i(glGetUniformLocation(programID, "simple"), 1);
-        } else {
-            glUniform1i(glGetUniformLocation(programID, "simple"), 0);
-        }
+        auto &variants = GLShaderVariants::get();
+        variants.set_feature(SHADER_SIMPLE_VERTEX, simple);
+        variants.apply();
+                auto offset = reinterpret_cast<void *>(idx_base + idx_stride * idx_offset);
                 if (p == Rendering::PrimType::PRIM_TYPE_TRIANGLE) {
-                    glDrawElements(GL_TRIANGLES, idx_count, GL_UNSIGNED_SHORT,
-                                   nullptr);
+                    glDrawElements(GL_TRIANGLES, count, to_gl_index_type(idx_stride),
+                                   offset);
                 } else {
                     glLineWidth(4.0f);
-                    glDrawElements(GL_LINE_STRIP, idx_count, GL_UNSIGNED_SHORT,
-                                   nullptr);
+                    glDrawElements(GL_LINE_STRIP, count, to_gl_index_type(idx_stride),
+                                   offset);
                 }
         #elif BUILD_PLAT == BUILD_PSP
+                // The GE only reads 8 and 16 bit indices
+                if (idx_stride != sizeof(u16))
+                    return;
+
+                auto idx = reinterpret_cast<const u16 *>(idx_buf) + idx_offset;
                 sceGuShadeModel(GU_SMOOTH);
                 if(!simple) {
                 if (p == Rendering::PrimType::PRIM_TYPE_TRIANGLE) {
                     sceGumDrawArray(GU_TRIANGLES,
                                     GU_INDEX_16BIT | GU_TEXTURE_32BITF | GU_COLOR_8888 |
                                             GU_VERTEX_32BITF | GU_TRANSFORM_3D,
-                                    idx_count, idx_buf, vtx_buf);
+                                    count, idx, vtx_buf);
                 } else {
                     sceGumDrawArray(GU_LINE_STRIP,
                                     GU_INDEX_16BIT | GU_TEXTURE_32BITF | GU_COLOR_8888 |
                                             GU_VERTEX_32BITF | GU_TRANSFORM_3D,
-                                    idx_count, idx_buf, vtx_buf);
+                                    count, idx, vtx_buf);
                 }
                 } else {
                     if (p == Rendering::PrimType::PRIM_TYPE_TRIANGLE) {
                     sceGumDrawArray(GU_TRIANGLES,
                                     GU_INDEX_16BIT | GU_TEXTURE_16BIT | GU_COLOR_8888 |
                                             GU_VERTEX_16BIT | GU_TRANSFORM_3D,
-                                    idx_count, idx_buf, vtx_buf);
+                                    count, idx, vtx_buf);
                     }
                 }
         #elif BUILD_PLAT == BUILD_VITA
-                if (vertices.size() == 0 || indices.size() == 0)
-                    return;
-
-                const auto stride = sizeof(T);
+                const auto stride = sizeof(Stardust_Celeste::Rendering::Vertex);
+                auto offset = reinterpret_cast<void *>(idx_stride * idx_offset);
 
                 glEnableVertexAttribArray(0);
                 glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride,
@@ -89,12 +270,12 @@ namespace GI::detail{
                 glEnableVertexAttribArray(2);
                 glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, nullptr);
 
-                if (p == PRIM_TYPE_TRIANGLE) {
-                    glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_SHORT,
-                                   nullptr);
+                if (p == Rendering::PrimType::PRIM_TYPE_TRIANGLE) {
+                    glDrawElements(GL_TRIANGLES, count, to_gl_index_type(idx_stride),
+                                   offset);
                 } else {
-                    glDrawElements(GL_LINE_STRIP, indices.size(), GL_UNSIGNED_SHORT,
-                                   nullptr);
+                    glDrawElements(GL_LINE_STRIP, count, to_gl_index_type(idx_stride),
+                                   offset);
                 }
 
                 glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -113,11 +294,11 @@ namespace GI::detail{
                 glTexCoordPointer(2, GL_FLOAT, sizeof(T), vertices.data());
 
                 if (p == PRIM_TYPE_TRIANGLE) {
-                    glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_SHORT,
-                                   indices.data());
+                    glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_SHORT,
+                                   indices.data() + idx_offset);
                 } else {
-                    glDrawElements(GL_LINE_STRIP, indices.size(), GL_UNSIGNED_SHORT,
-                                   indices.data());
+                    glDrawElements(GL_LINE_STRIP, count, GL_UNSIGNED_SHORT,
+                                   indices.data() + idx_offset);
                 }
 
                 glDisableClientState(GL_VERTEX_ARRAY);
@@ -126,41 +307,64 @@ namespace GI::detail{
         #endif
     }
 
-    void GLBufferObject::update(const Stardust_Celeste::Rendering::Vertex* vert_data, size_t vert_size, const uint16_t* indices, size_t idx_size) {
+    bool GLBufferObject::draw_instanced(Rendering::PrimType p, const Rendering::InstanceData* instances, size_t count) {
 #if BUILD_PC
-        simple = false;
-        if (!setup) {
-            glGenVertexArrays(1, &vao);
-            glGenBuffers(1, &vbo);
+        if (!setup || idx_count == 0 || count == 0)
+            return true;
+
+        const auto stride = sizeof(Rendering::InstanceData);
+        const auto bytes = stride * count;
+
+        GLStateCache::get().bind_vertex_array(vao);
+        if (ivbo == 0)
+            glGenBuffers(1, &ivbo);
+        glBindBuffer(GL_ARRAY_BUFFER, ivbo);
+        upload_store(GL_ARRAY_BUFFER, ivbo_capacity, instances, bytes, Rendering::BUFFER_USAGE_STREAM);
+
+        glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, stride,
+                              reinterpret_cast<void *>(offsetof(Rendering::InstanceData, a)));
+        glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, stride,
+                              reinterpret_cast<void *>(offsetof(Rendering::InstanceData, x)));
+        glVertexAttribPointer(5, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride,
+                              reinterpret_cast<void *>(offsetof(Rendering::InstanceData, color)));
+        glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, stride,
+                              reinterpret_cast<void *>(offsetof(Rendering::InstanceData, u)));
+        for (GLuint i = 3; i <= 6; i++) {
+            glEnableVertexAttribArray(i);
+            glVertexAttribDivisor(i, 1);
         }
-        bind();
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-        glBindVertexArray(vao);
-        glBindBuffer(GL_ARRAY_BUFFER, vbo);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(Stardust_Celeste::Rendering::Vertex) * vert_size,
-                     vert_data, GL_STATIC_DRAW);
+        auto &variants = GLShaderVariants::get();
+        variants.set_feature(SHADER_SIMPLE_VERTEX, simple);
+        variants.apply();
 
-        const auto stride = sizeof(Stardust_Celeste::Rendering::Vertex);
+        auto offset = reinterpret_cast<void *>(idx_base);
+        if (p == Rendering::PrimType::PRIM_TYPE_TRIANGLE) {
+            glDrawElementsInstanced(GL_TRIANGLES, idx_count, to_gl_index_type(idx_stride), offset, count);
+        } else {
+            glLineWidth(4.0f);
+            glDrawElementsInstanced(GL_LINE_STRIP, idx_count, to_gl_index_type(idx_stride), offset, count);
+        }
 
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride,
-                              reinterpret_cast<void *>(sizeof(float) * 3));
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride,
-                              reinterpret_cast<void *>(sizeof(float) * 2));
-        glEnableVertexAttribArray(2);
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, nullptr);
+        // Plain draws of this VAO fall back to the identity instance
+        for (GLuint i = 3; i <= 6; i++)
+            glDisableVertexAttribArray(i);
 
-        if (!setup) {
-            glGenBuffers(1, &ebo);
-            setup = true;
-        }
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(u16) * idx_size,
-                     indices, GL_STATIC_DRAW);
+        frameStats.draw_calls++;
+        frameStats.buffer_uploads++;
+        frameStats.bytes_uploaded += bytes;
+        return true;
+#else
+        return false;
+#endif
+    }
 
-        glBindVertexArray(0);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    template <class V, class I>
+    void GLBufferObject::store(const V* vert_data, size_t vert_size, const I* indices, size_t idx_size) {
+        idx_stride = sizeof(I);
+#if BUILD_PC
+        upload(vert_data, vert_size, indices, idx_size);
 #elif BUILD_PLAT == BUILD_VITA
         if (idx_size <= 0 || vert_size <= 0)
             return;
@@ -169,16 +373,16 @@ namespace GI::detail{
             glGenBuffers(1, &vbo);
         }
         glBindBuffer(GL_ARRAY_BUFFER, vbo);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(Stardust_Celeste::Rendering::Vertex) * vert_size,
-                     vert_data, GL_STATIC_DRAW);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(V) * vert_size,
+                     vert_data, to_gl_usage(usage));
 
         if (!setup) {
             glGenBuffers(1, &ebo);
             setup = true;
         }
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(u16) * idx_size,
-                     indices, GL_STATIC_DRAW);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(I) * idx_size,
+                     indices, to_gl_usage(usage));
 
         glBindBuffer(GL_ARRAY_BUFFER, 0);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
@@ -187,82 +391,113 @@ namespace GI::detail{
         vtx_buf = vert_data;
         idx_buf = indices;
         sceKernelDcacheWritebackInvalidateAll();
+        simple = std::is_same_v<V, Stardust_Celeste::Rendering::SimpleVertex>;
 #endif
+        vtx_count = vert_size;
         idx_count = idx_size;
+        frameStats.buffer_uploads++;
+        frameStats.bytes_uploaded += sizeof(V) * vert_size + sizeof(I) * idx_size;
+    }
+
+    void GLBufferObject::update(const Stardust_Celeste::Rendering::Vertex* vert_data, size_t vert_size, const uint16_t* indices, size_t idx_size) {
+        store(vert_data, vert_size, indices, idx_size);
     }
 
     void GLBufferObject::update(const Stardust_Celeste::Rendering::SimpleVertex* vert_data, size_t vert_size, const uint16_t* indices, size_t idx_size) {
-#if BUILD_PC
-        simple = true;
-        if (!setup) {
-            glGenVertexArrays(1, &vao);
-            glGenBuffers(1, &vbo);
-        }
-        bind();
+        store(vert_data, vert_size, indices, idx_size);
+    }
 
-        glBindVertexArray(vao);
-        glBindBuffer(GL_ARRAY_BUFFER, vbo);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(Stardust_Celeste::Rendering::SimpleVertex) * vert_size,
-                     vert_data, GL_STATIC_DRAW);
+    void GLBufferObject::update(const Stardust_Celeste::Rendering::Vertex* vert_data, size_t vert_size, const uint32_t* indices, size_t idx_size) {
+        store(vert_data, vert_size, indices, idx_size);
+    }
 
-        const auto stride = sizeof(Stardust_Celeste::Rendering::SimpleVertex);
+    void GLBufferObject::update(const Stardust_Celeste::Rendering::SimpleVertex* vert_data, size_t vert_size, const uint32_t* indices, size_t idx_size) {
+        store(vert_data, vert_size, indices, idx_size);
+    }
 
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, stride,
-                              reinterpret_cast<void *>(sizeof(uint16_t) * 2 + sizeof(uint32_t)));
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride,
-                              reinterpret_cast<void *>(sizeof(uint16_t) * 2));
-        glEnableVertexAttribArray(2);
-        glVertexAttribPointer(2, 2, GL_UNSIGNED_SHORT, GL_TRUE, stride, nullptr);
+    template <class V, class I>
+    void GLBufferObject::upload_range(const V* vert_data, size_t vert_offset, size_t vert_count, const I* indices, size_t idx_offset, size_t count) {
+        if (vert_offset + vert_count > vtx_count || idx_offset + count > idx_count || sizeof(I) != idx_stride)
+            return;
 
-        if (!setup) {
-            glGenBuffers(1, &ebo);
-            setup = true;
+        const auto vtx_bytes = sizeof(V) * vert_count;
+        const auto idx_bytes = sizeof(I) * count;
+
+#if BUILD_PC
+        if (!setup)
+            return;
+
+        // A ring region is in flight once written, so streamed buffers are rewritten whole
+        if (ring != nullptr) {
+            upload(vert_data, vtx_count, indices, idx_count);
+            frameStats.buffer_uploads++;
+            frameStats.bytes_uploaded += sizeof(V) * vtx_count + sizeof(I) * idx_count;
+            return;
         }
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(u16) * idx_size,
-                     indices, GL_STATIC_DRAW);
 
-        glBindVertexArray(0);
+        GLStateCache::get().bind_vertex_array(vao);
+        if (vtx_bytes > 0) {
+            glBindBuffer(GL_ARRAY_BUFFER, vbo);
+            glBufferSubData(GL_ARRAY_BUFFER, sizeof(V) * vert_offset, vtx_bytes, vert_data + vert_offset);
+        }
+        if (idx_bytes > 0)
+            glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, sizeof(I) * idx_offset, idx_bytes, indices + idx_offset);
         glBindBuffer(GL_ARRAY_BUFFER, 0);
 #elif BUILD_PLAT == BUILD_VITA
-        if (idx_size <= 0 || vert_size <= 0)
+        if (!setup)
             return;
 
-        if (!setup) {
-            glGenBuffers(1, &vbo);
+        if (vtx_bytes > 0) {
+            glBindBuffer(GL_ARRAY_BUFFER, vbo);
+            glBufferSubData(GL_ARRAY_BUFFER, sizeof(V) * vert_offset, vtx_bytes, vert_data + vert_offset);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
         }
-        glBindBuffer(GL_ARRAY_BUFFER, vbo);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(Stardust_Celeste::Rendering::Vertex) * vert_size,
-                     vert_data, GL_STATIC_DRAW);
-
-        if (!setup) {
-            glGenBuffers(1, &ebo);
-            setup = true;
+        if (idx_bytes > 0) {
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+            glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, sizeof(I) * idx_offset, idx_bytes, indices + idx_offset);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
         }
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(u16) * idx_size,
-                     indices, GL_STATIC_DRAW);
-
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 #elif BUILD_PLAT == BUILD_PSP
-        vtx_size = vert_size;
+        // The GE reads the arrays in place, only the touched cache lines need flushing
         vtx_buf = vert_data;
         idx_buf = indices;
-        sceKernelDcacheWritebackInvalidateAll();
-        simple = true;
+        if (vtx_bytes > 0)
+            sceKernelDcacheWritebackRange(vert_data + vert_offset, vtx_bytes);
+        if (idx_bytes > 0)
+            sceKernelDcacheWritebackRange(indices + idx_offset, idx_bytes);
 #endif
-        idx_count = idx_size;
+        frameStats.buffer_uploads++;
+        frameStats.bytes_uploaded += vtx_bytes + idx_bytes;
+    }
+
+    void GLBufferObject::update_range(const Stardust_Celeste::Rendering::Vertex* vert_data, size_t vert_offset, size_t vert_count, const uint16_t* indices, size_t idx_offset, size_t count) {
+        upload_range(vert_data, vert_offset, vert_count, indices, idx_offset, count);
+    }
+
+    void GLBufferObject::update_range(const Stardust_Celeste::Rendering::SimpleVertex* vert_data, size_t vert_offset, size_t vert_count, const uint16_t* indices, size_t idx_offset, size_t count) {
+        upload_range(vert_data, vert_offset, vert_count, indices, idx_offset, count);
+    }
+
+    void GLBufferObject::update_range(const Stardust_Celeste::Rendering::Vertex* vert_data, size_t vert_offset, size_t vert_count, const uint32_t* indices, size_t idx_offset, size_t count) {
+        upload_range(vert_data, vert_offset, vert_count, indices, idx_offset, count);
+    }
+
+    void GLBufferObject::update_range(const Stardust_Celeste::Rendering::SimpleVertex* vert_data, size_t vert_offset, size_t vert_count, const uint32_t* indices, size_t idx_offset, size_t count) {
+        upload_range(vert_data, vert_offset, vert_count, indices, idx_offset, count);
     }
 
     void GLBufferObject::destroy() {
         if(setup) {
 #if BUILD_PC
+            GLStateCache::get().vertex_array_deleted(vao);
             glDeleteVertexArrays(1, &vao);
             glDeleteBuffers(1, &vbo);
             glDeleteBuffers(1, &ebo);
+            if (ivbo != 0)
+                glDeleteBuffers(1, &ivbo);
+            ivbo = 0;
+            ring.reset();
+            vbo_capacity = ebo_capacity = ivbo_capacity = 0;
             setup = false;
 
 #elif BUILD_PLAT == BUILD_VITA
@@ -0,0 +1,133 @@
+#include <Rendering/GI/GL/GLPixelTransfer.hpp>
+#if BUILD_PLAT == BUILD_WINDOWS || BUILD_PLAT == BUILD_POSIX
+#include <Rendering/PixelOps.hpp>
+#include <cstring>
+
+namespace GI::detail {
+    auto GLPixelTransfer::begin_upload(const void* pixels, size_t size, const void*& source) -> bool {
+        if (size < MIN_STAGED_BYTES || size > UPLOAD_REGION_SIZE)
+            return false;
+
+        if (uploadRing == nullptr) {
+            uploadRing = create_scopeptr<GLRingBuffer>(GL_PIXEL_UNPACK_BUFFER, UPLOAD_REGION_SIZE);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+
+        size_t offset;
+        if (!uploadRing->allocate(size, 16, offset))
+            return false;
+
+        uploadRing->write(offset, pixels, size);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, uploadRing->get_id());
+        source = reinterpret_cast<const void*>(offset);
+        return true;
+    }
+
+    auto GLPixelTransfer::end_upload() -> void {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    auto GLPixelTransfer::request_capture(CaptureCallback callback) -> void {
+        requests.push_back(std::move(callback));
+    }
+
+    auto GLPixelTransfer::issue_readback() -> void {
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+
+        Readback readback;
+        if (!idle.empty()) {
+            readback = std::move(idle.back());
+            idle.pop_back();
+        } else {
+            glGenBuffers(1, &readback.buffer);
+        }
+
+        readback.width = static_cast<u32>(viewport[2]);
+        readback.height = static_cast<u32>(viewport[3]);
+        auto size = (size_t)readback.width * readback.height * 4;
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+        if (readback.capacity < size) {
+            glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+            readback.capacity = size;
+        }
+
+        // With a pack buffer bound the read only queues a GPU copy
+        glReadPixels(viewport[0], viewport[1], readback.width, readback.height,
+                     GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        readback.callbacks = std::move(requests);
+        requests.clear();
+        inFlight.push_back(std::move(readback));
+    }
+
+    auto GLPixelTransfer::deliver_readbacks() -> void {
+        while (!inFlight.empty()) {
+            auto res = glClientWaitSync(inFlight.front().fence, 0, 0);
+            if (res == GL_TIMEOUT_EXPIRED)
+                break;
+
+            auto readback = std::move(inFlight.front());
+            inFlight.pop_front();
+            glDeleteSync(readback.fence);
+            readback.fence = nullptr;
+
+            auto stride = (size_t)readback.width * 4;
+            auto size = stride * readback.height;
+            captured.resize(size);
+
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+            auto src = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+            if (src != nullptr) {
+                memcpy(captured.data(), src, size);
+                glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            }
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+            auto callbacks = std::move(readback.callbacks);
+            readback.callbacks.clear();
+            auto width = readback.width;
+            auto height = readback.height;
+            idle.push_back(std::move(readback));
+
+            if (src == nullptr)
+                continue;
+
+            // GL rows run bottom to top
+            Stardust_Celeste::Rendering::PixelOps::flip_vertical(captured.data(), stride, height);
+            for (auto &callback : callbacks)
+                callback(captured.data(), width, height);
+        }
+    }
+
+    auto GLPixelTransfer::end_frame() -> void {
+        deliver_readbacks();
+
+        if (!requests.empty() && inFlight.size() < MAX_CAPTURES_IN_FLIGHT)
+            issue_readback();
+
+        // This frame's staged uploads are fenced, the next frame stages into
+        // a new region
+        if (uploadRing != nullptr)
+            uploadRing->next_region();
+    }
+
+    auto GLPixelTransfer::release() -> void {
+        for (auto &readback : inFlight) {
+            glDeleteSync(readback.fence);
+            glDeleteBuffers(1, &readback.buffer);
+        }
+        for (auto &readback : idle)
+            glDeleteBuffers(1, &readback.buffer);
+
+        inFlight.clear();
+        idle.clear();
+        requests.clear();
+        captured.clear();
+        uploadRing.reset();
+    }
+}
+#endif
@@ -0,0 +1,139 @@
+#include <Rendering/GI/GL/GLProgramCache.hpp>
+#if BUILD_PLAT == BUILD_WINDOWS || BUILD_PLAT == BUILD_POSIX
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+#include <Rendering/GI/GL/GLStateCache.hpp>
+#include <Rendering/GI/ShaderCache.hpp>
+#include <Utilities/Logger.hpp>
+#include <chrono>
+#include <cstdio>
+
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+namespace GI::detail {
+    // glad is generated for GL 4.0 core, so GL 4.1 program binaries are loaded by hand
+    typedef void(APIENTRYP PFNGLGETPROGRAMBINARYPROC)(GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, void *binary);
+    typedef void(APIENTRYP PFNGLPROGRAMBINARYPROC)(GLuint program, GLenum binaryFormat, const void *binary, GLsizei length);
+    typedef void(APIENTRYP PFNGLPROGRAMPARAMETERIPROC)(GLuint program, GLenum pname, GLint value);
+    static PFNGLGETPROGRAMBINARYPROC getProgramBinary = nullptr;
+    static PFNGLPROGRAMBINARYPROC programBinary = nullptr;
+    static PFNGLPROGRAMPARAMETERIPROC programParameteri = nullptr;
+
+    static auto driver_string(GLenum name) -> std::string {
+        auto str = reinterpret_cast<const char*>(glGetString(name));
+        return str != nullptr ? str : "";
+    }
+
+    auto GLProgramCache::supported() -> bool {
+        if (!checked) {
+            checked = true;
+
+            GLint major = 0, minor = 0;
+            glGetIntegerv(GL_MAJOR_VERSION, &major);
+            glGetIntegerv(GL_MINOR_VERSION, &minor);
+
+            if (major > 4 || (major == 4 && minor >= 1) || glfwExtensionSupported("GL_ARB_get_program_binary")) {
+                getProgramBinary = (PFNGLGETPROGRAMBINARYPROC)glfwGetProcAddress("glGetProgramBinary");
+                programBinary = (PFNGLPROGRAMBINARYPROC)glfwGetProcAddress("glProgramBinary");
+                programParameteri = (PFNGLPROGRAMPARAMETERIPROC)glfwGetProcAddress("glProgramParameteri");
+            }
+
+            // Drivers may expose the entry points without any binary format
+            GLint formats = 0;
+            if (getProgramBinary != nullptr)
+                glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+            if (formats <= 0)
+                getProgramBinary = nullptr;
+
+            driverKey = ShaderCache::hash(driver_string(GL_VENDOR));
+            driverKey = ShaderCache::hash(driver_string(GL_RENDERER), driverKey);
+            driverKey = ShaderCache::hash(driver_string(GL_VERSION), driverKey);
+        }
+
+        return getProgramBinary != nullptr && programBinary != nullptr &&
+               programParameteri != nullptr && ShaderCache::get().enabled();
+    }
+
+    auto GLProgramCache::name_of(const std::string &vert, const std::string &frag) -> std::string {
+        char name[24];
+        snprintf(name, sizeof(name), "gl_%016llx",
+                 static_cast<unsigned long long>(ShaderCache::hash(frag, ShaderCache::hash(vert))));
+        return name;
+    }
+
+    auto GLProgramCache::key_of(const std::string &vert, const std::string &frag) -> u64 {
+        return ShaderCache::hash(frag, ShaderCache::hash(vert, driverKey));
+    }
+
+    auto GLProgramCache::prepare(GLuint program) -> void {
+        if (supported())
+            programParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
+    auto GLProgramCache::load(const std::string &vert, const std::string &frag) -> GLuint {
+        if (!supported())
+            return 0;
+
+        auto start = std::chrono::steady_clock::now();
+
+        auto &cache = ShaderCache::get();
+        auto name = name_of(vert, frag);
+        ShaderCacheEntry entry;
+        if (!cache.read(name, key_of(vert, frag), entry))
+            return 0;
+
+        auto program = glCreateProgram();
+        programBinary(program, entry.format, entry.data.data(), static_cast<GLsizei>(entry.data.size()));
+
+        GLint status = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &status);
+        if (!status) {
+            // Drivers may refuse binaries from an older build of themselves
+            glDeleteProgram(program);
+            GLStateCache::get().program_deleted(program);
+            cache.remove(name);
+            return 0;
+        }
+
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count();
+        cache.record_hit(entry, static_cast<u32>(elapsed));
+
+        auto saved = cache.get_time_saved();
+        SC_CORE_INFO("Loaded program {} from the shader cache, {:.1f} ms saved in total", name, saved);
+        return program;
+    }
+
+    auto GLProgramCache::store(const std::string &vert, const std::string &frag, GLuint program, u32 buildMicros) -> void {
+        if (!supported())
+            return;
+
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0)
+            return;
+
+        ShaderCacheEntry entry;
+        entry.buildMicros = buildMicros;
+        entry.data.resize(length);
+
+        GLenum format = 0;
+        GLsizei written = 0;
+        getProgramBinary(program, length, &written, &format, entry.data.data());
+        if (written <= 0)
+            return;
+
+        entry.format = format;
+        entry.data.resize(written);
+        ShaderCache::get().write(name_of(vert, frag), key_of(vert, frag), entry);
+    }
+}
+#endif
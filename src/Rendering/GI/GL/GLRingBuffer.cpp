@@ -0,0 +1,113 @@
+#include <Rendering/GI/GL/GLRingBuffer.hpp>
+#if BUILD_PLAT == BUILD_WINDOWS || BUILD_PLAT == BUILD_POSIX
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+#include <cstring>
+
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+namespace GI::detail {
+    // glad is generated for GL 4.0 core, so GL 4.4 storage is loaded by hand
+    typedef void(APIENTRYP PFNGLBUFFERSTORAGEPROC)(GLenum target, GLsizeiptr size, const void *data, GLbitfield flags);
+    static PFNGLBUFFERSTORAGEPROC bufferStorage = nullptr;
+    static bool storageChecked = false;
+
+    auto GLRingBuffer::persistent_supported() -> bool {
+        if (!storageChecked) {
+            storageChecked = true;
+            if (glfwExtensionSupported("GL_ARB_buffer_storage"))
+                bufferStorage = (PFNGLBUFFERSTORAGEPROC)glfwGetProcAddress("glBufferStorage");
+        }
+
+        return bufferStorage != nullptr;
+    }
+
+    GLRingBuffer::GLRingBuffer(GLenum target, size_t region_size, u32 region_count)
+        : target(target), id(0), regionSize(region_size), regionCount(region_count),
+          region(0), head(0), serial(0), mapped(nullptr), fences(region_count, nullptr) {
+        auto size = static_cast<GLsizeiptr>(regionSize * regionCount);
+
+        glGenBuffers(1, &id);
+        glBindBuffer(target, id);
+
+        if (persistent_supported()) {
+            const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            bufferStorage(target, size, nullptr, flags);
+            mapped = static_cast<u8 *>(glMapBufferRange(target, 0, size, flags));
+        } else {
+            glBufferData(target, size, nullptr, GL_STREAM_DRAW);
+        }
+    }
+
+    GLRingBuffer::~GLRingBuffer() {
+        for (auto &f : fences) {
+            if (f != nullptr)
+                glDeleteSync(f);
+        }
+
+        if (mapped != nullptr) {
+            glBindBuffer(target, id);
+            glUnmapBuffer(target);
+        }
+        glDeleteBuffers(1, &id);
+    }
+
+    auto GLRingBuffer::next_region() -> void {
+        if (fences[region] != nullptr)
+            glDeleteSync(fences[region]);
+        fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+        region = (region + 1) % regionCount;
+        head = 0;
+        serial++;
+
+        if (fences[region] != nullptr) {
+            GLbitfield flags = 0;
+            GLuint64 timeout = 0;
+            while (true) {
+                auto res = glClientWaitSync(fences[region], flags, timeout);
+                if (res == GL_ALREADY_SIGNALED || res == GL_CONDITION_SATISFIED || res == GL_WAIT_FAILED)
+                    break;
+
+                flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+                timeout = 1000000;
+            }
+
+            glDeleteSync(fences[region]);
+            fences[region] = nullptr;
+        }
+    }
+
+    auto GLRingBuffer::allocate(size_t size, size_t alignment, size_t& offset) -> bool {
+        auto start = (head + alignment - 1) / alignment * alignment;
+        if (start + size > regionSize)
+            return false;
+
+        offset = get_region_offset() + start;
+        head = start + size;
+        return true;
+    }
+
+    auto GLRingBuffer::write(size_t offset, const void* data, size_t size) -> void {
+        if (size == 0)
+            return;
+
+        if (mapped != nullptr) {
+            memcpy(mapped + offset, data, size);
+        } else {
+            glBindBuffer(target, id);
+            auto dst = glMapBufferRange(target, offset, size,
+                                        GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+            if (dst != nullptr) {
+                memcpy(dst, data, size);
+                glUnmapBuffer(target);
+            }
+        }
+    }
+}
+#endif
@@ -0,0 +1,121 @@
+#include <Rendering/GI/GL/GLShaderVariants.hpp>
+#if BUILD_PLAT == BUILD_WINDOWS || BUILD_PLAT == BUILD_POSIX
+#include <Rendering/GI/GL/GLStateCache.hpp>
+#include <Utilities/Logger.hpp>
+#include <cstring>
+
+namespace GI {
+    extern auto loadShaders(const std::string& vs, const std::string& fs) -> GLuint;
+}
+
+namespace GI::detail {
+    static auto with_defines(const std::string &source, const std::string &defines) -> std::string {
+        // #version has to stay the first directive
+        auto version = source.find("#version");
+        auto lineEnd = version == std::string::npos ? 0 : source.find('\n', version);
+        if (lineEnd == std::string::npos)
+            lineEnd = source.size();
+        else if (version != std::string::npos)
+            lineEnd++;
+
+        return source.substr(0, lineEnd) + defines + source.substr(lineEnd);
+    }
+
+    auto GLShaderVariants::init(const std::string &vert, const std::string &frag) -> void {
+        vertSource = vert;
+        fragSource = frag;
+    }
+
+    auto GLShaderVariants::set_fog_color(float r, float g, float b, float a) -> void {
+        if (fogColor[0] == r && fogColor[1] == g && fogColor[2] == b && fogColor[3] == a)
+            return;
+
+        fogColor[0] = r;
+        fogColor[1] = g;
+        fogColor[2] = b;
+        fogColor[3] = a;
+        fogVersion++;
+    }
+
+    auto GLShaderVariants::compile(u32 key) -> Variant {
+        std::string defines;
+        if (key & SHADER_TEXTURED)
+            defines += "#define TEXTURED\n";
+        if (key & SHADER_TEXTURE_ARRAY)
+            defines += "#define TEXTURE_ARRAY\n";
+        if (key & SHADER_SIMPLE_VERTEX)
+            defines += "#define SIMPLE_VERTEX\n";
+        if (key & SHADER_FOG)
+            defines += "#define FOG\n";
+        if (key & SHADER_SRGB_COLORS)
+            defines += "#define SRGB_COLORS\n";
+        if (key & SHADER_ANIMATED)
+            defines += "#define ANIMATED\n";
+
+        // Leaves the new program current
+        Variant variant;
+        variant.program = loadShaders(with_defines(vertSource, defines), with_defines(fragSource, defines));
+        variant.scroll = glGetUniformLocation(variant.program, "scroll");
+        variant.fogColor = glGetUniformLocation(variant.program, "fogColor");
+        variant.fogVersion = 0;
+        variant.time = glGetUniformLocation(variant.program, "time");
+        variant.timeWraps = glGetUniformLocation(variant.program, "timeWraps");
+        variant.animAtlas = glGetUniformLocation(variant.program, "animAtlas");
+        variant.lastAtlas[0] = variant.lastAtlas[1] = variant.lastAtlas[2] = -1.0f;
+
+        auto block = glGetUniformBlockIndex(variant.program, "Matrices");
+        glUniformBlockBinding(variant.program, block, 0);
+
+        // Array textures live on unit 1 so binding one keeps unit 0 intact
+        glUniform1i(glGetUniformLocation(variant.program, "tex"), 0);
+        glUniform1i(glGetUniformLocation(variant.program, "sheets"), 1);
+
+        auto count = variants.size() + 1;
+        SC_CORE_INFO("Compiled shader variant {:#x}, {} in total", key, count);
+        return variant;
+    }
+
+    auto GLShaderVariants::apply() -> GLuint {
+        auto key = features;
+        if (!(key & SHADER_TEXTURED))
+            key &= ~SHADER_TEXTURE_ARRAY;
+
+        auto it = variants.find(key);
+        if (it == variants.end())
+            it = variants.emplace(key, compile(key)).first;
+
+        auto &variant = it->second;
+        auto &cache = GLStateCache::get();
+        cache.use_program(variant.program);
+
+        if (key & SHADER_TEXTURED)
+            cache.uniform1f(variant.scroll, scroll);
+
+        if (key & SHADER_ANIMATED) {
+            cache.uniform1f(variant.time, time);
+            cache.uniform1i(variant.timeWraps, timeWraps);
+
+            // Usually the same atlas draw after draw
+            if (memcmp(variant.lastAtlas, animAtlas, sizeof(animAtlas)) != 0) {
+                glUniform3fv(variant.animAtlas, 1, animAtlas);
+                memcpy(variant.lastAtlas, animAtlas, sizeof(animAtlas));
+            }
+        }
+
+        if ((key & SHADER_FOG) && variant.fogVersion != fogVersion) {
+            glUniform4fv(variant.fogColor, 1, fogColor);
+            variant.fogVersion = fogVersion;
+        }
+
+        return variant.program;
+    }
+
+    auto GLShaderVariants::release() -> void {
+        for (auto &v : variants) {
+            glDeleteProgram(v.second.program);
+            GLStateCache::get().program_deleted(v.second.program);
+        }
+        variants.clear();
+    }
+}
+#endif
@@ -0,0 +1,230 @@
+#include <Rendering/GI/GL/GLStateCache.hpp>
+#include <cstring>
+
+namespace GI {
+    extern FrameStats frameStats;
+}
+
+namespace GI::detail {
+    GLStateCache::GLStateCache() {
+        invalidate();
+    }
+
+    auto GLStateCache::invalidate() -> void {
+        caps.clear();
+        blendKnown = depthKnown = false;
+        blendSrc = blendDest = depthFunc = 0;
+
+#if BUILD_PLAT != BUILD_PSP
+        textureKnown = false;
+        texture = 0;
+#endif
+
+#if BUILD_PC || BUILD_PLAT == BUILD_VITA
+        programKnown = false;
+        program = 0;
+        locations.clear();
+        uniforms.clear();
+#endif
+
+#if BUILD_PC
+        vaoKnown = false;
+        vao = 0;
+        arrayKnown = false;
+        textureArray = 0;
+#endif
+    }
+
+    auto GLStateCache::issue() -> void {
+        frameStats.state_changes++;
+    }
+
+    auto GLStateCache::skip() -> void {
+        frameStats.state_skipped++;
+    }
+
+    auto GLStateCache::set_cap(u32 cap, bool enabled) -> void {
+        auto it = caps.find(cap);
+        if (it != caps.end() && it->second == enabled) {
+            skip();
+            return;
+        }
+
+        caps[cap] = enabled;
+        issue();
+
+        if (enabled)
+            glEnable(cap);
+        else
+            glDisable(cap);
+    }
+
+    auto GLStateCache::enable(u32 cap) -> void {
+        set_cap(cap, true);
+    }
+
+    auto GLStateCache::disable(u32 cap) -> void {
+        set_cap(cap, false);
+    }
+
+    auto GLStateCache::blend_func(u32 src, u32 dest) -> void {
+        if (blendKnown && blendSrc == src && blendDest == dest) {
+            skip();
+            return;
+        }
+
+        blendKnown = true;
+        blendSrc = src;
+        blendDest = dest;
+        issue();
+
+#if BUILD_PLAT == BUILD_PSP
+        glBlendFunc(GU_ADD, src, dest, 0, 0);
+#else
+        glBlendFunc(src, dest);
+#endif
+    }
+
+    auto GLStateCache::depth_func(u32 func) -> void {
+        if (depthKnown && depthFunc == func) {
+            skip();
+            return;
+        }
+
+        depthKnown = true;
+        depthFunc = func;
+        issue();
+
+        glDepthFunc(func);
+    }
+
+#if BUILD_PLAT != BUILD_PSP
+    auto GLStateCache::bind_texture(u32 id) -> void {
+        if (textureKnown && texture == id) {
+            skip();
+            return;
+        }
+
+        textureKnown = true;
+        texture = id;
+        issue();
+
+        glBindTexture(GL_TEXTURE_2D, id);
+    }
+
+    auto GLStateCache::texture_deleted(u32 id) -> void {
+        // GL reverts the binding to 0 when the bound texture is deleted
+        if (textureKnown && texture == id)
+            texture = 0;
+#if BUILD_PC
+        if (arrayKnown && textureArray == id)
+            textureArray = 0;
+#endif
+    }
+#endif
+
+#if BUILD_PC || BUILD_PLAT == BUILD_VITA
+    auto GLStateCache::use_program(GLuint prog) -> void {
+        if (programKnown && program == prog) {
+            skip();
+            return;
+        }
+
+        programKnown = true;
+        program = prog;
+        issue();
+
+        glUseProgram(prog);
+    }
+
+    auto GLStateCache::program_deleted(GLuint prog) -> void {
+        locations.erase(prog);
+        for (auto it = uniforms.begin(); it != uniforms.end();) {
+            if ((it->first >> 32) == prog)
+                it = uniforms.erase(it);
+            else
+                ++it;
+        }
+
+        // A new program with this ID must still be bound
+        if (programKnown && program == prog)
+            programKnown = false;
+    }
+
+    auto GLStateCache::uniform_location(const char* name) -> GLint {
+        auto &programLocations = locations[program];
+
+        auto it = programLocations.find(name);
+        if (it != programLocations.end())
+            return it->second;
+
+        auto location = glGetUniformLocation(program, name);
+        programLocations.emplace(name, location);
+        return location;
+    }
+
+    auto GLStateCache::set_uniform(GLint location, u32 bits) -> bool {
+        if (location < 0)
+            return false;
+
+        auto key = (static_cast<u64>(program) << 32) | static_cast<u32>(location);
+        auto it = uniforms.find(key);
+        if (it != uniforms.end() && it->second == bits) {
+            skip();
+            return false;
+        }
+
+        uniforms[key] = bits;
+        issue();
+        return true;
+    }
+
+    auto GLStateCache::uniform1i(GLint location, int value) -> void {
+        if (set_uniform(location, static_cast<u32>(value)))
+            glUniform1i(location, value);
+    }
+
+    auto GLStateCache::uniform1f(GLint location, float value) -> void {
+        u32 bits;
+        memcpy(&bits, &value, sizeof(bits));
+
+        if (set_uniform(location, bits))
+            glUniform1f(location, value);
+    }
+#endif
+
+#if BUILD_PC
+    auto GLStateCache::bind_vertex_array(GLuint id) -> void {
+        if (vaoKnown && vao == id) {
+            skip();
+            return;
+        }
+
+        vaoKnown = true;
+        vao = id;
+        issue();
+
+        glBindVertexArray(id);
+    }
+
+    auto GLStateCache::bind_texture_array(u32 id) -> void {
+        if (arrayKnown && textureArray == id) {
+            skip();
+            return;
+        }
+
+        arrayKnown = true;
+        textureArray = id;
+        issue();
+
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, id);
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    auto GLStateCache::vertex_array_deleted(GLuint id) -> void {
+        if (vaoKnown && vao == id)
+            vao = 0;
+    }
+#endif
+}
@@ -1,40 +1,80 @@
 #include <Rendering/GI/GL/GLTextureHandle.hpp>
 #include <Rendering/GI.hpp>
-#include <stb_image.hpp>
+#include <Rendering/GI/GL/GLPixelTransfer.hpp>
+#include <Rendering/GI/GL/GLShaderVariants.hpp>
+#include <Rendering/GI/GL/GLStateCache.hpp>
+#include <Rendering/ImageDecoder.hpp>
+#include <algorithm>
+#include <cstring>
+
+#if BUILD_PC
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT 0x8C4D
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+#endif
 
 namespace GI::detail {
+#if BUILD_PC
+    static auto has_extension(const char* name) -> bool {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+
+        for (GLint i = 0; i < count; i++) {
+            auto ext = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+            if (ext != nullptr && strcmp(ext, name) == 0)
+                return true;
+        }
+        return false;
+    }
+#endif
 
     void GLTextureHandle::bind() {
 #ifndef PSP
         GI::enable(GI_TEXTURE_2D);
-        glBindTexture(GL_TEXTURE_2D, id);
+#if BUILD_PC
+        auto &cache = GLStateCache::get();
+        if (array)
+            cache.bind_texture_array(id);
+        else
+            cache.bind_texture(id);
+        GLShaderVariants::get().set_feature(SHADER_TEXTURE_ARRAY, array);
+#else
+        GLStateCache::get().bind_texture(id);
+#endif
 #endif
     }
 
 
-    GLTextureHandle* GLTextureHandle::create_ram(uint8_t* buf, size_t len, u32 magFilter, u32 minFilter, bool repeat, bool flip) {
+    GLTextureHandle* GLTextureHandle::create_pixels(const uint8_t* pixels, u32 width, u32 height, u32 magFilter, u32 minFilter, bool repeat) {
 #ifndef PSP
         GLTextureHandle* tex = new GLTextureHandle();
 
-        int texWidth, texHeight, texChannels;
-        stbi_set_flip_vertically_on_load(flip);
-        stbi_uc* data = stbi_load_from_memory(buf, len, &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-
         glGenTextures(1, (GLuint *)&tex->id);
-        glBindTexture(GL_TEXTURE_2D, tex->id);
+        GLStateCache::get().bind_texture(tex->id);
 
 #if BUILD_PC
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_SRGB_ALPHA, texWidth, texHeight, 0, GL_RGBA,
-                     GL_UNSIGNED_BYTE, data);
+        // Large images go through a pixel buffer, so the driver copies them
+        // to the GPU in the background instead of blocking here
+        const void* source = pixels;
+        auto &transfer = GLPixelTransfer::get();
+        auto staged = transfer.begin_upload(pixels, (size_t)width * height * 4, source);
+
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_SRGB_ALPHA, width, height, 0, GL_RGBA,
+                     GL_UNSIGNED_BYTE, source);
+
+        if (staged)
+            transfer.end_upload();
 #else
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, texWidth, texHeight, 0, GL_RGBA,
-                     GL_UNSIGNED_BYTE, data);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA,
+                     GL_UNSIGNED_BYTE, pixels);
 #endif
 
 #if BUILD_PLAT != BUILD_3DS
-        glGenerateMipmap(GL_TEXTURE_2D);
+        // Nearest / linear sampling never reads the other levels
+        if (minFilter != GL_NEAREST && minFilter != GL_LINEAR)
+            glGenerateMipmap(GL_TEXTURE_2D);
 #endif
-        stbi_image_free(data);
 
         if (repeat) {
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
@@ -48,33 +88,37 @@ namespace GI::detail {
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter);
 
         return tex;
+#else
+        return nullptr;
 #endif
     }
 
-
-    GLTextureHandle* GLTextureHandle::create(std::string filename, u32 magFilter, u32 minFilter, bool repeat, bool flip) {
+    GLTextureHandle* GLTextureHandle::create_mipchain(const uint8_t* pixels, u32 width, u32 height, u32 levels, u32 magFilter, u32 minFilter, bool repeat) {
 #ifndef PSP
-        GLTextureHandle* tex = new GLTextureHandle();
+        if (levels <= 1)
+            return create_pixels(pixels, width, height, magFilter, minFilter, repeat);
 
-        int texWidth, texHeight, texChannels;
-        stbi_set_flip_vertically_on_load(flip);
-        stbi_uc* data = stbi_load(filename.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+        GLTextureHandle* tex = new GLTextureHandle();
 
         glGenTextures(1, (GLuint *)&tex->id);
-        glBindTexture(GL_TEXTURE_2D, tex->id);
+        GLStateCache::get().bind_texture(tex->id);
 
+        for (u32 level = 0; level < levels; level++) {
+            auto w = std::max(width >> level, 1u);
+            auto h = std::max(height >> level, 1u);
 #if BUILD_PC
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_SRGB_ALPHA, texWidth, texHeight, 0, GL_RGBA,
-                     GL_UNSIGNED_BYTE, data);
+            glTexImage2D(GL_TEXTURE_2D, level, GL_SRGB_ALPHA, w, h, 0, GL_RGBA,
+                         GL_UNSIGNED_BYTE, pixels);
 #else
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, texWidth, texHeight, 0, GL_RGBA,
-                     GL_UNSIGNED_BYTE, data);
+            glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, w, h, 0, GL_RGBA,
+                         GL_UNSIGNED_BYTE, pixels);
 #endif
+            pixels += w * h * 4;
+        }
 
-#if BUILD_PLAT != BUILD_3DS
-        glGenerateMipmap(GL_TEXTURE_2D);
+#ifdef GL_TEXTURE_MAX_LEVEL
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
 #endif
-        stbi_image_free(data);
 
         if (repeat) {
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
@@ -88,11 +132,125 @@ namespace GI::detail {
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter);
 
         return tex;
+#else
+        return nullptr;
+#endif
+    }
+
+    u32 GLTextureHandle::compressed_internal_format(GI::CompressedFormat format) {
+#if BUILD_PC
+        // Desktop textures are sRGB, so the sRGB variants are needed too
+        static const bool s3tc = has_extension("GL_EXT_texture_compression_s3tc") &&
+                                 (has_extension("GL_EXT_texture_sRGB") ||
+                                  has_extension("GL_EXT_texture_compression_s3tc_srgb"));
+        if (!s3tc)
+            return 0;
+
+        return format == GI_COMPRESSED_BC1 ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT
+                                           : GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+#elif BUILD_PLAT == BUILD_VITA && defined(GL_COMPRESSED_RGBA_S3TC_DXT5_EXT)
+        return format == GI_COMPRESSED_BC1 ? GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+                                           : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+#else
+        return 0;
 #endif
     }
 
+    GLTextureHandle* GLTextureHandle::create_compressed(const uint8_t* data, GI::CompressedFormat format, u32 width, u32 height, u32 levels, u32 magFilter, u32 minFilter, bool repeat) {
+#ifndef PSP
+        auto internalFormat = compressed_internal_format(format);
+        if (internalFormat == 0)
+            return nullptr;
+
+        auto blockBytes = format == GI_COMPRESSED_BC1 ? 8u : 16u;
+
+        GLTextureHandle* tex = new GLTextureHandle();
+
+        glGenTextures(1, (GLuint *)&tex->id);
+        GLStateCache::get().bind_texture(tex->id);
+
+        for (u32 level = 0; level < levels; level++) {
+            auto w = std::max(width >> level, 1u);
+            auto h = std::max(height >> level, 1u);
+            auto size = ((w + 3) / 4) * ((h + 3) / 4) * blockBytes;
+
+            glCompressedTexImage2D(GL_TEXTURE_2D, level, internalFormat, w, h, 0,
+                                   size, data);
+            data += size;
+        }
+
+        // Compressed levels cannot be generated, so sampling stops at the
+        // last one stored
+#ifdef GL_TEXTURE_MAX_LEVEL
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+#endif
+
+        if (repeat) {
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        } else {
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        }
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, magFilter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter);
+
+        return tex;
+#else
+        return nullptr;
+#endif
+    }
+
+    GLTextureHandle* GLTextureHandle::create_array(const uint8_t* const* layers, u32 count, u32 width, u32 height, u32 magFilter, u32 minFilter, bool repeat) {
+#if BUILD_PC
+        GLTextureHandle* tex = new GLTextureHandle();
+        tex->array = true;
+
+        glGenTextures(1, (GLuint *)&tex->id);
+        GLStateCache::get().bind_texture_array(tex->id);
+
+        // Parameters apply to the unit the array is bound on
+        glActiveTexture(GL_TEXTURE1);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_SRGB_ALPHA, width, height, count, 0,
+                     GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        for (u32 i = 0; i < count; i++)
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, i, width, height, 1,
+                            GL_RGBA, GL_UNSIGNED_BYTE, layers[i]);
+
+        if (minFilter != GL_NEAREST && minFilter != GL_LINEAR)
+            glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+
+        auto wrap = repeat ? GL_REPEAT : GL_CLAMP_TO_EDGE;
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, wrap);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, wrap);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, magFilter);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, minFilter);
+        glActiveTexture(GL_TEXTURE0);
+
+        return tex;
+#else
+        return nullptr;
+#endif
+    }
+
+    GLTextureHandle* GLTextureHandle::create_ram(uint8_t* buf, size_t len, u32 magFilter, u32 minFilter, bool repeat, bool flip) {
+        auto image = Stardust_Celeste::Rendering::decode_image_memory(buf, len, flip);
+        auto tex = create_pixels(image.pixels, image.width, image.height, magFilter, minFilter, repeat);
+        Stardust_Celeste::Rendering::free_image(image);
+        return tex;
+    }
+
+    GLTextureHandle* GLTextureHandle::create(std::string filename, u32 magFilter, u32 minFilter, bool repeat, bool flip) {
+        auto image = Stardust_Celeste::Rendering::decode_image(filename, flip);
+        auto tex = create_pixels(image.pixels, image.width, image.height, magFilter, minFilter, repeat);
+        Stardust_Celeste::Rendering::free_image(image);
+        return tex;
+    }
+
     void GLTextureHandle::destroy() {
 #ifndef PSP
+        GLStateCache::get().texture_deleted(id);
         glDeleteTextures(1, &id);
 #endif
     }
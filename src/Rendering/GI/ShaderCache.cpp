@@ -0,0 +1,112 @@
+#include <Rendering/GI/ShaderCache.hpp>
+#if BUILD_PLAT == BUILD_WINDOWS || BUILD_PLAT == BUILD_POSIX
+#include <Utilities/Logger.hpp>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+namespace GI::detail {
+    constexpr char SHADER_CACHE_MAGIC[4] = {'S', 'C', 'S', 'C'};
+    constexpr u16 SHADER_CACHE_VERSION = 1;
+
+    struct ShaderCacheHeader {
+        char magic[4];
+        u16 version;
+        u16 reserved;
+        u32 format;
+        u32 buildMicros;
+        u64 key;
+        u32 dataSize;
+        u32 padding;
+    };
+
+    static_assert(sizeof(ShaderCacheHeader) == 32,
+                  "ShaderCacheHeader must not be padded");
+
+    auto ShaderCache::hash(const void* data, size_t size, u64 seed) -> u64 {
+        auto bytes = static_cast<const u8*>(data);
+        for (size_t i = 0; i < size; i++) {
+            seed ^= bytes[i];
+            seed *= 0x100000001b3ull;
+        }
+        return seed;
+    }
+
+    auto ShaderCache::set_directory(const char* path) -> void {
+        directory = path != nullptr ? path : "";
+    }
+
+    auto ShaderCache::path_of(const std::string &name) const -> std::string {
+        return directory + "/" + name + ".bin";
+    }
+
+    auto ShaderCache::read(const std::string &name, u64 key, ShaderCacheEntry &entry) -> bool {
+        if (!enabled())
+            return false;
+
+        auto file = fopen(path_of(name).c_str(), "rb");
+        if (file == nullptr)
+            return false;
+
+        ShaderCacheHeader header;
+        bool valid = fread(&header, sizeof(header), 1, file) == 1 &&
+                     memcmp(header.magic, SHADER_CACHE_MAGIC, 4) == 0 &&
+                     header.version == SHADER_CACHE_VERSION && header.key == key;
+
+        if (valid) {
+            entry.format = header.format;
+            entry.buildMicros = header.buildMicros;
+            entry.data.resize(header.dataSize);
+            valid = header.dataSize == 0 ||
+                    fread(entry.data.data(), header.dataSize, 1, file) == 1;
+        }
+
+        fclose(file);
+        return valid;
+    }
+
+    auto ShaderCache::write(const std::string &name, u64 key, const ShaderCacheEntry &entry) -> bool {
+        if (!enabled())
+            return false;
+
+        std::error_code ec;
+        std::filesystem::create_directories(directory, ec);
+
+        auto path = path_of(name);
+        auto file = fopen(path.c_str(), "wb");
+        if (file == nullptr) {
+            SC_CORE_WARN("Cannot write shader cache entry {}", path);
+            return false;
+        }
+
+        ShaderCacheHeader header{};
+        memcpy(header.magic, SHADER_CACHE_MAGIC, 4);
+        header.version = SHADER_CACHE_VERSION;
+        header.format = entry.format;
+        header.buildMicros = entry.buildMicros;
+        header.key = key;
+        header.dataSize = static_cast<u32>(entry.data.size());
+
+        bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                  (entry.data.empty() ||
+                   fwrite(entry.data.data(), entry.data.size(), 1, file) == 1);
+        fclose(file);
+
+        // A partial entry would only be rejected on every launch
+        if (!ok)
+            remove(name);
+        return ok;
+    }
+
+    auto ShaderCache::remove(const std::string &name) -> void {
+        if (enabled())
+            std::remove(path_of(name).c_str());
+    }
+
+    auto ShaderCache::record_hit(const ShaderCacheEntry &entry, u32 loadMicros) -> void {
+        hits++;
+        if (entry.buildMicros > loadMicros)
+            savedMicros += entry.buildMicros - loadMicros;
+    }
+}
+#endif
@@ -3,7 +3,8 @@
 #include "Rendering/GI/VK/VkUtil.hpp"
 
 namespace GI::detail {
-    VKBufferObject* VKBufferObject::create(const Stardust_Celeste::Rendering::Vertex* vert_data, size_t vert_size, const uint16_t* indices, size_t idx_size) {
+    template <class I>
+    VKBufferObject* VKBufferObject::create_buffer(const Stardust_Celeste::Rendering::Vertex* vert_data, size_t vert_size, const I* indices, size_t idx_size) {
         if(idx_size == 0 || vert_size == 0)
             return nullptr;
 
@@ -29,7 +30,7 @@ namespace GI::detail {
             vkFreeMemory(VKContext::get().logicalDevice, stagingBufferMemory, nullptr);
         }
         {
-            VkDeviceSize bufferSize = sizeof(uint16_t) * idx_size;
+            VkDeviceSize bufferSize = sizeof(I) * idx_size;
 
             VkBuffer stagingBuffer;
             VkDeviceMemory stagingBufferMemory;
@@ -48,12 +49,25 @@ namespace GI::detail {
             vkFreeMemory(VKContext::get().logicalDevice, stagingBufferMemory, nullptr);
         }
 
+        vbo->vtx_count = vert_size;
         vbo->idx_count = idx_size;
+        vbo->idx_type = sizeof(I) == sizeof(uint32_t) ? VK_INDEX_TYPE_UINT32 : VK_INDEX_TYPE_UINT16;
         vbo->setup = true;
         return vbo;
     }
-    void VKBufferObject::update(const Stardust_Celeste::Rendering::Vertex* vert_data, size_t vert_size, const uint16_t* indices, size_t idx_size) {
-        if(setup) {
+
+    VKBufferObject* VKBufferObject::create(const Stardust_Celeste::Rendering::Vertex* vert_data, size_t vert_size, const uint16_t* indices, size_t idx_size) {
+        return create_buffer(vert_data, vert_size, indices, idx_size);
+    }
+
+    VKBufferObject* VKBufferObject::create(const Stardust_Celeste::Rendering::Vertex* vert_data, size_t vert_size, const uint32_t* indices, size_t idx_size) {
+        return create_buffer(vert_data, vert_size, indices, idx_size);
+    }
+
+    template <class I>
+    void VKBufferObject::store(const Stardust_Celeste::Rendering::Vertex* vert_data, size_t vert_size, const I* indices, size_t idx_size) {
+        // The index buffer was sized for the type it was created with
+        if(setup && sizeof(I) == index_size()) {
             {
                 VkDeviceSize bufferSize = sizeof(Stardust_Celeste::Rendering::Vertex) * vert_size;
 
@@ -72,7 +86,7 @@ namespace GI::detail {
                 vkFreeMemory(VKContext::get().logicalDevice, stagingBufferMemory, nullptr);
             }
             {
-                VkDeviceSize bufferSize = sizeof(uint16_t) * idx_size;
+                VkDeviceSize bufferSize = sizeof(I) * idx_size;
 
                 VkBuffer stagingBuffer;
                 VkDeviceMemory stagingBufferMemory;
@@ -89,28 +103,103 @@ namespace GI::detail {
                 vkFreeMemory(VKContext::get().logicalDevice, stagingBufferMemory, nullptr);
             }
 
+            vtx_count = vert_size;
             idx_count = idx_size;
         }
     }
 
+    void VKBufferObject::update(const Stardust_Celeste::Rendering::Vertex* vert_data, size_t vert_size, const uint16_t* indices, size_t idx_size) {
+        store(vert_data, vert_size, indices, idx_size);
+    }
+
+    void VKBufferObject::update(const Stardust_Celeste::Rendering::Vertex* vert_data, size_t vert_size, const uint32_t* indices, size_t idx_size) {
+        store(vert_data, vert_size, indices, idx_size);
+    }
+
+    static void upload_range(VkBuffer dst, const void* src, VkDeviceSize offset, VkDeviceSize size) {
+        VkBuffer stagingBuffer;
+        VkDeviceMemory stagingBufferMemory;
+        createBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+
+        void *data;
+        vkMapMemory(VKContext::get().logicalDevice, stagingBufferMemory, 0, size, 0, &data);
+        memcpy(data, src, (size_t) size);
+        vkUnmapMemory(VKContext::get().logicalDevice, stagingBufferMemory);
+
+        copyBuffer(stagingBuffer, dst, size, offset);
+
+        vkDestroyBuffer(VKContext::get().logicalDevice, stagingBuffer, nullptr);
+        vkFreeMemory(VKContext::get().logicalDevice, stagingBufferMemory, nullptr);
+    }
+
+    template <class I>
+    void VKBufferObject::store_range(const Stardust_Celeste::Rendering::Vertex* vert_data, size_t vert_offset, size_t vert_count, const I* indices, size_t idx_offset, size_t count) {
+        if(!setup || vert_offset + vert_count > vtx_count || idx_offset + count > idx_count || sizeof(I) != index_size())
+            return;
+
+        const auto stride = sizeof(Stardust_Celeste::Rendering::Vertex);
+        if(vert_count > 0)
+            upload_range(vertexBuffer, vert_data + vert_offset, stride * vert_offset, stride * vert_count);
+        if(count > 0)
+            upload_range(indexBuffer, indices + idx_offset, sizeof(I) * idx_offset, sizeof(I) * count);
+    }
+
+    void VKBufferObject::update_range(const Stardust_Celeste::Rendering::Vertex* vert_data, size_t vert_offset, size_t vert_count, const uint16_t* indices, size_t idx_offset, size_t count) {
+        store_range(vert_data, vert_offset, vert_count, indices, idx_offset, count);
+    }
+
+    void VKBufferObject::update_range(const Stardust_Celeste::Rendering::Vertex* vert_data, size_t vert_offset, size_t vert_count, const uint32_t* indices, size_t idx_offset, size_t count) {
+        store_range(vert_data, vert_offset, vert_count, indices, idx_offset, count);
+    }
+
     void VKBufferObject::draw(PrimType p) {
-        if(setup) {
+        draw_range(p, 0, idx_count);
+    }
+
+    void VKBufferObject::draw_range(PrimType p, size_t idx_offset, size_t count) {
+        if(setup && count > 0 && idx_offset + count <= idx_count) {
             VKPipeline::get().updateUniformBuffer();
 
             auto buf = VKPipeline::get().commandBuffer;
             vkCmdBindDescriptorSets(buf, VK_PIPELINE_BIND_POINT_GRAPHICS, VKPipeline::get().pipelineLayout, 0, 1, &VKPipeline::get().descriptorSet, 0, nullptr);
-            vkCmdDrawIndexed(buf, static_cast<uint32_t>(idx_count), 1, 0, 0, 0);
+            vkCmdDrawIndexed(buf, static_cast<uint32_t>(count), 1, static_cast<uint32_t>(idx_offset), 0, 0);
         }
     }
 
+    bool VKBufferObject::draw_instanced(PrimType p, const InstanceData* instances, size_t count) {
+        if(!setup || count == 0)
+            return true;
+
+        // Shaders that ignore the instance attributes would stack every
+        // instance at the identity transform
+        if(!VKPipeline::get().instancedShader)
+            return false;
+
+        VkDeviceSize offset;
+        if(!VKPipeline::get().allocateInstances(instances, count, offset))
+            return false;
+
+        VKPipeline::get().updateUniformBuffer();
+
+        auto buf = VKPipeline::get().commandBuffer;
+        vkCmdBindVertexBuffers(buf, 1, 1, &VKPipeline::get().instanceBuffer, &offset);
+        vkCmdBindDescriptorSets(buf, VK_PIPELINE_BIND_POINT_GRAPHICS, VKPipeline::get().pipelineLayout, 0, 1, &VKPipeline::get().descriptorSet, 0, nullptr);
+        vkCmdDrawIndexed(buf, static_cast<uint32_t>(idx_count), static_cast<uint32_t>(count), 0, 0, 0);
+
+        // Back to the identity instance for plain draws
+        VkDeviceSize identity = 0;
+        vkCmdBindVertexBuffers(buf, 1, 1, &VKPipeline::get().instanceBuffer, &identity);
+        return true;
+    }
+
     void VKBufferObject::bind() {
         if(setup) {
-            VkBuffer vertexBuffers[] = {vertexBuffer};
-            VkDeviceSize offsets[] = {0};
+            VkBuffer vertexBuffers[] = {vertexBuffer, VKPipeline::get().instanceBuffer};
+            VkDeviceSize offsets[] = {0, 0};
 
             auto buf = VKPipeline::get().commandBuffer;
-            vkCmdBindVertexBuffers(buf, 0, 1, vertexBuffers, offsets);
-            vkCmdBindIndexBuffer(buf, indexBuffer, 0, VK_INDEX_TYPE_UINT16);
+            vkCmdBindVertexBuffers(buf, 0, 2, vertexBuffers, offsets);
+            vkCmdBindIndexBuffer(buf, indexBuffer, 0, idx_type);
         }
     }
 
@@ -1,6 +1,12 @@
 #ifndef NO_EXPERIMENTAL_GRAPHICS
 
 #include "Rendering/GI/VK/VkUtil.hpp"
+#include <Rendering/GI/ShaderCache.hpp>
+#include <Utilities/Logger.hpp>
+#include <chrono>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
 
 #include <glm.hpp>
 #include <ext/matrix_transform.hpp>
@@ -105,9 +111,103 @@ namespace GI::detail {
     }
 
 
+    constexpr const char* PIPELINE_CACHE_NAME = "vk_pipeline";
+
+    auto create_pipeline_cache(const std::vector<char>& vertCode, const std::vector<char>& fragCode, ShaderCacheEntry& entry) -> bool {
+        VkPhysicalDeviceProperties props;
+        vkGetPhysicalDeviceProperties(VKContext::get().physicalDevice, &props);
+
+        // The driver validates its own header, the key also covers the shaders
+        auto key = ShaderCache::hash(&props.vendorID, sizeof(props.vendorID));
+        key = ShaderCache::hash(&props.deviceID, sizeof(props.deviceID), key);
+        key = ShaderCache::hash(&props.driverVersion, sizeof(props.driverVersion), key);
+        key = ShaderCache::hash(props.pipelineCacheUUID, VK_UUID_SIZE, key);
+        key = ShaderCache::hash(vertCode.data(), vertCode.size(), key);
+        key = ShaderCache::hash(fragCode.data(), fragCode.size(), key);
+        VKPipeline::get().pipelineCacheKey = key;
+
+        auto hit = ShaderCache::get().read(PIPELINE_CACHE_NAME, key, entry);
+
+        VkPipelineCacheCreateInfo cacheInfo{};
+        cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+        cacheInfo.initialDataSize = hit ? entry.data.size() : 0;
+        cacheInfo.pInitialData = hit ? entry.data.data() : nullptr;
+
+        if (vkCreatePipelineCache(VKContext::get().logicalDevice, &cacheInfo, nullptr, &VKPipeline::get().pipelineCache) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create pipeline cache!");
+        }
+
+        return hit;
+    }
+
+    void save_pipeline_cache() {
+        auto& pipeline = VKPipeline::get();
+        auto device = VKContext::get().logicalDevice;
+
+        size_t size = 0;
+        if (vkGetPipelineCacheData(device, pipeline.pipelineCache, &size, nullptr) == VK_SUCCESS && size > 0) {
+            ShaderCacheEntry entry;
+            entry.buildMicros = pipeline.pipelineBuildMicros;
+            entry.data.resize(size);
+
+            if (vkGetPipelineCacheData(device, pipeline.pipelineCache, &size, entry.data.data()) == VK_SUCCESS) {
+                entry.data.resize(size);
+                ShaderCache::get().write(PIPELINE_CACHE_NAME, pipeline.pipelineCacheKey, entry);
+            }
+        }
+
+        vkDestroyPipelineCache(device, pipeline.pipelineCache, nullptr);
+    }
+
+    /**
+     * Whether a SPIR-V module declares Input variables at every instance
+     * attribute location (3 to 6)
+     */
+    auto reads_instance_attributes(const std::vector<char>& code) -> bool {
+        constexpr u32 SPIRV_MAGIC = 0x07230203;
+        constexpr u32 OP_DECORATE = 71, OP_VARIABLE = 59;
+        constexpr u32 DECORATION_LOCATION = 30, STORAGE_CLASS_INPUT = 1;
+
+        auto count = code.size() / sizeof(u32);
+        if (count < 5)
+            return false;
+
+        std::vector<u32> words(count);
+        memcpy(words.data(), code.data(), count * sizeof(u32));
+        if (words[0] != SPIRV_MAGIC)
+            return false;
+
+        std::unordered_map<u32, u32> locations;
+        std::unordered_set<u32> inputs;
+        for (size_t i = 5; i < count;) {
+            auto length = words[i] >> 16;
+            auto opcode = words[i] & 0xFFFF;
+            if (length == 0 || i + length > count)
+                return false;
+
+            if (opcode == OP_DECORATE && length >= 4 && words[i + 2] == DECORATION_LOCATION)
+                locations[words[i + 1]] = words[i + 3];
+            else if (opcode == OP_VARIABLE && length >= 4 && words[i + 3] == STORAGE_CLASS_INPUT)
+                inputs.insert(words[i + 2]);
+
+            i += length;
+        }
+
+        u32 found = 0;
+        for (auto& l : locations) {
+            if (l.second >= 3 && l.second <= 6 && inputs.count(l.first))
+                found |= 1u << l.second;
+        }
+        return found == 0b1111000;
+    }
+
     void create_graphics_pipeline() {
         auto vertShaderCode = readFile("shaders/vert.spv");
         auto fragShaderCode = readFile("shaders/frag.spv");
+        VKPipeline::get().instancedShader = reads_instance_attributes(vertShaderCode);
+
+        ShaderCacheEntry cached;
+        auto hit = create_pipeline_cache(vertShaderCode, fragShaderCode, cached);
 
         VkShaderModule vertShaderModule = create_shader_module(vertShaderCode);
         VkShaderModule fragShaderModule = create_shader_module(fragShaderCode);
@@ -127,12 +227,16 @@ namespace GI::detail {
         VkPipelineShaderStageCreateInfo shaderStages[] = {vertShaderStageInfo, fragShaderStageInfo};
 
 
-        VkVertexInputBindingDescription bindingDescription{};
-        bindingDescription.binding = 0;
-        bindingDescription.stride = sizeof(Vertex);
-        bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+        std::array<VkVertexInputBindingDescription, 2> bindingDescriptions{};
+        bindingDescriptions[0].binding = 0;
+        bindingDescriptions[0].stride = sizeof(Vertex);
+        bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
 
-        std::array<VkVertexInputAttributeDescription, 3> attributeDescriptions{};
+        bindingDescriptions[1].binding = 1;
+        bindingDescriptions[1].stride = sizeof(InstanceData);
+        bindingDescriptions[1].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
+        std::array<VkVertexInputAttributeDescription, 7> attributeDescriptions{};
         attributeDescriptions[0].binding = 0;
         attributeDescriptions[0].location = 0;
         attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
@@ -148,12 +252,32 @@ namespace GI::detail {
         attributeDescriptions[2].format = VK_FORMAT_R32G32_SFLOAT;
         attributeDescriptions[2].offset = offsetof(Vertex, u);
 
+        attributeDescriptions[3].binding = 1;
+        attributeDescriptions[3].location = 3;
+        attributeDescriptions[3].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+        attributeDescriptions[3].offset = offsetof(InstanceData, a);
+
+        attributeDescriptions[4].binding = 1;
+        attributeDescriptions[4].location = 4;
+        attributeDescriptions[4].format = VK_FORMAT_R32G32B32_SFLOAT;
+        attributeDescriptions[4].offset = offsetof(InstanceData, x);
+
+        attributeDescriptions[5].binding = 1;
+        attributeDescriptions[5].location = 5;
+        attributeDescriptions[5].format = VK_FORMAT_R8G8B8A8_UNORM;
+        attributeDescriptions[5].offset = offsetof(InstanceData, color);
+
+        attributeDescriptions[6].binding = 1;
+        attributeDescriptions[6].location = 6;
+        attributeDescriptions[6].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+        attributeDescriptions[6].offset = offsetof(InstanceData, u);
+
 
         VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
         vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-        vertexInputInfo.vertexBindingDescriptionCount = 1;
+        vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(bindingDescriptions.size());
         vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
-        vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
+        vertexInputInfo.pVertexBindingDescriptions = bindingDescriptions.data();
         vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
 
         VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
@@ -280,9 +404,23 @@ namespace GI::detail {
         pipelineInfo.basePipelineHandle = VK_NULL_HANDLE; // Optional
         pipelineInfo.basePipelineIndex = -1; // Optional
 
-        if (vkCreateGraphicsPipelines(VKContext::get().logicalDevice, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &VKPipeline::get().graphicsPipeline) != VK_SUCCESS) {
+        auto start = std::chrono::steady_clock::now();
+        if (vkCreateGraphicsPipelines(VKContext::get().logicalDevice, VKPipeline::get().pipelineCache, 1, &pipelineInfo, nullptr, &VKPipeline::get().graphicsPipeline) != VK_SUCCESS) {
             throw std::runtime_error("Failed to create graphics pipeline!");
         }
+        auto elapsed = static_cast<u32>(std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count());
+
+        // Keep the cold build time so later hits can report what they saved
+        if (hit) {
+            ShaderCache::get().record_hit(cached, elapsed);
+            VKPipeline::get().pipelineBuildMicros = cached.buildMicros;
+
+            auto saved = ShaderCache::get().get_time_saved();
+            SC_CORE_INFO("Created pipeline from the shader cache, {:.1f} ms saved", saved);
+        } else {
+            VKPipeline::get().pipelineBuildMicros = elapsed;
+        }
 
         vkDestroyShaderModule(VKContext::get().logicalDevice, fragShaderModule, nullptr);
         vkDestroyShaderModule(VKContext::get().logicalDevice, vertShaderModule, nullptr);
@@ -391,6 +529,30 @@ namespace GI::detail {
         vkMapMemory(VKContext::get().logicalDevice, VKPipeline::get().uniformBufferMemory, 0, bufferSize, 0, &VKPipeline::get().uniformBufferMapped);
     }
 
+    void createInstanceBuffer() {
+        auto &pipeline = VKPipeline::get();
+        VkDeviceSize bufferSize = sizeof(InstanceData) * MAX_INSTANCES_PER_FRAME;
+
+        createBuffer(bufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, pipeline.instanceBuffer, pipeline.instanceBufferMemory);
+
+        vkMapMemory(VKContext::get().logicalDevice, pipeline.instanceBufferMemory, 0, bufferSize, 0, &pipeline.instanceBufferMapped);
+
+        // Slot 0 is the identity instance used by non-instanced draws
+        InstanceData identity{};
+        memcpy(pipeline.instanceBufferMapped, &identity, sizeof(InstanceData));
+        pipeline.instanceHead = 1;
+    }
+
+    auto VKPipeline::allocateInstances(const InstanceData* instances, size_t count, VkDeviceSize& offset) -> bool {
+        if (instanceHead + count > MAX_INSTANCES_PER_FRAME)
+            return false;
+
+        offset = sizeof(InstanceData) * instanceHead;
+        memcpy(static_cast<u8*>(instanceBufferMapped) + offset, instances, sizeof(InstanceData) * count);
+        instanceHead += count;
+        return true;
+    }
+
     void VKPipeline::updateDescriptorSet() {
         VkDescriptorBufferInfo bufferInfo{};
         bufferInfo.buffer = VKPipeline::get().uniformBuffer;
@@ -444,6 +606,7 @@ namespace GI::detail {
 
         createDescriptorPool();
         createDescriptorSets();
+        createInstanceBuffer();
     }
     void VKPipeline::deinit() {
         vkDestroySemaphore(VKContext::get().logicalDevice, renderFinishedSemaphores, nullptr);
@@ -452,6 +615,10 @@ namespace GI::detail {
 
         vkFreeMemory(VKContext::get().logicalDevice, uniformBufferMemory, nullptr);
 
+        vkUnmapMemory(VKContext::get().logicalDevice, instanceBufferMemory);
+        vkDestroyBuffer(VKContext::get().logicalDevice, instanceBuffer, nullptr);
+        vkFreeMemory(VKContext::get().logicalDevice, instanceBufferMemory, nullptr);
+
         vkDestroyDescriptorPool(VKContext::get().logicalDevice, descriptorPool, nullptr);
         vkDestroyCommandPool(VKContext::get().logicalDevice, commandPool, nullptr);
 
@@ -459,6 +626,7 @@ namespace GI::detail {
             vkDestroyFramebuffer(VKContext::get().logicalDevice, framebuffer, nullptr);
         }
 
+        save_pipeline_cache();
         vkDestroyPipeline(VKContext::get().logicalDevice, graphicsPipeline, nullptr);
         vkDestroyPipelineLayout(VKContext::get().logicalDevice, pipelineLayout, nullptr);
         vkDestroyRenderPass(VKContext::get().logicalDevice, renderPass, nullptr);
@@ -472,6 +640,9 @@ namespace GI::detail {
         vkWaitForFences(VKContext::get().logicalDevice, 1, &inFlightFence, VK_TRUE, UINT64_MAX);
         vkResetFences(VKContext::get().logicalDevice, 1, &inFlightFence);
 
+        // The previous frame is done with the instance buffer
+        instanceHead = 1;
+
         vkAcquireNextImageKHR(VKContext::get().logicalDevice, VKContext::get().swapChain, UINT64_MAX, imageAvailableSemaphores, VK_NULL_HANDLE, &imageIndex);
 
         vkResetCommandBuffer(commandBuffer, 0);
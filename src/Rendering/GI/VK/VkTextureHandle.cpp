@@ -2,22 +2,26 @@
 #include <Rendering/GI/VK/VkTextureHandle.hpp>
 #include <Rendering/GI/VK/VkUtil.hpp>
 #include <Rendering/Texture.hpp>
+#include <Rendering/ImageDecoder.hpp>
 
 namespace GI::detail {
     static int handle_number = 0;
 
     VKTextureHandle* VKTextureHandle::create(std::string filename, u32 magFilter, u32 minFilter, bool repeat, bool flip) {
-        VKTextureHandle* tex = new VKTextureHandle();
-
-        int texWidth, texHeight, texChannels;
-        stbi_set_flip_vertically_on_load(flip);
-        stbi_uc* pixels = stbi_load(filename.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-        VkDeviceSize imageSize = texWidth * texHeight * 4;
-
-        if (!pixels) {
+        auto image = Stardust_Celeste::Rendering::decode_image(filename, flip);
+        if (!image.pixels) {
             throw std::runtime_error("failed to load texture image!");
         }
 
+        auto tex = create_pixels(image.pixels, image.width, image.height, magFilter, minFilter, repeat);
+        Stardust_Celeste::Rendering::free_image(image);
+        return tex;
+    }
+
+    VKTextureHandle* VKTextureHandle::create_pixels(const uint8_t* pixels, u32 texWidth, u32 texHeight, u32 magFilter, u32 minFilter, bool repeat) {
+        VKTextureHandle* tex = new VKTextureHandle();
+        VkDeviceSize imageSize = texWidth * texHeight * 4;
+
         VkBuffer stagingBuffer;
         VkDeviceMemory stagingBufferMemory;
         createBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
@@ -27,8 +31,6 @@ namespace GI::detail {
         memcpy(data, pixels, static_cast<size_t>(imageSize));
         vkUnmapMemory(VKContext::get().logicalDevice, stagingBufferMemory);
 
-        stbi_image_free(pixels);
-
         createImage(texWidth, texHeight, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, tex->textureImage, tex->textureImageMemory);
 
         transitionImageLayout(tex->textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
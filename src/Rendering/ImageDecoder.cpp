@@ -0,0 +1,43 @@
+#include <Rendering/ImageDecoder.hpp>
+#include <Rendering/PixelOps.hpp>
+#include <stb_image.hpp>
+
+namespace Stardust_Celeste::Rendering {
+
+static auto finish(stbi_uc *data, int width, int height, bool flip)
+    -> DecodedImage {
+    DecodedImage image;
+    if (data == nullptr)
+        return image;
+
+    image.pixels = data;
+    image.width = static_cast<u32>(width);
+    image.height = static_cast<u32>(height);
+
+    if (flip)
+        PixelOps::flip_vertical(image.pixels, image.width * 4, image.height);
+    return image;
+}
+
+auto decode_image(const std::string &filename, bool flip) -> DecodedImage {
+    int width, height, channels;
+    auto data = stbi_load(filename.c_str(), &width, &height, &channels,
+                          STBI_rgb_alpha);
+    return finish(data, width, height, flip);
+}
+
+auto decode_image_memory(const u8 *buffer, size_t length, bool flip)
+    -> DecodedImage {
+    int width, height, channels;
+    auto data = stbi_load_from_memory(buffer, static_cast<int>(length), &width,
+                                      &height, &channels, STBI_rgb_alpha);
+    return finish(data, width, height, flip);
+}
+
+auto free_image(DecodedImage &image) -> void {
+    if (image.pixels != nullptr)
+        stbi_image_free(image.pixels);
+    image.pixels = nullptr;
+}
+
+} // namespace Stardust_Celeste::Rendering
@@ -0,0 +1,356 @@
+#include <Rendering/PixelOps.hpp>
+#include <algorithm>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SC_PIXELOPS_AVX2 1
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SC_PIXELOPS_SSE2 1
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SC_PIXELOPS_NEON 1
+#endif
+
+namespace Stardust_Celeste::Rendering::PixelOps {
+
+// Every narrowing format is four shifted and masked copies of the RGBA8888
+// word OR'd together, so one kernel serves them all
+template <int S0, u32 M0, int S1, u32 M1, int S2, u32 M2, int S3, u32 M3>
+struct Narrow {
+    static inline auto scalar(u32 v) -> u16 {
+        return static_cast<u16>(((v >> S0) & M0) | ((v >> S1) & M1) |
+                                ((v >> S2) & M2) | ((v >> S3) & M3));
+    }
+
+#if SC_PIXELOPS_AVX2
+    static inline auto lanes(__m256i v) -> __m256i {
+        auto r = _mm256_and_si256(_mm256_srli_epi32(v, S0), _mm256_set1_epi32(M0));
+        r = _mm256_or_si256(r, _mm256_and_si256(_mm256_srli_epi32(v, S1), _mm256_set1_epi32(M1)));
+        r = _mm256_or_si256(r, _mm256_and_si256(_mm256_srli_epi32(v, S2), _mm256_set1_epi32(M2)));
+        return _mm256_or_si256(r, _mm256_and_si256(_mm256_srli_epi32(v, S3), _mm256_set1_epi32(M3)));
+    }
+#endif
+
+#if SC_PIXELOPS_SSE2
+    static inline auto lanes(__m128i v) -> __m128i {
+        auto r = _mm_and_si128(_mm_srli_epi32(v, S0), _mm_set1_epi32(M0));
+        r = _mm_or_si128(r, _mm_and_si128(_mm_srli_epi32(v, S1), _mm_set1_epi32(M1)));
+        r = _mm_or_si128(r, _mm_and_si128(_mm_srli_epi32(v, S2), _mm_set1_epi32(M2)));
+        r = _mm_or_si128(r, _mm_and_si128(_mm_srli_epi32(v, S3), _mm_set1_epi32(M3)));
+        // Sign extend so the saturating pack keeps all 16 bits
+        return _mm_srai_epi32(_mm_slli_epi32(r, 16), 16);
+    }
+#elif SC_PIXELOPS_NEON
+    static inline auto lanes(uint32x4_t v) -> uint16x4_t {
+        auto r = vandq_u32(vshrq_n_u32(v, S0), vdupq_n_u32(M0));
+        r = vorrq_u32(r, vandq_u32(vshrq_n_u32(v, S1), vdupq_n_u32(M1)));
+        r = vorrq_u32(r, vandq_u32(vshrq_n_u32(v, S2), vdupq_n_u32(M2)));
+        r = vorrq_u32(r, vandq_u32(vshrq_n_u32(v, S3), vdupq_n_u32(M3)));
+        return vmovn_u32(r);
+    }
+#endif
+
+    static auto run(u16 *dst, const u32 *src, size_t count) -> void {
+        size_t i = 0;
+
+#if SC_PIXELOPS_AVX2
+        for (; i + 16 <= count; i += 16) {
+            auto a = lanes(_mm256_loadu_si256((const __m256i *)(src + i)));
+            auto b = lanes(_mm256_loadu_si256((const __m256i *)(src + i + 8)));
+            // The pack works per 128-bit half, the permute restores order
+            auto p = _mm256_permute4x64_epi64(_mm256_packus_epi32(a, b), 0xD8);
+            _mm256_storeu_si256((__m256i *)(dst + i), p);
+        }
+#endif
+
+#if SC_PIXELOPS_SSE2
+        for (; i + 8 <= count; i += 8) {
+            auto a = lanes(_mm_loadu_si128((const __m128i *)(src + i)));
+            auto b = lanes(_mm_loadu_si128((const __m128i *)(src + i + 4)));
+            _mm_storeu_si128((__m128i *)(dst + i), _mm_packs_epi32(a, b));
+        }
+#elif SC_PIXELOPS_NEON
+        for (; i + 8 <= count; i += 8) {
+            auto a = lanes(vld1q_u32(src + i));
+            auto b = lanes(vld1q_u32(src + i + 4));
+            vst1q_u16(dst + i, vcombine_u16(a, b));
+        }
+#endif
+
+        run_scalar(dst + i, src + i, count - i);
+    }
+
+    static auto run_scalar(u16 *dst, const u32 *src, size_t count) -> void {
+        for (size_t i = 0; i < count; i++)
+            dst[i] = scalar(src[i]);
+    }
+};
+
+using Narrow4444 = Narrow<4, 0xF, 8, 0xF0, 12, 0xF00, 16, 0xF000>;
+using Narrow5551 = Narrow<3, 0x1F, 6, 0x3E0, 9, 0x7C00, 16, 0x8000>;
+using Narrow565 = Narrow<3, 0x1F, 5, 0x7E0, 8, 0xF800, 8, 0>;
+
+auto rgba8888_to_4444(u16 *dst, const u32 *src, size_t count) -> void {
+    Narrow4444::run(dst, src, count);
+}
+
+auto rgba8888_to_5551(u16 *dst, const u32 *src, size_t count) -> void {
+    Narrow5551::run(dst, src, count);
+}
+
+auto rgba8888_to_565(u16 *dst, const u32 *src, size_t count) -> void {
+    Narrow565::run(dst, src, count);
+}
+
+static inline auto pack8888(u32 r, u32 g, u32 b, u32 a) -> u32 {
+    return r | (g << 8) | (b << 16) | (a << 24);
+}
+
+auto rgba4444_to_8888(u32 *dst, const u16 *src, size_t count) -> void {
+    for (size_t i = 0; i < count; i++) {
+        u32 p = src[i];
+        dst[i] = pack8888((p & 0xF) * 17, ((p >> 4) & 0xF) * 17,
+                          ((p >> 8) & 0xF) * 17, (p >> 12) * 17);
+    }
+}
+
+auto rgba5551_to_8888(u32 *dst, const u16 *src, size_t count) -> void {
+    for (size_t i = 0; i < count; i++) {
+        u32 p = src[i];
+        u32 r = p & 0x1F, g = (p >> 5) & 0x1F, b = (p >> 10) & 0x1F;
+        dst[i] = pack8888((r << 3) | (r >> 2), (g << 3) | (g >> 2),
+                          (b << 3) | (b >> 2), (p >> 15) ? 255 : 0);
+    }
+}
+
+auto rgba565_to_8888(u32 *dst, const u16 *src, size_t count) -> void {
+    for (size_t i = 0; i < count; i++) {
+        u32 p = src[i];
+        u32 r = p & 0x1F, g = (p >> 5) & 0x3F, b = p >> 11;
+        dst[i] = pack8888((r << 3) | (r >> 2), (g << 2) | (g >> 4),
+                          (b << 3) | (b >> 2), 255);
+    }
+}
+
+auto bc1_palette(const u8 *block, u32 palette[4], bool fourColor) -> void {
+    u32 c0 = block[0] | (block[1] << 8);
+    u32 c1 = block[2] | (block[3] << 8);
+
+    // Endpoints are 565 with red in the high bits
+    u32 r0 = (c0 >> 11) & 0x1F, g0 = (c0 >> 5) & 0x3F, b0 = c0 & 0x1F;
+    u32 r1 = (c1 >> 11) & 0x1F, g1 = (c1 >> 5) & 0x3F, b1 = c1 & 0x1F;
+    r0 = (r0 << 3) | (r0 >> 2), g0 = (g0 << 2) | (g0 >> 4), b0 = (b0 << 3) | (b0 >> 2);
+    r1 = (r1 << 3) | (r1 >> 2), g1 = (g1 << 2) | (g1 >> 4), b1 = (b1 << 3) | (b1 >> 2);
+
+    palette[0] = pack8888(r0, g0, b0, 255);
+    palette[1] = pack8888(r1, g1, b1, 255);
+
+    if (c0 > c1 || fourColor) {
+        palette[2] = pack8888((2 * r0 + r1 + 1) / 3, (2 * g0 + g1 + 1) / 3,
+                              (2 * b0 + b1 + 1) / 3, 255);
+        palette[3] = pack8888((r0 + 2 * r1 + 1) / 3, (g0 + 2 * g1 + 1) / 3,
+                              (b0 + 2 * b1 + 1) / 3, 255);
+    } else {
+        palette[2] = pack8888((r0 + r1) / 2, (g0 + g1) / 2, (b0 + b1) / 2, 255);
+        palette[3] = 0;
+    }
+}
+
+auto bc3_alpha_palette(const u8 *block, u8 palette[8]) -> void {
+    u32 a0 = block[0];
+    u32 a1 = block[1];
+    palette[0] = static_cast<u8>(a0);
+    palette[1] = static_cast<u8>(a1);
+
+    if (a0 > a1) {
+        for (u32 i = 1; i < 7; i++)
+            palette[i + 1] = static_cast<u8>(((7 - i) * a0 + i * a1 + 3) / 7);
+    } else {
+        for (u32 i = 1; i < 5; i++)
+            palette[i + 1] = static_cast<u8>(((5 - i) * a0 + i * a1 + 2) / 5);
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+}
+
+static auto bc1_block(const u8 *block, u32 texels[16], bool fourColor)
+    -> void {
+    u32 palette[4];
+    bc1_palette(block, palette, fourColor);
+
+    u32 codes = block[4] | (block[5] << 8) | (block[6] << 16) |
+                ((u32)block[7] << 24);
+    for (u32 i = 0; i < 16; i++, codes >>= 2)
+        texels[i] = palette[codes & 3];
+}
+
+static auto bc3_block(const u8 *block, u32 texels[16]) -> void {
+    bc1_block(block + 8, texels, true);
+
+    u8 palette[8];
+    bc3_alpha_palette(block, palette);
+
+    u64 codes = 0;
+    for (u32 i = 0; i < 6; i++)
+        codes |= (u64)block[2 + i] << (8 * i);
+    for (u32 i = 0; i < 16; i++, codes >>= 3)
+        texels[i] = (texels[i] & 0x00FFFFFF) | ((u32)palette[codes & 7] << 24);
+}
+
+// Decodes every block into a 4x4 tile, then copies the part inside the image
+template <class F>
+static auto decode_blocks(u32 *dst, const u8 *src, u32 width, u32 height,
+                          size_t blockBytes, F decode) -> void {
+    u32 texels[16];
+
+    for (u32 by = 0; by < height; by += 4) {
+        auto rows = std::min(height - by, 4u);
+        for (u32 bx = 0; bx < width; bx += 4) {
+            auto cols = std::min(width - bx, 4u);
+            decode(src, texels);
+            src += blockBytes;
+
+            for (u32 y = 0; y < rows; y++)
+                memcpy(dst + (by + y) * width + bx, texels + y * 4, cols * 4);
+        }
+    }
+}
+
+auto decode_bc1(u32 *dst, const u8 *src, u32 width, u32 height) -> void {
+    decode_blocks(dst, src, width, height, 8,
+                  [](const u8 *block, u32 *texels) { bc1_block(block, texels, false); });
+}
+
+auto decode_bc3(u32 *dst, const u8 *src, u32 width, u32 height) -> void {
+    decode_blocks(dst, src, width, height, 16, bc3_block);
+}
+
+// Exact round(c * a / 255) for 8-bit c and a
+static inline auto mul_div255(u32 c, u32 a) -> u32 {
+    auto t = c * a + 128;
+    return (t + (t >> 8)) >> 8;
+}
+
+static auto premultiply_scalar(u32 *pixels, size_t count) -> void {
+    for (size_t i = 0; i < count; i++) {
+        auto p = pixels[i];
+        auto a = p >> 24;
+        pixels[i] = pack8888(mul_div255(p & 0xFF, a),
+                             mul_div255((p >> 8) & 0xFF, a),
+                             mul_div255((p >> 16) & 0xFF, a), a);
+    }
+}
+
+#if SC_PIXELOPS_SSE2
+// Two pixels as 16-bit channels; the alpha lanes multiply by 255, which
+// leaves them unchanged
+static inline auto premultiply_lanes(__m128i c) -> __m128i {
+    auto a = _mm_shufflelo_epi16(c, _MM_SHUFFLE(3, 3, 3, 3));
+    a = _mm_shufflehi_epi16(a, _MM_SHUFFLE(3, 3, 3, 3));
+    auto alphaLanes = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+    a = _mm_or_si128(_mm_andnot_si128(alphaLanes, a),
+                     _mm_and_si128(alphaLanes, _mm_set1_epi16(255)));
+
+    auto t = _mm_add_epi16(_mm_mullo_epi16(c, a), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+#endif
+
+auto premultiply_alpha(u32 *pixels, size_t count) -> void {
+    size_t i = 0;
+
+#if SC_PIXELOPS_SSE2
+    auto zero = _mm_setzero_si128();
+    for (; i + 4 <= count; i += 4) {
+        auto p = _mm_loadu_si128((const __m128i *)(pixels + i));
+        auto lo = premultiply_lanes(_mm_unpacklo_epi8(p, zero));
+        auto hi = premultiply_lanes(_mm_unpackhi_epi8(p, zero));
+        _mm_storeu_si128((__m128i *)(pixels + i), _mm_packus_epi16(lo, hi));
+    }
+#elif SC_PIXELOPS_NEON
+    auto bias = vdupq_n_u16(128);
+    for (; i + 8 <= count; i += 8) {
+        auto p = vld4_u8((const u8 *)(pixels + i));
+        for (int c = 0; c < 3; c++) {
+            auto t = vaddq_u16(vmull_u8(p.val[c], p.val[3]), bias);
+            p.val[c] = vshrn_n_u16(vsraq_n_u16(t, t, 8), 8);
+        }
+        vst4_u8((u8 *)(pixels + i), p);
+    }
+#endif
+
+    premultiply_scalar(pixels + i, count - i);
+}
+
+auto flip_vertical(u8 *pixels, size_t stride, u32 rows) -> void {
+    u8 chunk[256];
+
+    for (u32 y = 0; y < rows / 2; y++) {
+        auto top = pixels + y * stride;
+        auto bottom = pixels + (rows - 1 - y) * stride;
+
+        for (size_t x = 0; x < stride; x += sizeof(chunk)) {
+            auto n = std::min(sizeof(chunk), stride - x);
+            memcpy(chunk, top + x, n);
+            memcpy(top + x, bottom + x, n);
+            memcpy(bottom + x, chunk, n);
+        }
+    }
+}
+
+auto pad_image(u8 *dst, size_t dstStride, u32 dstRows, const u8 *src,
+               size_t srcStride, u32 srcRows) -> void {
+    for (u32 y = 0; y < srcRows; y++) {
+        memcpy(dst + y * dstStride, src + y * srcStride, srcStride);
+        memset(dst + y * dstStride + srcStride, 0, dstStride - srcStride);
+    }
+
+    if (dstRows > srcRows)
+        memset(dst + srcRows * dstStride, 0, (dstRows - srcRows) * dstStride);
+}
+
+auto swizzle(u8 *dst, const u8 *src, u32 stride, u32 rows) -> void {
+    auto blocksX = stride / 16;
+
+    for (u32 by = 0; by < rows / 8; by++) {
+        auto blockRow = src + by * 8 * stride;
+
+        for (u32 bx = 0; bx < blocksX; bx++) {
+            auto block = blockRow + bx * 16;
+
+            // Fixed 16 byte copies compile to single vector moves
+            for (u32 j = 0; j < 8; j++) {
+                memcpy(dst, block + j * stride, 16);
+                dst += 16;
+            }
+        }
+    }
+}
+
+namespace Scalar {
+
+auto rgba8888_to_4444(u16 *dst, const u32 *src, size_t count) -> void {
+    Narrow4444::run_scalar(dst, src, count);
+}
+
+auto rgba8888_to_5551(u16 *dst, const u32 *src, size_t count) -> void {
+    Narrow5551::run_scalar(dst, src, count);
+}
+
+auto rgba8888_to_565(u16 *dst, const u32 *src, size_t count) -> void {
+    Narrow565::run_scalar(dst, src, count);
+}
+
+auto premultiply_alpha(u32 *pixels, size_t count) -> void {
+    premultiply_scalar(pixels, count);
+}
+
+} // namespace Scalar
+
+} // namespace Stardust_Celeste::Rendering::PixelOps
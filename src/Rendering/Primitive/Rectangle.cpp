@@ -13,11 +13,10 @@ Rectangle::Rectangle(Rendering::Rectangle bnd, Rendering::Color col, float lay)
 Rectangle::~Rectangle() { mesh->delete_data(); }
 
 void Rectangle::draw() {
+    // Texturing is turned back on by the next texture bind
     GI::disable(GI_TEXTURE_2D);
 
     mesh->draw();
-
-    GI::enable(GI_TEXTURE_2D);
 }
 
 void Rectangle::build_mesh() {
@@ -2,6 +2,8 @@
 #include <Platform/Platform.hpp>
 #include <Rendering/GI.hpp>
 #include <Rendering/RenderContext.hpp>
+#include <Rendering/RenderQueue.hpp>
+#include <Rendering/Texture.hpp>
 #define BUILD_PC (BUILD_PLAT == BUILD_WINDOWS || BUILD_PLAT == BUILD_POSIX)
 
 #if BUILD_PLAT == BUILD_3DS
@@ -37,11 +39,14 @@
 #if BUILD_PC
 namespace GI {
     extern GLuint programID;
-    extern GLuint ubo;
     extern u32 projLoc, viewLoc, modLoc;
 }
 #endif
 
+namespace GI {
+    extern FrameStats frameStats;
+}
+
 namespace Stardust_Celeste::Rendering {
 
     RenderContextSettings rctxSettings;
@@ -73,32 +78,46 @@ auto RenderContext::initialize(const RenderContextSettings app) -> void {
     _ubo.proj = _gfx_ortho;
     _ubo.view = mathfu::Matrix<float, 4>::Identity();
     _ubo.model = mathfu::Matrix<float, 4>::Identity();
+    _model = mathfu::Matrix<float, 4>::Identity();
+    _stackProduct = mathfu::Matrix<float, 4>::Identity();
+    _dirty = MATRIX_DIRTY_ALL;
 }
 
 auto RenderContext::terminate() -> void { GI::terminate(); }
 
 auto RenderContext::clear() -> void {
     GI::start_frame();
+    TextureManager::get().begin_frame();
 
     GI::clear_color(c);
     GI::clear(GI_COLOR_BUFFER_BIT | GI_DEPTH_BUFFER_BIT |
               GI_STENCIL_BUFFER_BIT);
 }
 
-auto RenderContext::render() -> void { GI::end_frame(vsync); }
+auto RenderContext::render() -> void {
+    RenderQueue::get().flush();
+    GI::end_frame(vsync);
+}
 
 auto RenderContext::matrix_push() -> void {
-    _matrixStack.push_back(_ubo.model);
-    _ubo.model = mathfu::Matrix<float, 4>::Identity();
+    _matrixStack.push_back(_model);
+    _productStack.push_back(_stackProduct);
+    _stackProduct *= _model;
+    _model = mathfu::Matrix<float, 4>::Identity();
+    _dirty |= MATRIX_DIRTY_MODEL;
 }
 
 auto RenderContext::matrix_pop() -> void {
-    _ubo.model = _matrixStack[_matrixStack.size() - 1];
+    _model = _matrixStack.back();
+    _stackProduct = _productStack.back();
     _matrixStack.pop_back();
+    _productStack.pop_back();
+    _dirty |= MATRIX_DIRTY_MODEL;
 }
 
 auto RenderContext::matrix_clear() -> void {
-    _ubo.model = mathfu::Matrix<float, 4>::Identity();
+    _model = mathfu::Matrix<float, 4>::Identity();
+    _dirty |= MATRIX_DIRTY_MODEL;
 #if BUILD_PLAT == BUILD_PSP
     sceGumMatrixMode(GU_MODEL);
     sceGumLoadIdentity();
@@ -109,7 +128,8 @@ auto RenderContext::matrix_clear() -> void {
 }
 
 auto RenderContext::matrix_translate(mathfu::Vector<float, 3> v) -> void {
-    _ubo.model *= mathfu::Matrix<float, 4>::FromTranslationVector(v);
+    _model *= mathfu::Matrix<float, 4>::FromTranslationVector(v);
+    _dirty |= MATRIX_DIRTY_MODEL;
 }
 
 auto RenderContext::matrix_rotate(mathfu::Vector<float, 3> v) -> void {
@@ -120,11 +140,13 @@ auto RenderContext::matrix_rotate(mathfu::Vector<float, 3> v) -> void {
     auto rotation = rot_x * rot_y * rot_z;
     auto rotation_matrix = mathfu::Matrix<float, 4, 4>::FromRotationMatrix(rotation);
 
-    _ubo.model *= rotation_matrix;
+    _model *= rotation_matrix;
+    _dirty |= MATRIX_DIRTY_MODEL;
 }
 
 auto RenderContext::matrix_scale(mathfu::Vector<float, 3> v) -> void {
-    _ubo.model *= mathfu::Matrix<float, 4>::FromScaleVector(v);
+    _model *= mathfu::Matrix<float, 4>::FromScaleVector(v);
+    _dirty |= MATRIX_DIRTY_MODEL;
 }
 
 auto RenderContext::matrix_perspective(float fovy, float aspect, float zn,
@@ -132,7 +154,8 @@ auto RenderContext::matrix_perspective(float fovy, float aspect, float zn,
     _gfx_persp = mathfu::Matrix<float, 4>::Perspective(
         fovy / 180.0f * M_PI, aspect, zn, zf);
     _ubo.view = mathfu::Matrix<float, 4>::Identity();
-    _ubo.model = mathfu::Matrix<float, 4>::Identity();
+    _model = mathfu::Matrix<float, 4>::Identity();
+    _dirty |= MATRIX_DIRTY_VIEW | MATRIX_DIRTY_MODEL;
 #if BUILD_PLAT == BUILD_PSP
     sceGumMatrixMode(GU_PROJECTION);
     ScePspFMatrix4 m1 = *(ScePspFMatrix4*)(_gfx_persp.data_);
@@ -144,7 +167,7 @@ auto RenderContext::matrix_perspective(float fovy, float aspect, float zn,
     sceGumLoadIdentity();
 #elif BUILD_PLAT == BUILD_3DS
     glMatrixMode(GL_PROJECTION);
-    glLoadMatrixf(glm::value_ptr(*_gfx_proj));
+    glLoadMatrixf(reinterpret_cast<const float *>(_gfx_persp.data_));
 
     glMatrixMode(GL_MODELVIEW);
     glLoadIdentity();
@@ -155,7 +178,8 @@ auto RenderContext::matrix_ortho(float l, float r, float b, float t, float zn,
                                  float zf) -> void {
     _gfx_ortho = mathfu::Matrix<float, 4>::Ortho(l, r, b, t, zn, zf);
     _ubo.view = mathfu::Matrix<float, 4>::Identity();
-    _ubo.model = mathfu::Matrix<float, 4>::Identity();
+    _model = mathfu::Matrix<float, 4>::Identity();
+    _dirty |= MATRIX_DIRTY_VIEW | MATRIX_DIRTY_MODEL;
 #if BUILD_PLAT == BUILD_PSP
     sceGumMatrixMode(GU_PROJECTION);
     ScePspFMatrix4 m1 = *(ScePspFMatrix4*)(_gfx_ortho.data_);
@@ -167,7 +191,7 @@ auto RenderContext::matrix_ortho(float l, float r, float b, float t, float zn,
     sceGumLoadIdentity();
 #elif BUILD_PLAT == BUILD_3DS
     glMatrixMode(GL_PROJECTION);
-    glLoadMatrixf(glm::value_ptr(*_gfx_proj));
+    glLoadMatrixf(reinterpret_cast<const float *>(_gfx_ortho.data_));
 
     glMatrixMode(GL_MODELVIEW);
     glLoadIdentity();
@@ -175,125 +199,97 @@ auto RenderContext::matrix_ortho(float l, float r, float b, float t, float zn,
 }
 
 auto RenderContext::set_matrices() -> void {
-#if BUILD_PC
-    auto newModel = mathfu::Matrix<float, 4>::Identity();
-    for (int i = 0; i < _matrixStack.size(); i++) {
-        newModel *= _matrixStack[i];
-    }
-    newModel *= _ubo.model;
-    _ubo.model = newModel;
+    // A clean block still needs streaming again once the ring has moved on,
+    // or it is read from a region that may be rewritten
+    if (_dirty == 0 && GI::uniform_block_current())
+        return;
 
+    GI::frameStats.matrix_uploads++;
+    if (_dirty & MATRIX_DIRTY_MODEL)
+        _ubo.model = _stackProduct * _model;
+
+#if BUILD_PC
     if(rctxSettings.renderingApi == Vulkan) {
 #ifndef NO_EXPERIMENTAL_GRAPHICS
-        GI::detail::VKPipeline::get().ubo.model = newModel;
+        GI::detail::VKPipeline::get().ubo.projview = _ubo.proj * _ubo.view;
+        GI::detail::VKPipeline::get().ubo.model = _ubo.model;
 #endif
     } else {
-        glBindBuffer(GL_UNIFORM_BUFFER, GI::ubo);
-        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(UBOLayout),
-                        &_ubo);
-
+        // Each draw binds its own copy of the block, so the whole layout is
+        // appended -- clean matrices keep the previous binding
+        GI::stream_uniform_block(&_ubo, sizeof(UBOLayout));
     }
 #elif BUILD_PLAT == BUILD_VITA
-
-    auto newModel = mathfu::Matrix<float, 4>::Identity();
-    for (int i = 0; i < _matrixStack.size(); i++) {
-        newModel *= _matrixStack[i];
-    }
-    newModel *= _ubo.model;
-    _ubo.model = newModel;
-
-    glUniformMatrix4fv(GI::projLoc, 1,
-                       GL_FALSE, glm::value_ptr(*_gfx_proj));
-    glUniformMatrix4fv(GI::viewLoc, 1,
-                       GL_FALSE, glm::value_ptr(_gfx_view));
-    glUniformMatrix4fv(GI::modLoc, 1,
-                       GL_FALSE, glm::value_ptr(newModel));
-
+    if (_dirty & MATRIX_DIRTY_PROJ)
+        glUniformMatrix4fv(GI::projLoc, 1, GL_FALSE,
+                           reinterpret_cast<const float *>(_ubo.proj.data_));
+    if (_dirty & MATRIX_DIRTY_VIEW)
+        glUniformMatrix4fv(GI::viewLoc, 1, GL_FALSE,
+                           reinterpret_cast<const float *>(_ubo.view.data_));
+    if (_dirty & MATRIX_DIRTY_MODEL)
+        glUniformMatrix4fv(GI::modLoc, 1, GL_FALSE,
+                           reinterpret_cast<const float *>(_ubo.model.data_));
 #elif BUILD_PLAT == BUILD_PSP
-
-    auto newModel = mathfu::Matrix<float, 4>::Identity();
-    for (int i = 0; i < _matrixStack.size(); i++) {
-        newModel *= _matrixStack[i];
+    // Projection and view are loaded into the GU as soon as they are set
+    if (_dirty & MATRIX_DIRTY_MODEL) {
+        sceGumMatrixMode(GU_MODEL);
+        ScePspFMatrix4 m1 = *((ScePspFMatrix4 *)_ubo.model.data_);
+        sceGumLoadMatrix(&m1);
     }
-    newModel *= _ubo.model;
-    _ubo.model = newModel;
-
-    sceGumMatrixMode(GU_MODEL);
-    ScePspFMatrix4 m1 = *((ScePspFMatrix4 *)_ubo.model.data_);
-    sceGumLoadMatrix(&m1);
-
 #elif BUILD_PLAT == BUILD_3DS
-    glMatrixMode(GL_PROJECTION);
-    glLoadMatrixf(glm::value_ptr(*_gfx_proj));
+    if (_dirty & MATRIX_DIRTY_PROJ) {
+        glMatrixMode(GL_PROJECTION);
+        glLoadMatrixf(reinterpret_cast<const float *>(_ubo.proj.data_));
+    }
 
     glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
-
-    glLoadMatrixf(glm::value_ptr(_gfx_view));
-    for (int i = 0; i < _matrixStack.size(); i++) {
-        glMultMatrixf(glm::value_ptr(_matrixStack[i]));
-    }
-    glMultMatrixf(glm::value_ptr(_gfx_model));
+    glLoadMatrixf(reinterpret_cast<const float *>(_ubo.view.data_));
+    glMultMatrixf(reinterpret_cast<const float *>(_ubo.model.data_));
 #endif
+
+    _dirty = 0;
 }
 
 auto RenderContext::matrix_view(mathfu::Matrix<float, 4> mat) -> void {
-#if BUILD_PC
-    _ubo.view = mat;
-
-    if(rctxSettings.renderingApi == Vulkan) {
-#ifndef NO_EXPERIMENTAL_GRAPHICS
-        GI::detail::VKPipeline::get().ubo.projview = *_gfx_proj * _gfx_view;
-#endif
-    } else {
-        glBindBuffer(GL_UNIFORM_BUFFER, GI::ubo);
-        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(UBOLayout),
-                        &_ubo);
-
-    }
-#elif BUILD_PLAT == BUILD_PSP
     _ubo.view = mat;
+    _dirty |= MATRIX_DIRTY_VIEW;
+#if BUILD_PLAT == BUILD_PSP
     sceGumMatrixMode(GU_VIEW);
     ScePspFMatrix4 m1 = *((ScePspFMatrix4 *)_ubo.view.data_);
     sceGumLoadMatrix(&m1);
-#elif BUILD_PLAT == BUILD_VITA || BUILD_PLAT == BUILD_3DS
-    _gfx_view = mat;
 #endif
 }
 
-auto RenderContext::matrix_model(mathfu::Matrix<float, 4> mat) -> void {
-#if BUILD_PC || BUILD_PLAT == BUILD_VITA || BUILD_PLAT == BUILD_3DS
-    _ubo.model = mat;
-#elif BUILD_PLAT == BUILD_PSP
-    _ubo.model = mat;
-    sceGumMatrixMode(GU_MODEL);
-    ScePspFMatrix4 m1 = *((ScePspFMatrix4 *)_ubo.model.data_);
+auto RenderContext::load_matrices(const mathfu::Matrix<float, 4, 4> &proj,
+                                  const mathfu::Matrix<float, 4, 4> &view,
+                                  const mathfu::Matrix<float, 4, 4> &model)
+    -> void {
+    _ubo.proj = proj;
+    _ubo.view = view;
+    _model = model;
+    _stackProduct = mathfu::Matrix<float, 4>::Identity();
+    _dirty = MATRIX_DIRTY_ALL;
+#if BUILD_PLAT == BUILD_PSP
+    sceGumMatrixMode(GU_PROJECTION);
+    ScePspFMatrix4 m1 = *((ScePspFMatrix4 *)_ubo.proj.data_);
     sceGumLoadMatrix(&m1);
+    sceGumMatrixMode(GU_VIEW);
+    ScePspFMatrix4 m2 = *((ScePspFMatrix4 *)_ubo.view.data_);
+    sceGumLoadMatrix(&m2);
 #endif
 }
 
+auto RenderContext::matrix_model(mathfu::Matrix<float, 4> mat) -> void {
+    _model = mat;
+    _dirty |= MATRIX_DIRTY_MODEL;
+}
+
 auto RenderContext::set_mode_2D() -> void {
     _ubo.proj = _gfx_ortho;
-#if BUILD_PC
-
-    if(rctxSettings.renderingApi == Vulkan) {
-        _ubo.view = mathfu::Matrix<float, 4>::Identity();
-        _ubo.model = mathfu::Matrix<float, 4>::Identity();
-#ifndef NO_EXPERIMENTAL_GRAPHICS
-
-        GI::detail::VKPipeline::get().ubo.projview = *_gfx_proj * _gfx_view;
-        GI::detail::VKPipeline::get().ubo.model = _gfx_model;
-#endif
-    } else {
-        _ubo.view = mathfu::Matrix<float, 4>::Identity();
-        _ubo.model = mathfu::Matrix<float, 4>::Identity();
-
-        glBindBuffer(GL_UNIFORM_BUFFER, GI::ubo);
-        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(UBOLayout),
-                        &_ubo);
-
-    }
-#elif BUILD_PLAT == BUILD_PSP
+    _ubo.view = mathfu::Matrix<float, 4>::Identity();
+    _model = mathfu::Matrix<float, 4>::Identity();
+    _dirty = MATRIX_DIRTY_ALL;
+#if BUILD_PLAT == BUILD_PSP
     sceGumMatrixMode(GU_PROJECTION);
     ScePspFMatrix4 m1 = *((ScePspFMatrix4 *)_ubo.proj.data_);
     sceGumLoadMatrix(&m1);
@@ -301,30 +297,15 @@ auto RenderContext::set_mode_2D() -> void {
     sceGumLoadIdentity();
     sceGumMatrixMode(GU_MODEL);
     sceGumLoadIdentity();
-#elif BUILD_PLAT == BUILD_VITA || BUILD_PLAT == BUILD_3DS
-    _gfx_view = glm::mat4(1.0f);
-    _gfx_model = glm::mat4(1.0f);
 #endif
 }
+
 auto RenderContext::set_mode_3D() -> void {
     _ubo.proj = _gfx_persp;
-#if BUILD_PC
     _ubo.view = mathfu::Matrix<float, 4>::Identity();
-    _ubo.model = mathfu::Matrix<float, 4>::Identity();
-
-    if(rctxSettings.renderingApi == Vulkan) {
-#ifndef NO_EXPERIMENTAL_GRAPHICS
-
-        GI::detail::VKPipeline::get().ubo.projview = *_gfx_proj * _gfx_view;
-        GI::detail::VKPipeline::get().ubo.model = _gfx_model;
-#endif
-    } else {
-        glBindBuffer(GL_UNIFORM_BUFFER, GI::ubo);
-        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(UBOLayout),
-                        &_ubo);
-
-    }
-#elif BUILD_PLAT == BUILD_PSP
+    _model = mathfu::Matrix<float, 4>::Identity();
+    _dirty = MATRIX_DIRTY_ALL;
+#if BUILD_PLAT == BUILD_PSP
     sceGumMatrixMode(GU_PROJECTION);
     ScePspFMatrix4 m1 = *((ScePspFMatrix4 *)_ubo.proj.data_);
     sceGumLoadMatrix(&m1);
@@ -332,10 +313,7 @@ auto RenderContext::set_mode_3D() -> void {
     sceGumLoadIdentity();
     sceGumMatrixMode(GU_MODEL);
     sceGumLoadIdentity();
-#elif BUILD_PLAT == BUILD_VITA || BUILD_PLAT == BUILD_3DS
-    _gfx_view = glm::mat4(1.0f);
-    _gfx_model = glm::mat4(1.0f);
 #endif
 }
 
-} // namespace Stardust_Celeste::Rendering
\ No newline at end of file
+} // namespace Stardust_Celeste::Rendering
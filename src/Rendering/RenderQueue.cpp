@@ -0,0 +1,189 @@
+#include <Rendering/RenderContext.hpp>
+#include <Rendering/RenderQueue.hpp>
+#include <Rendering/Texture.hpp>
+#include <cstring>
+
+namespace Stardust_Celeste::Rendering {
+
+// Key layout, most significant first:
+// [63] translucent | [62..47] layer | [46..0] texture / depth
+constexpr u32 TEXTURE_BITS = 23;
+constexpr u32 DEPTH_BITS = 24;
+
+// Maps a float to an unsigned integer with the same ordering
+static auto depth_bits(float depth) -> u32 {
+    u32 bits;
+    memcpy(&bits, &depth, sizeof(bits));
+    bits = (bits & 0x80000000) ? ~bits : bits | 0x80000000;
+    return bits >> (32 - DEPTH_BITS);
+}
+
+auto RenderQueue::make_key(const DrawState &state) -> u64 {
+    u64 layer = static_cast<u16>(state.layer ^ 0x8000);
+    u64 texture = TextureManager::handle_index(state.texture);
+    u64 depth = depth_bits(state.depth);
+
+    u64 key = layer << (TEXTURE_BITS + DEPTH_BITS);
+    if (state.translucent) {
+        // Back to front, ties grouped by texture
+        key |= 1ull << 63;
+        key |= static_cast<u64>((~depth) & ((1u << DEPTH_BITS) - 1)) << TEXTURE_BITS;
+        key |= texture;
+    } else {
+        // Grouped by texture, front to back within a texture
+        key |= texture << DEPTH_BITS;
+        key |= depth;
+    }
+    return key;
+}
+
+auto RenderQueue::submit(GI::BufferObject *vbo, size_t idx_offset,
+                         size_t idx_count, const DrawState &state, PrimType p)
+    -> void {
+    if (vbo == nullptr || idx_count == 0)
+        return;
+
+    auto &ctx = RenderContext::get();
+    Matrices current{ctx._ubo.proj, ctx._ubo.view,
+                     ctx._stackProduct * ctx._model};
+
+    // Runs of draws usually share their matrices
+    if (matrices.empty() ||
+        memcmp(&matrices.back(), &current, sizeof(Matrices)) != 0)
+        matrices.push_back(current);
+
+    packets.push_back({make_key(state), vbo, idx_offset, idx_count,
+                       state.texture,
+                       static_cast<u32>(matrices.size() - 1), p,
+                       state.translucent});
+}
+
+auto RenderQueue::count_state_changes(const u32 *ord) const -> u32 {
+    u32 changes = 0;
+    const DrawPacket *last = nullptr;
+
+    for (size_t i = 0; i < packets.size(); i++) {
+        auto &p = packets[ord[i]];
+        if (last == nullptr || p.texture != last->texture)
+            changes++;
+        if (last == nullptr || p.translucent != last->translucent)
+            changes++;
+        if (last == nullptr || p.vbo != last->vbo)
+            changes++;
+        if (last == nullptr || p.matrices != last->matrices)
+            changes++;
+        last = &p;
+    }
+
+    return changes;
+}
+
+auto RenderQueue::sort() -> void {
+    auto count = packets.size();
+    keys.resize(count);
+    keysTemp.resize(count);
+    order.resize(count);
+    orderTemp.resize(count);
+
+    u64 differing = 0;
+    for (size_t i = 0; i < count; i++) {
+        keys[i] = packets[i].key;
+        order[i] = static_cast<u32>(i);
+        differing |= keys[i] ^ keys[0];
+    }
+
+    // LSD radix sort, 8 bits per pass -- stable, so equal keys keep their
+    // submission order. Passes over bytes every key shares are skipped.
+    for (u32 shift = 0; shift < 64; shift += 8) {
+        if (((differing >> shift) & 0xFF) == 0)
+            continue;
+
+        u32 offsets[256] = {};
+        for (size_t i = 0; i < count; i++)
+            offsets[(keys[i] >> shift) & 0xFF]++;
+
+        u32 sum = 0;
+        for (auto &o : offsets) {
+            auto c = o;
+            o = sum;
+            sum += c;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            auto dst = offsets[(keys[i] >> shift) & 0xFF]++;
+            keysTemp[dst] = keys[i];
+            orderTemp[dst] = order[i];
+        }
+
+        keys.swap(keysTemp);
+        order.swap(orderTemp);
+    }
+}
+
+auto RenderQueue::flush() -> void {
+    stats = RenderQueueStats();
+    if (packets.empty()) {
+        matrices.clear();
+        return;
+    }
+
+    sort();
+
+    stats.packets = static_cast<u32>(packets.size());
+    stats.state_changes_sorted = count_state_changes(order.data());
+    for (size_t i = 0; i < packets.size(); i++)
+        orderTemp[i] = static_cast<u32>(i);
+    stats.state_changes_unsorted = count_state_changes(orderTemp.data());
+
+    auto &ctx = RenderContext::get();
+    auto savedProj = ctx._ubo.proj;
+    auto savedView = ctx._ubo.view;
+    auto savedModel = ctx._model;
+    auto savedProduct = ctx._stackProduct;
+
+    const DrawPacket *last = nullptr;
+    for (auto i : order) {
+        auto &p = packets[i];
+
+        if (last == nullptr || p.texture != last->texture) {
+            if (p.texture == 0)
+                GI::disable(GI_TEXTURE_2D);
+            else
+                TextureManager::get().bind_texture(p.texture);
+        }
+
+        if (last == nullptr || p.translucent != last->translucent) {
+            if (p.translucent)
+                GI::enable(GI_BLEND);
+            else
+                GI::disable(GI_BLEND);
+        }
+
+        if (last == nullptr || p.matrices != last->matrices) {
+            auto &m = matrices[p.matrices];
+            ctx.load_matrices(m.proj, m.view, m.model);
+        }
+
+        if (last == nullptr || p.vbo != last->vbo)
+            p.vbo->bind();
+
+        ctx.set_matrices();
+        p.vbo->draw_range(p.prim, p.idx_offset, p.idx_count);
+        last = &p;
+    }
+
+    // Blending is on by default outside the queue
+    GI::enable(GI_BLEND);
+    ctx.load_matrices(savedProj, savedView, savedModel);
+    ctx._stackProduct = savedProduct;
+
+    packets.clear();
+    matrices.clear();
+}
+
+auto RenderQueue::clear() -> void {
+    packets.clear();
+    matrices.clear();
+}
+
+} // namespace Stardust_Celeste::Rendering
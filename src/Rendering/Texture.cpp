@@ -1,5 +1,7 @@
 #include <Platform/Platform.hpp>
+#include <Rendering/CookedTexture.hpp>
 #include <Rendering/GI.hpp>
+#include <Rendering/PixelOps.hpp>
 #include <Rendering/Texture.hpp>
 
 #define BUILD_PC (BUILD_PLAT == BUILD_WINDOWS || BUILD_PLAT == BUILD_POSIX)
@@ -25,52 +27,20 @@
 #endif
 
 #include <Utilities/Assertion.hpp>
+#include <Utilities/Logger.hpp>
 
-#include <stb_image.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <string>
 
-#if USE_EASTL
-#include <EASTL/vector.h>
-#else
-#include <vector>
-#endif
-
 #if BUILD_PLAT == BUILD_VITA
 #include <vitaGL.h>
 #endif
 
 #if BUILD_PLAT == BUILD_PSP
-inline auto swizzle_fast(u8 *out, const u8 *in, unsigned int width,
-                         unsigned int height) -> void {
-    unsigned int blockx, blocky;
-    unsigned int j;
-
-    unsigned int width_blocks = (width / 16);
-    unsigned int height_blocks = (height / 8);
-
-    unsigned int src_pitch = (width - 16) / 4;
-    unsigned int src_row = width * 8;
-
-    const u8 *ysrc = in;
-    u32 *dst = (u32 *)out;
-
-    for (blocky = 0; blocky < height_blocks; ++blocky) {
-        const u8 *xsrc = ysrc;
-        for (blockx = 0; blockx < width_blocks; ++blockx) {
-            const u32 *src = (u32 *)xsrc;
-            for (j = 0; j < 8; ++j) {
-                *(dst++) = *(src++);
-                *(dst++) = *(src++);
-                *(dst++) = *(src++);
-                *(dst++) = *(src++);
-                src += src_pitch;
-            }
-            xsrc += 16;
-        }
-        ysrc += src_row;
-    }
-}
-
 u32 offset = 10 * 512 * 272;
 
 #endif
@@ -78,6 +48,10 @@ u32 offset = 10 * 512 * 272;
 #include <Rendering/GI/GL/GLTextureHandle.hpp>
 #include <Rendering/GI/VK/VkTextureHandle.hpp>
 
+namespace GI {
+    extern FrameStats frameStats;
+}
+
 namespace Stardust_Celeste::Rendering {
 
 auto pow2(u32 value) -> u32 {
@@ -88,27 +62,73 @@ auto pow2(u32 value) -> u32 {
     return poweroftwo;
 }
 
+// Whether the GL path builds a mip chain for this filter
+static auto uses_mipmaps(u32 minFilter) -> bool {
+#if BUILD_PC || BUILD_PLAT == BUILD_VITA
+    return minFilter != GL_NEAREST && minFilter != GL_LINEAR;
+#else
+    return false;
+#endif
+}
+
+// GPU bytes of a texture uploaded from RGBA8 pixels
+static auto texture_bytes(const Texture *tex) -> u64 {
+#if BUILD_PLAT == BUILD_PSP
+    u64 bytes = (u64)tex->pW * tex->pH * (tex->colorMode == GU_PSM_8888 ? 4 : 2);
+#else
+    u64 bytes = (u64)tex->width * tex->height * 4;
+#endif
+
+    // A full mip chain adds a third
+    if (uses_mipmaps(tex->minFilter))
+        bytes += bytes / 3;
+    return bytes;
+}
+
 auto TextureManager::get_texture(std::string name) -> u32 {
+    auto it = nameIndex.find(name);
+    if (it == nameIndex.end())
+        return -1;
+
+    return it->second;
+}
 
-    for (auto &[key, val] : fullMap) {
-        if (val->name == name)
-            return key;
+auto TextureManager::insert(Texture *tex) -> u32 {
+    u32 index;
+    if (!freeSlots.empty()) {
+        index = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        SC_CORE_ASSERT(slots.size() <= HANDLE_INDEX_MASK, "Out of texture slots!");
+        index = static_cast<u32>(slots.size());
+        slots.emplace_back();
     }
 
-    return -1;
+    auto &slot = slots[index];
+    slot.texture = tex;
+    slot.refs = 1;
+    slot.lastBound = frame;
+    return (slot.generation << HANDLE_INDEX_BITS) | index;
+}
+
+auto TextureManager::acquire_existing(const std::string &filename) -> u32 {
+    auto it = nameIndex.find(filename);
+    if (it == nameIndex.end())
+        return 0;
+
+    slots[handle_index(it->second)].refs++;
+    return it->second;
 }
 
 auto TextureManager::load_texture_ram(u8 *buffer, size_t length, u32 magFilter, u32 minFilter, bool repeat, bool flip,
                                       bool vram, bool needPix) -> u32 {
 
-    if (flip)
-        stbi_set_flip_vertically_on_load(true);
-    else
-        stbi_set_flip_vertically_on_load(false);
+    auto image = decode_image_memory(buffer, length, flip);
+    SC_CORE_ASSERT(image.pixels, "Could not load!");
 
-    int width, height, nrChannels;
-    unsigned char *data = stbi_load_from_memory(buffer, length, &width, &height, &nrChannels, STBI_rgb_alpha);
-    SC_CORE_ASSERT(data, "Could not load!");
+    auto data = image.pixels;
+    auto width = image.width;
+    auto height = image.height;
 
 
     Texture *tex = new Texture();
@@ -130,40 +150,26 @@ auto TextureManager::load_texture_ram(u8 *buffer, size_t length, u32 magFilter,
     tex->name = "";
 
 #if BUILD_PC || BUILD_PLAT == BUILD_VITA || BUILD_PLAT == BUILD_3DS
+    tex->data = GI::create_texturehandle_pixels(data, width, height, magFilter, minFilter, repeat);
+    tex->id = ((GI::TextureHandle*)tex->data)->id;
     if(needPix) {
         tex->pixData = data;
     } else {
-        free(data);
+        free_image(image);
     }
-    tex->data = GI::create_texturehandle_memory(buffer, length, magFilter, minFilter, repeat, flip);
-    tex->id = ((GI::TextureHandle*)tex->data)->id;
 #elif BUILD_PLAT == BUILD_PSP
     uint16_t *dataBuffer =
         (uint16_t *)memalign(16, tex->pH * tex->pW * 2);
 
-    for (uint16_t y = 0; y < height; y++) {
-        for (uint16_t x = 0; x < width; x++) {
-            auto rgba8 = ((unsigned int *)data)[x + y * width];
-            auto r = (rgba8 & 0xFF000000) >> 24;
-            auto g = (rgba8 & 0x00FF0000) >> 16;
-            auto b = (rgba8 & 0x0000FF00) >> 8;
-            auto a = (rgba8 & 0x000000FF);
-
-            auto r4 = (r >> 4) & 0xF;
-            auto g4 = (g >> 4) & 0xF;
-            auto b4 = (b >> 4) & 0xF;
-            auto a4 = (a >> 4) & 0xF;
-
-            auto rgba4 = (r4 << 12) | (g4 << 8) | (b4 << 4) | a4;
-
-            dataBuffer[x + y * tex->pW] = rgba4;
-        }
-    }
+    memset(dataBuffer, 0, tex->pH * tex->pW * 2);
+    for (u32 y = 0; y < height; y++)
+        PixelOps::rgba8888_to_4444(dataBuffer + y * tex->pW,
+                                   (const u32 *)data + y * width, width);
 
     if(needPix) {
         tex->pixData = data;
     } else {
-        free(data);
+        free_image(image);
     }
     tex->data = (uint16_t *)dataBuffer;
 
@@ -172,8 +178,8 @@ auto TextureManager::load_texture_ram(u8 *buffer, size_t length, u32 magFilter,
         swizzled_pixels = (uint16_t *)memalign(16, tex->pH * tex->pW * 2);
     }
 
-    swizzle_fast((u8 *)swizzled_pixels, (const u8 *)dataBuffer, tex->pW * 2,
-                 tex->pH);
+    PixelOps::swizzle((u8 *)swizzled_pixels, (const u8 *)dataBuffer,
+                      tex->pW * 2, tex->pH);
 
     free(dataBuffer);
     tex->data = (u16 *)swizzled_pixels;
@@ -181,29 +187,18 @@ auto TextureManager::load_texture_ram(u8 *buffer, size_t length, u32 magFilter,
     sceKernelDcacheWritebackInvalidateAll();
 #endif
 
-    fullMap.emplace(texCount, tex);
-    return texCount++;
+    auto id = insert(tex);
+    account(id, texture_bytes(tex));
+    return id;
 }
 
-auto TextureManager::load_texture(std::string filename, u32 magFilter,
-                                  u32 minFilter, bool repeat, bool flip,
-                                  bool vram) -> u32 {
-
-    int width, height, nrChannels;
-    if (flip)
-        stbi_set_flip_vertically_on_load(true);
-    else
-        stbi_set_flip_vertically_on_load(false);
-    unsigned char *data = stbi_load(filename.c_str(), &width, &height,
-                                    &nrChannels, STBI_rgb_alpha);
-    SC_CORE_ASSERT(data, "Could not load file: " + filename + "!");
-
+auto TextureManager::create_entry(std::string filename, u32 magFilter,
+                                  u32 minFilter, bool repeat) -> u32 {
     Texture *tex = new Texture();
-    tex->width = width;
-    tex->height = height;
-
-    tex->pW = pow2(width);
-    tex->pH = pow2(height);
+    tex->width = tex->height = 0;
+    tex->pW = tex->pH = 0;
+    tex->data = nullptr;
+    tex->pixData = nullptr;
 
     tex->ramSpace = 0; // TODO: Add option for PSP VRAM
     tex->swizzle = 1;
@@ -216,21 +211,36 @@ auto TextureManager::load_texture(std::string filename, u32 magFilter,
 
     tex->name = filename;
 
+    auto id = insert(tex);
+    nameIndex.emplace(filename, id);
+    return id;
+}
+
+auto TextureManager::finish_texture(u32 id, DecodedImage &image,
+                                    bool vram) -> void {
+    auto tex = resolve(id);
+    auto width = image.width;
+    auto height = image.height;
+    auto data = image.pixels;
+
+    tex->width = width;
+    tex->height = height;
+
+    tex->pW = pow2(width);
+    tex->pH = pow2(height);
+
 #if BUILD_PC || BUILD_PLAT == BUILD_VITA || BUILD_PLAT == BUILD_3DS
-    stbi_image_free(data);
-    tex->data = GI::create_texturehandle(filename, magFilter, minFilter, repeat, flip);
+    tex->data = GI::create_texturehandle_pixels(data, width, height, tex->magFilter, tex->minFilter, tex->repeating);
     tex->id = ((GI::TextureHandle*)tex->data)->id;
+    free_image(image);
 #elif BUILD_PLAT == BUILD_PSP
     unsigned int *dataBuffer =
         (unsigned int *)memalign(16, tex->pH * tex->pW * 4);
 
-    for (unsigned int y = 0; y < height; y++) {
-        for (unsigned int x = 0; x < width; x++) {
-            dataBuffer[x + y * tex->pW] = ((unsigned int *)data)[x + y * width];
-        }
-    }
+    PixelOps::pad_image((u8 *)dataBuffer, tex->pW * 4, tex->pH, data,
+                        width * 4, height);
 
-    stbi_image_free(data);
+    free_image(image);
     tex->data = (uint16_t *)dataBuffer;
 
     unsigned int *swizzled_pixels = nullptr;
@@ -242,8 +252,8 @@ auto TextureManager::load_texture(std::string filename, u32 magFilter,
         offset += tex->pH * tex->pW * 4;
     }
 
-    swizzle_fast((u8 *)swizzled_pixels, (const u8 *)dataBuffer, tex->pW * 4,
-                 tex->pH);
+    PixelOps::swizzle((u8 *)swizzled_pixels, (const u8 *)dataBuffer,
+                      tex->pW * 4, tex->pH);
 
     free(dataBuffer);
     tex->data = (u16 *)swizzled_pixels;
@@ -251,59 +261,742 @@ auto TextureManager::load_texture(std::string filename, u32 magFilter,
     sceKernelDcacheWritebackInvalidateAll();
 #endif
 
-    fullMap.emplace(texCount, tex);
-    return texCount++;
+    account(id, texture_bytes(tex));
+}
+
+auto TextureManager::load_texture(std::string filename, u32 magFilter,
+                                  u32 minFilter, bool repeat, bool flip,
+                                  bool vram) -> u32 {
+    if (auto id = acquire_existing(filename))
+        return id;
+
+    auto image = decode_image(filename, flip);
+    SC_CORE_ASSERT(image.pixels, "Could not load file: " + filename + "!");
+
+    auto id = create_entry(filename, magFilter, minFilter, repeat);
+    auto &slot = slots[handle_index(id)];
+    slot.source = TEXTURE_SOURCE_FILE;
+    slot.flip = flip;
+    slot.vram = vram;
+
+    finish_texture(id, image, vram);
+    return id;
+}
+
+auto TextureManager::load_cooked(std::string filename, u32 magFilter,
+                                 u32 minFilter, bool repeat, bool vram) -> u32 {
+    if (auto id = acquire_existing(filename))
+        return id;
+
+    auto id = create_entry(filename, magFilter, minFilter, repeat);
+    auto &slot = slots[handle_index(id)];
+    slot.source = TEXTURE_SOURCE_COOKED;
+    slot.vram = vram;
+
+    read_cooked(id, vram);
+    return id;
+}
+
+// Decodes one compressed level to RGBA8
+static auto decode_level(const CookedTextureHeader &header, const u8 *blocks,
+                         u32 *pixels, u32 width, u32 height) -> void {
+    if (header.format == COOKED_FORMAT_BC1)
+        PixelOps::decode_bc1(pixels, blocks, width, height);
+    else
+        PixelOps::decode_bc3(pixels, blocks, width, height);
 }
 
-auto TextureManager::bind_texture(u32 id) -> void {
-    if (fullMap.find(id) != fullMap.end()) {
 #if BUILD_PC || BUILD_PLAT == BUILD_VITA || BUILD_PLAT == BUILD_3DS
-        ((GI::TextureHandle*)fullMap[id]->data)->bind();
+// Decodes every level of a compressed cooked texture into an RGBA8 chain
+static auto decode_compressed(const CookedTextureHeader &header,
+                              const u8 *blocks) -> std::vector<u8> {
+    u64 total = 0;
+    for (u32 level = 0; level < header.levels; level++) {
+        u32 w, h;
+        cooked_level_size(header, level, w, h);
+        total += (u64)w * h * 4;
+    }
+
+    std::vector<u8> pixels(total);
+    auto dst = pixels.data();
+    for (u32 level = 0; level < header.levels; level++) {
+        u32 w, h;
+        auto size = cooked_level_size(header, level, w, h);
+        decode_level(header, blocks, (u32 *)dst, w, h);
+        blocks += size;
+        dst += (size_t)w * h * 4;
+    }
+
+    return pixels;
+}
+#endif
+
+auto TextureManager::read_cooked(u32 id, bool vram) -> void {
+    auto tex = resolve(id);
+    auto &filename = tex->name;
+
+    auto file = fopen(filename.c_str(), "rb");
+    SC_CORE_ASSERT(file, "Could not load file: " + filename + "!");
+
+    CookedTextureHeader header;
+    auto valid = fread(&header, sizeof(header), 1, file) == 1 &&
+                 memcmp(header.magic, COOKED_TEXTURE_MAGIC, 4) == 0 &&
+                 header.version == COOKED_TEXTURE_VERSION && header.levels > 0;
+    SC_CORE_ASSERT(valid, "Not a cooked texture of this version: " + filename + "!");
+
+    tex->width = header.width;
+    tex->height = header.height;
+    tex->pW = header.pW;
+    tex->pH = header.pH;
+
+#if BUILD_PC || BUILD_PLAT == BUILD_VITA || BUILD_PLAT == BUILD_3DS
+    SC_CORE_ASSERT((header.format == COOKED_FORMAT_8888 ||
+                    cooked_is_compressed(header.format)) &&
+                       !(header.flags & COOKED_FLAG_SWIZZLED),
+                   "Cooked texture is not in this platform's format: " + filename + "!");
+
+    std::vector<u8> pixels(header.dataSize);
+    auto read = fread(pixels.data(), 1, pixels.size(), file) == pixels.size();
+    fclose(file);
+    SC_CORE_ASSERT(read, "Truncated cooked texture: " + filename + "!");
+
+    if (cooked_is_compressed(header.format)) {
+        auto format = header.format == COOKED_FORMAT_BC1 ? GI::GI_COMPRESSED_BC1
+                                                         : GI::GI_COMPRESSED_BC3;
+        tex->data = GI::create_texturehandle_compressed(pixels.data(), format, header.pW, header.pH, header.levels, tex->magFilter, tex->minFilter, tex->repeating);
+        if (tex->data != nullptr) {
+            tex->id = ((GI::TextureHandle*)tex->data)->id;
+            account(id, header.dataSize);
+            return;
+        }
+
+        // The GPU cannot sample it, so it is uploaded as RGBA8
+        pixels = decode_compressed(header, pixels.data());
+    }
+
+    tex->data = GI::create_texturehandle_mipchain(pixels.data(), header.pW, header.pH, header.levels, tex->magFilter, tex->minFilter, tex->repeating);
+    tex->id = ((GI::TextureHandle*)tex->data)->id;
+
+    // A single level is completed on the GPU for mipmapped filters
+    u64 bytes = pixels.size();
+    if (header.levels == 1 && uses_mipmaps(tex->minFilter))
+        bytes += bytes / 3;
+    account(id, bytes);
 #elif BUILD_PLAT == BUILD_PSP
-        GI::enable(GI_TEXTURE_2D);
-        Texture *tex = fullMap[id];
+    if (cooked_is_compressed(header.format)) {
+        // The GE's own DXT block layout differs, so the first level is
+        // decoded and goes the way of a PNG
+        std::vector<u8> blocks(header.dataSize);
+        auto read = fread(blocks.data(), 1, blocks.size(), file) == blocks.size();
+        fclose(file);
+        SC_CORE_ASSERT(read, "Truncated cooked texture: " + filename + "!");
+
+        DecodedImage image;
+        image.width = header.pW;
+        image.height = header.pH;
+        image.pixels = (u8 *)malloc(image.width * image.height * 4);
+        decode_level(header, blocks.data(), (u32 *)image.pixels, image.width,
+                     image.height);
+
+        finish_texture(id, image, vram);
+        tex->width = header.width;
+        tex->height = header.height;
+        return;
+    }
+
+    SC_CORE_ASSERT((header.pW & (header.pW - 1)) == 0 && (header.pH & (header.pH - 1)) == 0,
+                   "Cooked texture is not padded to a power of two: " + filename + "!");
+
+    // The GE samples the first level where it lies, so it is read straight
+    // into its final buffer
+    u32 w, h;
+    auto size = cooked_level_size(header, 0, w, h);
+    void *pixels = vram ? vramalloc(size) : nullptr;
+    if (pixels == nullptr)
+        pixels = memalign(16, size);
+
+    auto read = fread(pixels, 1, size, file) == size;
+    fclose(file);
+    SC_CORE_ASSERT(read, "Truncated cooked texture: " + filename + "!");
+
+    tex->ramSpace = vram;
+    switch (header.format) {
+    case COOKED_FORMAT_4444:
+        tex->colorMode = GU_PSM_4444;
+        break;
+    case COOKED_FORMAT_5551:
+        tex->colorMode = GU_PSM_5551;
+        break;
+    case COOKED_FORMAT_565:
+        tex->colorMode = GU_PSM_5650;
+        break;
+    default:
+        tex->colorMode = GU_PSM_8888;
+        break;
+    }
+    tex->swizzle = (header.flags & COOKED_FLAG_SWIZZLED) ? 1 : 0;
+    tex->data = pixels;
+    account(id, size);
+
+    sceKernelDcacheWritebackInvalidateAll();
+#endif
+}
+
+auto TextureManager::load_texture_async(std::string filename, u32 magFilter,
+                                        u32 minFilter, bool repeat, bool flip,
+                                        bool vram) -> u32 {
+    if (auto id = acquire_existing(filename))
+        return id;
+
+    if (workers.empty())
+        start_workers();
+
+    auto id = create_entry(filename, magFilter, minFilter, repeat);
+    auto &slot = slots[handle_index(id)];
+    slot.source = TEXTURE_SOURCE_FILE;
+    slot.flip = flip;
+    slot.vram = vram;
+    pending.emplace(id, vram);
+
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        jobs.push_back({id, filename, flip});
+    }
+    jobReady.notify_one();
+
+    return id;
+}
 
-        sceGuTexMode(tex->colorMode, 0, 0, tex->swizzle);
-        sceGuTexFunc(GU_TFX_MODULATE, GU_TCC_RGBA);
-        sceGuTexFilter(tex->minFilter, tex->magFilter);
+// Copies an image with its edge pixels repeated into a 1 pixel border
+static auto blit_padded(DecodedImage &page, const DecodedImage &src, u32 x,
+                        u32 y) -> void {
+    auto dst = (u32 *)page.pixels;
+    auto pixels = (const u32 *)src.pixels;
 
-        auto repeat = tex->repeating ? GU_REPEAT : GU_CLAMP;
-        sceGuTexWrap(repeat, repeat);
+    for (u32 py = 0; py < src.height + 2; py++) {
+        auto sy = std::min(std::max(py, 1u) - 1, src.height - 1);
+        auto row = dst + (y + py) * page.width + x;
+        auto srcRow = pixels + sy * src.width;
+
+        row[0] = srcRow[0];
+        memcpy(row + 1, srcRow, src.width * 4);
+        row[src.width + 1] = srcRow[src.width - 1];
+    }
+}
+
+auto TextureManager::load_atlas(const std::vector<std::string> &filenames,
+                                u32 magFilter, u32 minFilter, bool flip,
+                                bool needPix, u32 pageSize) -> TextureAtlas {
+    struct Source {
+        DecodedImage image;
+        u32 page, x, y;
+    };
+
+    TextureAtlas atlas;
+    std::vector<Source> sources;
+    sources.reserve(filenames.size());
+    for (auto &f : filenames) {
+        auto image = decode_image(f, flip);
+        SC_CORE_ASSERT(image.pixels, "Could not load file: " + f + "!");
+        SC_CORE_ASSERT(image.width + 2 <= pageSize && image.height + 2 <= pageSize,
+                       "Image does not fit an atlas page: " + f + "!");
+        sources.push_back({image, 0, 0, 0});
+    }
+
+    // Tallest first keeps the skyline flat
+    std::vector<size_t> order(sources.size());
+    for (size_t i = 0; i < order.size(); i++)
+        order[i] = i;
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        auto &ia = sources[a].image;
+        auto &ib = sources[b].image;
+        return ia.height != ib.height ? ia.height > ib.height
+                                      : ia.width > ib.width;
+    });
+
+    std::vector<SkylinePacker> packers;
+    for (auto i : order) {
+        auto &src = sources[i];
+        auto w = src.image.width + 2;
+        auto h = src.image.height + 2;
+
+        src.page = static_cast<u32>(packers.size());
+        for (u32 p = 0; p < packers.size(); p++) {
+            if (packers[p].insert(w, h, src.x, src.y)) {
+                src.page = p;
+                break;
+            }
+        }
+
+        if (src.page == packers.size()) {
+            packers.emplace_back(pageSize, pageSize);
+            packers.back().insert(w, h, src.x, src.y);
+        }
+
+        atlas.usedArea += (u64)src.image.width * src.image.height;
+    }
+
+    // Pages are cut down to the power of two holding their content
+    std::vector<DecodedImage> pages(packers.size());
+    for (size_t p = 0; p < pages.size(); p++) {
+        pages[p].width = pageSize;
+        pages[p].height = std::min(pow2(packers[p].get_used_height()), pageSize);
+        pages[p].pixels = (u8 *)calloc(pages[p].width * pages[p].height, 4);
+        atlas.pageArea += (u64)pages[p].width * pages[p].height;
+    }
 
-        sceGuTexImage(0, tex->pW, tex->pH, tex->pW, tex->data);
+    for (auto &src : sources)
+        blit_padded(pages[src.page], src.image, src.x, src.y);
+
+    for (size_t p = 0; p < pages.size(); p++) {
+        auto name = "atlas:" + std::to_string(atlasCount) + ":" + std::to_string(p);
+        auto id = create_entry(name, magFilter, minFilter, false);
+        auto tex = resolve(id);
+
+        if (needPix) {
+            auto size = pages[p].width * pages[p].height * 4;
+            tex->pixData = malloc(size);
+            memcpy(tex->pixData, pages[p].pixels, size);
+        }
+
+        finish_texture(id, pages[p], false);
+        atlas.pages.push_back(id);
+    }
+    atlasCount++;
+
+    for (size_t i = 0; i < sources.size(); i++) {
+        auto &src = sources[i];
+        auto page = resolve(atlas.pages[src.page]);
+
+        AtlasRegion region;
+        region.texture = atlas.pages[src.page];
+        region.x = src.x + 1;
+        region.y = src.y + 1;
+        region.width = src.image.width;
+        region.height = src.image.height;
+        region.selection = Rectangle{
+            {(float)region.x / (float)page->width,
+             (float)region.y / (float)page->height},
+            {(float)region.width / (float)page->width,
+             (float)region.height / (float)page->height}};
+        atlas.regions[filenames[i]] = region;
+
+        free_image(src.image);
+    }
+
+    auto images = sources.size();
+    auto pageCount = pages.size();
+    auto ratio = atlas.packing_ratio() * 100.0f;
+    SC_CORE_INFO("Packed {} images into {} atlas pages, {}% used", images,
+                 pageCount, ratio);
+
+    return atlas;
+}
+
+auto TextureManager::delete_atlas(TextureAtlas &atlas) -> void {
+    for (auto id : atlas.pages)
+        delete_texture(id);
+
+    atlas = TextureAtlas();
+}
+
+auto TextureManager::load_texture_array(const std::vector<std::string> &filenames,
+                                        u32 magFilter, u32 minFilter,
+                                        bool repeat, bool flip) -> TextureArray {
+    TextureArray array;
+
+    std::vector<DecodedImage> images;
+    images.reserve(filenames.size());
+    for (auto &f : filenames) {
+        auto image = decode_image(f, flip);
+        SC_CORE_ASSERT(image.pixels, "Could not load file: " + f + "!");
+        images.push_back(image);
+    }
+
+    // Images of one size share an array, in load order
+    std::map<std::pair<u32, u32>, std::vector<size_t>> groups;
+    for (size_t i = 0; i < images.size(); i++)
+        groups[{images[i].width, images[i].height}].push_back(i);
+
+    for (auto &group : groups) {
+        auto width = group.first.first;
+        auto height = group.first.second;
+        auto &members = group.second;
+
+        for (size_t first = 0; first < members.size(); first += MAX_ARRAY_LAYERS) {
+            auto count = std::min<size_t>(MAX_ARRAY_LAYERS, members.size() - first);
+
+            GI::TextureHandle *handle = nullptr;
+#if SC_TEXTURE_ARRAYS
+            std::vector<const u8 *> layers(count);
+            for (size_t l = 0; l < count; l++)
+                layers[l] = images[members[first + l]].pixels;
+
+            handle = GI::create_texturehandle_array(layers.data(), static_cast<u32>(count),
+                                                    width, height, magFilter,
+                                                    minFilter, repeat);
 #endif
+
+            if (handle != nullptr) {
+                auto name = "array:" + std::to_string(arrayCount++);
+                auto id = create_entry(name, magFilter, minFilter, repeat);
+                auto tex = resolve(id);
+                tex->width = width;
+                tex->height = height;
+                tex->pW = pow2(width);
+                tex->pH = pow2(height);
+                tex->data = handle;
+                tex->id = handle->id;
+                account(id, texture_bytes(tex) * count);
+
+                array.textures.push_back(id);
+                for (size_t l = 0; l < count; l++) {
+                    auto index = members[first + l];
+                    array.sheets[filenames[index]] =
+                        TextureSheet{id, static_cast<u16>(l), width, height};
+                    free_image(images[index]);
+                }
+                continue;
+            }
+
+            // No array support, the images become plain textures
+            for (size_t l = 0; l < count; l++) {
+                auto index = members[first + l];
+                auto &filename = filenames[index];
+
+                auto id = acquire_existing(filename);
+                if (id != 0) {
+                    free_image(images[index]);
+                } else {
+                    id = create_entry(filename, magFilter, minFilter, repeat);
+                    auto &slot = slots[handle_index(id)];
+                    slot.source = TEXTURE_SOURCE_FILE;
+                    slot.flip = flip;
+                    finish_texture(id, images[index], false);
+                }
+
+                array.textures.push_back(id);
+                array.sheets[filename] = TextureSheet{id, 0, width, height};
+            }
+        }
+    }
+
+    return array;
+}
+
+auto TextureManager::delete_texture_array(TextureArray &array) -> void {
+    for (auto id : array.textures)
+        delete_texture(id);
+
+    array = TextureArray();
+}
+
+auto TextureManager::is_texture_ready(u32 id) -> bool {
+    return resolve(id) != nullptr && pending.find(id) == pending.end();
+}
+
+auto TextureManager::start_workers() -> void {
+    stopping = false;
+
+    // Leave a core for the render thread
+    auto count = std::thread::hardware_concurrency();
+    count = count > 1 ? std::min(count - 1, MAX_DECODE_WORKERS) : 1;
+
+    for (u32 i = 0; i < count; i++)
+        workers.emplace_back(&TextureManager::decode_worker, this);
+}
+
+auto TextureManager::stop_workers() -> void {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    jobReady.notify_all();
+    resultTaken.notify_all();
+
+    for (auto &w : workers)
+        w.join();
+    workers.clear();
+
+    for (auto &r : decoded)
+        free_image(r.image);
+    decoded.clear();
+    jobs.clear();
+}
+
+auto TextureManager::decode_worker() -> void {
+    while (true) {
+        DecodeJob job;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            jobReady.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (stopping)
+                return;
+
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        auto image = decode_image(job.filename, job.flip);
+
+        // Bounded, so decoding can't run arbitrarily far ahead of uploads
+        std::unique_lock<std::mutex> lock(queueMutex);
+        resultTaken.wait(lock, [this] {
+            return stopping || decoded.size() < MAX_DECODED_TEXTURES;
+        });
+        if (stopping) {
+            free_image(image);
+            return;
+        }
+        decoded.push_back({job.id, image});
+    }
+}
+
+auto TextureManager::process_uploads() -> void {
+    if (pending.empty())
+        return;
+
+    // At least one texture is uploaded per call, then only within budget
+    auto start = std::chrono::steady_clock::now();
+    auto budget = std::chrono::duration<double, std::milli>(uploadBudget);
+    while (std::chrono::steady_clock::now() - start < budget) {
+        DecodeResult result;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            if (decoded.empty())
+                return;
+
+            result = decoded.front();
+            decoded.pop_front();
+        }
+        resultTaken.notify_one();
+
+        // Deleted before it finished decoding
+        auto it = pending.find(result.id);
+        if (it == pending.end()) {
+            free_image(result.image);
+            continue;
+        }
+
+        auto vram = it->second;
+        pending.erase(it);
+
+        auto tex = resolve(result.id);
+        SC_CORE_ASSERT(result.image.pixels, "Could not load file: " + tex->name + "!");
+        finish_texture(result.id, result.image, vram);
+    }
+}
+
+auto TextureManager::bind_texture(u32 id) -> void {
+    auto tex = resolve(id);
+    if (tex == nullptr)
+        return;
+
+    auto &slot = slots[handle_index(id)];
+    slot.lastBound = frame;
+    if (slot.evicted)
+        reload(id);
+
+    // Still decoding, draw untextured until it is uploaded
+    if (tex->data == nullptr) {
+        GI::disable(GI_TEXTURE_2D);
+        return;
     }
+
+    GI::frameStats.texture_binds++;
+#if BUILD_PC || BUILD_PLAT == BUILD_VITA || BUILD_PLAT == BUILD_3DS
+    ((GI::TextureHandle*)tex->data)->bind();
+#elif BUILD_PLAT == BUILD_PSP
+    GI::enable(GI_TEXTURE_2D);
+
+    sceGuTexMode(tex->colorMode, 0, 0, tex->swizzle);
+    sceGuTexFunc(GU_TFX_MODULATE, GU_TCC_RGBA);
+    sceGuTexFilter(tex->minFilter, tex->magFilter);
+
+    auto repeat = tex->repeating ? GU_REPEAT : GU_CLAMP;
+    sceGuTexWrap(repeat, repeat);
+
+    sceGuTexImage(0, tex->pW, tex->pH, tex->pW, tex->data);
+#endif
 }
 
 auto TextureManager::delete_texture(u32 id) -> void {
-    if (fullMap.find(id) != fullMap.end()) {
+    if (resolve(id) == nullptr)
+        return;
+
+    auto &slot = slots[handle_index(id)];
+    if (--slot.refs == 0)
+        destroy(id);
+}
+
+auto TextureManager::destroy(u32 id) -> void {
+    auto &slot = slots[handle_index(id)];
+    auto tex = slot.texture;
+
+    release_gpu(tex);
+    if (tex->pixData)
+        free(tex->pixData);
+
+    gpuTotal -= slot.gpuBytes;
+    cpuTotal -= slot.cpuBytes;
 
+    auto it = nameIndex.find(tex->name);
+    if (it != nameIndex.end() && it->second == id)
+        nameIndex.erase(it);
+
+    pending.erase(id);
+    delete tex;
+
+    // Bumping the generation invalidates every outstanding handle
+    slot = TextureSlot{nullptr, slot.generation};
+    slot.generation = (slot.generation + 1) & HANDLE_GENERATION_MASK;
+    if (slot.generation == 0)
+        slot.generation = 1;
+    freeSlots.push_back(handle_index(id));
+}
+
+auto TextureManager::release_gpu(Texture *tex) -> void {
 #if BUILD_PC || BUILD_PLAT == BUILD_VITA || BUILD_PLAT == BUILD_3DS
-        auto tex = (GI::TextureHandle*)fullMap[id]->data;
-        delete tex;
+    delete (GI::TextureHandle*)tex->data;
 #endif
 
-        if (fullMap[id]->data)
 #if PSP
-            free(fullMap[id]->data);
+    if (tex->data)
+        free(tex->data);
 #endif
 
-        delete fullMap[id];
-        fullMap.erase(id);
+    tex->data = nullptr;
+}
+
+auto TextureManager::account(u32 id, u64 gpuBytes) -> void {
+    auto &slot = slots[handle_index(id)];
+    auto tex = slot.texture;
+
+    // A fresh upload counts as a bind, so evictionAge protects textures that
+    // are loaded or reloaded but not drawn yet
+    slot.lastBound = frame;
+
+    gpuTotal -= slot.gpuBytes;
+    cpuTotal -= slot.cpuBytes;
+    slot.gpuBytes = gpuBytes;
+    slot.cpuBytes = tex->pixData ? (u64)tex->width * tex->height * 4 : 0;
+    gpuTotal += slot.gpuBytes;
+    cpuTotal += slot.cpuBytes;
+}
+
+auto TextureManager::evict(u32 index) -> void {
+    auto &slot = slots[index];
+
+    release_gpu(slot.texture);
+    gpuTotal -= slot.gpuBytes;
+    slot.gpuBytes = 0;
+    slot.evicted = true;
+}
+
+auto TextureManager::reload(u32 id) -> void {
+    auto &slot = slots[handle_index(id)];
+    slot.evicted = false;
+
+    if (slot.source == TEXTURE_SOURCE_COOKED) {
+        read_cooked(id, slot.vram);
+        return;
     }
+
+    auto image = decode_image(slot.texture->name, slot.flip);
+    SC_CORE_ASSERT(image.pixels, "Could not reload file: " + slot.texture->name + "!");
+    finish_texture(id, image, slot.vram);
+}
+
+auto TextureManager::enforce_budget() -> void {
+    if (memoryBudget == 0 || gpuTotal + cpuTotal <= memoryBudget) {
+        overBudget = false;
+        return;
+    }
+
+    // Only textures that can be reloaded from their file, and not PSP VRAM,
+    // whose allocations are never returned
+    std::vector<u32> candidates;
+    for (u32 i = 0; i < slots.size(); i++) {
+        auto &slot = slots[i];
+        if (slot.texture == nullptr || slot.evicted || slot.vram ||
+            slot.texture->data == nullptr ||
+            slot.source == TEXTURE_SOURCE_MEMORY ||
+            frame - slot.lastBound < evictionAge)
+            continue;
+        candidates.push_back(i);
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [this](u32 a, u32 b) {
+        return slots[a].lastBound < slots[b].lastBound;
+    });
+
+    for (auto i : candidates) {
+        if (gpuTotal + cpuTotal <= memoryBudget)
+            break;
+        evict(i);
+    }
+
+    // Warn once each time usage stays over budget
+    auto used = gpuTotal + cpuTotal;
+    if (used > memoryBudget && !overBudget) {
+        auto budget = memoryBudget;
+        SC_CORE_WARN("Texture memory over budget: {} of {} bytes", used, budget);
+    }
+    overBudget = used > memoryBudget;
+}
+
+auto TextureManager::begin_frame() -> void {
+    frame++;
+    process_uploads();
+    enforce_budget();
+}
+
+auto TextureManager::get_memory_stats() const -> TextureMemoryStats {
+    TextureMemoryStats stats;
+    stats.gpu_bytes = gpuTotal;
+    stats.cpu_bytes = cpuTotal;
+    stats.budget = memoryBudget;
+
+    for (auto &slot : slots) {
+        if (slot.texture == nullptr)
+            continue;
+        stats.textures++;
+        if (slot.evicted)
+            stats.evicted++;
+    }
+
+    return stats;
+}
+
+auto TextureManager::get_texture_memory(u32 id) -> u64 {
+    if (resolve(id) == nullptr)
+        return 0;
+
+    auto &slot = slots[handle_index(id)];
+    return slot.gpuBytes + slot.cpuBytes;
+}
+
+auto TextureManager::release_pixels(u32 id) -> void {
+    auto tex = resolve(id);
+    if (tex == nullptr || tex->pixData == nullptr)
+        return;
+
+    free(tex->pixData);
+    tex->pixData = nullptr;
+
+    auto &slot = slots[handle_index(id)];
+    cpuTotal -= slot.cpuBytes;
+    slot.cpuBytes = 0;
 }
 
 TextureManager::~TextureManager() {
-#if USE_EASTL
-    eastl::vector<u32> ids;
-#else
-    std::vector<u32> ids;
-#endif
-    for (auto &[key, val] : fullMap)
-        ids.push_back(key);
+    if (!workers.empty())
+        stop_workers();
 
-    for (auto id : ids)
-        delete_texture(id);
+    for (u32 i = 0; i < slots.size(); i++) {
+        if (slots[i].texture != nullptr)
+            destroy((slots[i].generation << HANDLE_INDEX_BITS) | i);
+    }
 }
 
 } // namespace Stardust_Celeste::Rendering
\ No newline at end of file
@@ -0,0 +1,82 @@
+#include <Rendering/TextureAtlas.hpp>
+#include <algorithm>
+
+namespace Stardust_Celeste::Rendering {
+
+SkylinePacker::SkylinePacker(u32 w, u32 h)
+    : width(static_cast<s32>(w)), height(static_cast<s32>(h)), usedHeight(0) {
+    skyline.push_back({0, 0, width});
+}
+
+auto SkylinePacker::fit(size_t index, s32 w, s32 h, s32 &y) const -> bool {
+    auto x = skyline[index].x;
+    if (x + w > width)
+        return false;
+
+    // The rectangle rests on the highest segment it spans
+    y = 0;
+    auto remaining = w;
+    for (auto i = index; remaining > 0; i++) {
+        y = std::max(y, skyline[i].y);
+        if (y + h > height)
+            return false;
+        remaining -= skyline[i].width;
+    }
+
+    return true;
+}
+
+auto SkylinePacker::insert(u32 w, u32 h, u32 &outX, u32 &outY) -> bool {
+    auto rw = static_cast<s32>(w);
+    auto rh = static_cast<s32>(h);
+
+    size_t best = skyline.size();
+    s32 bestTop = height + 1;
+    s32 bestY = 0;
+
+    for (size_t i = 0; i < skyline.size(); i++) {
+        s32 y;
+        if (fit(i, rw, rh, y) && y + rh < bestTop) {
+            best = i;
+            bestTop = y + rh;
+            bestY = y;
+        }
+    }
+
+    if (best == skyline.size())
+        return false;
+
+    auto x = skyline[best].x;
+    skyline.insert(skyline.begin() + best, {x, bestTop, rw});
+
+    // Trim the segments now covered by the new one
+    for (auto i = best + 1; i < skyline.size();) {
+        auto &prev = skyline[i - 1];
+        auto overlap = prev.x + prev.width - skyline[i].x;
+        if (overlap <= 0)
+            break;
+
+        skyline[i].x += overlap;
+        skyline[i].width -= overlap;
+        if (skyline[i].width > 0)
+            break;
+        skyline.erase(skyline.begin() + i);
+    }
+
+    // Merge neighbours at the same height
+    for (size_t i = 0; i + 1 < skyline.size();) {
+        if (skyline[i].y == skyline[i + 1].y) {
+            skyline[i].width += skyline[i + 1].width;
+            skyline.erase(skyline.begin() + i + 1);
+        } else {
+            i++;
+        }
+    }
+
+    outX = static_cast<u32>(x);
+    outY = static_cast<u32>(bestY);
+    usedHeight = std::max(usedHeight, static_cast<u32>(bestTop));
+    return true;
+}
+
+} // namespace Stardust_Celeste::Rendering
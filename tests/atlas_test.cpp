@@ -0,0 +1,100 @@
+#include <Rendering/TextureAtlas.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+using namespace Stardust_Celeste;
+using namespace Stardust_Celeste::Rendering;
+
+// Packs a fixed set of sprite sized rectangles the way load_atlas does and
+// checks that none overlap and the page is filled well enough to be worth it
+
+struct Rect {
+    u32 x, y, w, h;
+};
+
+constexpr u32 PAGE_SIZE = 1024;
+constexpr u32 RECT_COUNT = 300;
+
+// Share of the used page area the rectangles must cover
+constexpr float TARGET_OCCUPANCY = 0.85f;
+
+// Fixed seed, 1 pixel borders added like load_atlas does
+static auto make_rects() -> std::vector<Rect> {
+    std::vector<Rect> rects;
+    u32 state = 0xC0FFEE;
+    auto next = [&](u32 lo, u32 hi) {
+        state = state * 1664525 + 1013904223;
+        return lo + (state >> 8) % (hi - lo + 1);
+    };
+
+    for (u32 i = 0; i < RECT_COUNT; i++)
+        rects.push_back({0, 0, next(8, 64) + 2, next(8, 64) + 2});
+
+    // Tallest first, as load_atlas packs them
+    std::sort(rects.begin(), rects.end(), [](const Rect &a, const Rect &b) {
+        return a.h != b.h ? a.h > b.h : a.w > b.w;
+    });
+    return rects;
+}
+
+static auto overlap(const Rect &a, const Rect &b) -> bool {
+    return a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h &&
+           b.y < a.y + a.h;
+}
+
+auto main() -> int {
+    auto rects = make_rects();
+    SkylinePacker packer(PAGE_SIZE, PAGE_SIZE);
+
+    u64 area = 0;
+    for (auto &r : rects) {
+        if (!packer.insert(r.w, r.h, r.x, r.y)) {
+            fprintf(stderr, "TEST FAILED! %ux%u did not fit the page\n", r.w,
+                    r.h);
+            return 1;
+        }
+        area += (u64)r.w * r.h;
+    }
+
+    for (size_t i = 0; i < rects.size(); i++) {
+        auto &a = rects[i];
+        if (a.x + a.w > PAGE_SIZE || a.y + a.h > packer.get_used_height()) {
+            fprintf(stderr, "TEST FAILED! rect %zu at %u,%u leaves the page\n",
+                    i, a.x, a.y);
+            return 1;
+        }
+
+        for (size_t j = i + 1; j < rects.size(); j++) {
+            if (overlap(a, rects[j])) {
+                fprintf(stderr, "TEST FAILED! rects %zu and %zu overlap\n", i, j);
+                return 1;
+            }
+        }
+    }
+
+    auto occupancy = (float)area / (float)(PAGE_SIZE * packer.get_used_height());
+    printf("Packed %u rects into %ux%u, occupancy %.1f%% (target %.1f%%)\n",
+           RECT_COUNT, PAGE_SIZE, packer.get_used_height(), occupancy * 100.0f,
+           TARGET_OCCUPANCY * 100.0f);
+    if (occupancy < TARGET_OCCUPANCY) {
+        fprintf(stderr, "TEST FAILED! occupancy is under the target\n");
+        return 1;
+    }
+
+    // Full and oversized pages must refuse instead of overlapping
+    SkylinePacker full(64, 64);
+    u32 x, y;
+    for (u32 i = 0; i < 16; i++) {
+        if (!full.insert(16, 16, x, y)) {
+            fprintf(stderr, "TEST FAILED! exact fit rejected at %u\n", i);
+            return 1;
+        }
+    }
+    if (full.insert(1, 1, x, y) || SkylinePacker(64, 64).insert(65, 1, x, y)) {
+        fprintf(stderr, "TEST FAILED! rect placed outside a full page\n");
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <GLFW/glfw3.h>
+#include <Rendering/RenderContext.hpp>
+#include <Utilities/Logger.hpp>
+
+// Exit code ctest reports as skipped, see SKIP_RETURN_CODE
+constexpr int SKIP_TEST = 77;
+
+/**
+ * @brief Opens a hidden window and initializes the RenderContext on it
+ *
+ * @return false if there is no display or no OpenGL 4.0 here, where GI::init
+ * would assert
+ */
+inline auto init_gl_context() -> bool {
+    using namespace Stardust_Celeste;
+
+    if (!glfwInit())
+        return false;
+
+    // GI::init sets its own hints over these but keeps the window hidden
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    glfwWindowHint(GLFW_CLIENT_API, GLFW_OPENGL_API);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 0);
+
+    auto probe = glfwCreateWindow(64, 64, "probe", nullptr, nullptr);
+    if (probe == nullptr) {
+        glfwTerminate();
+        return false;
+    }
+    glfwDestroyWindow(probe);
+
+    Utilities::Logger::init();
+
+    RenderContextSettings settings;
+    settings.width = 64;
+    settings.height = 64;
+    settings.title = "Stardust Test";
+    settings.shaderCachePath = nullptr;
+    Rendering::RenderContext::get().initialize(settings);
+    return true;
+}
@@ -0,0 +1,109 @@
+#include "gl_context.hpp"
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+using namespace Stardust_Celeste;
+using namespace Stardust_Celeste::Rendering;
+
+// CPU time per frame of 10k set_matrices calls under a 4 deep matrix stack.
+// The old path is replayed for comparison: the stack multiplied out on every
+// draw and all three matrices written with glBufferSubData.
+
+constexpr u32 DRAWS = 10000;
+constexpr u32 FRAMES = 30;
+constexpr u32 STACK_DEPTH = 4;
+
+using Matrix = mathfu::Matrix<float, 4>;
+
+struct OldUBO {
+    Matrix proj, view, model;
+};
+
+// Average milliseconds of one frame's draw loop
+template <typename F> static auto time_frames(F &&draws) -> double {
+    auto &ctx = RenderContext::get();
+    double total = 0;
+    for (u32 f = 0; f < FRAMES; f++) {
+        ctx.clear();
+        auto start = std::chrono::steady_clock::now();
+        draws();
+        std::chrono::duration<double, std::milli> took =
+            std::chrono::steady_clock::now() - start;
+        total += took.count();
+        ctx.render();
+    }
+    return total / FRAMES;
+}
+
+auto main() -> int {
+    if (!init_gl_context()) {
+        printf("No OpenGL 4.0 context, skipping\n");
+        return SKIP_TEST;
+    }
+
+    auto &ctx = RenderContext::get();
+    ctx.set_mode_3D();
+
+    std::vector<Matrix> stack;
+    for (u32 i = 0; i < STACK_DEPTH; i++) {
+        auto m = Matrix::FromTranslationVector({1.0f, 0.0f, -0.5f});
+        stack.push_back(m);
+        ctx.matrix_model(m);
+        ctx.matrix_push();
+    }
+
+    GLuint oldBuffer;
+    glGenBuffers(1, &oldBuffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, oldBuffer);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(OldUBO), nullptr, GL_DYNAMIC_DRAW);
+    OldUBO old{Matrix::Identity(), Matrix::Identity(), Matrix::Identity()};
+
+    auto before = time_frames([&] {
+        for (u32 i = 0; i < DRAWS; i++) {
+            auto model = Matrix::FromTranslationVector({0.001f * i, 0.0f, 0.0f});
+            auto product = Matrix::Identity();
+            for (auto &m : stack)
+                product *= m;
+            old.model = product * model;
+
+            glBindBuffer(GL_UNIFORM_BUFFER, oldBuffer);
+            glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(OldUBO), &old);
+        }
+    });
+
+    // Every draw moves, so every draw uploads
+    auto moving = time_frames([&] {
+        for (u32 i = 0; i < DRAWS; i++) {
+            ctx.matrix_model(
+                Matrix::FromTranslationVector({0.001f * i, 0.0f, 0.0f}));
+            ctx.set_matrices();
+        }
+    });
+    auto movingUploads = GI::get_frame_stats().matrix_uploads;
+
+    // Draws sharing a transform, as sprites in one batch do
+    auto still = time_frames([&] {
+        for (u32 i = 0; i < DRAWS; i++)
+            ctx.set_matrices();
+    });
+    auto stillUploads = GI::get_frame_stats().matrix_uploads;
+
+    printf("%u set_matrices per frame, stack depth %u, CPU ms per frame:\n",
+           DRAWS, STACK_DEPTH);
+    printf("  old full upload     %8.3f\n", before);
+    printf("  cached, all dirty   %8.3f  (%u uploads)\n", moving, movingUploads);
+    printf("  cached, all clean   %8.3f  (%u uploads)\n", still, stillUploads);
+
+    glDeleteBuffers(1, &oldBuffer);
+    for (u32 i = 0; i < STACK_DEPTH; i++)
+        ctx.matrix_pop();
+    RenderContext::get().terminate();
+
+    if (movingUploads < DRAWS || stillUploads > 1) {
+        fprintf(stderr, "TEST FAILED! set_matrices uploaded %u and %u times\n",
+                movingUploads, stillUploads);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,91 @@
+#include "gl_context.hpp"
+#include <Rendering/Mesh.hpp>
+#include <cstdio>
+
+using namespace Stardust_Celeste;
+using namespace Stardust_Celeste::Rendering;
+
+// Edits a large static mesh and checks through FrameStats that only the
+// dirty span reaches the GPU, not the whole buffer
+
+constexpr size_t VERTEX_COUNT = 40000;
+constexpr size_t INDEX_COUNT = 60000;
+
+struct Expect {
+    const char *name;
+    u32 uploads;
+    size_t bytes;
+};
+
+// Stats of one frame doing only the update
+static auto frame(Mesh<Vertex> &mesh) -> GI::FrameStats {
+    auto &ctx = RenderContext::get();
+    ctx.clear();
+    mesh.update_buffer();
+    ctx.render();
+    return GI::get_frame_stats();
+}
+
+static auto check(const Expect &expect, const GI::FrameStats &stats) -> bool {
+    printf("  %-24s %u uploads, %zu bytes\n", expect.name, stats.buffer_uploads,
+           stats.bytes_uploaded);
+    if (stats.buffer_uploads != expect.uploads ||
+        stats.bytes_uploaded != expect.bytes) {
+        fprintf(stderr, "TEST FAILED! %s: expected %u uploads, %zu bytes\n",
+                expect.name, expect.uploads, expect.bytes);
+        return false;
+    }
+    return true;
+}
+
+auto main() -> int {
+    if (!init_gl_context()) {
+        printf("No OpenGL 4.0 context, skipping\n");
+        return SKIP_TEST;
+    }
+
+    Mesh<Vertex> mesh;
+    mesh.vertices.resize(VERTEX_COUNT);
+    mesh.indices.resize(INDEX_COUNT);
+    for (size_t i = 0; i < INDEX_COUNT; i++)
+        mesh.indices[i] = static_cast<u16>(i % VERTEX_COUNT);
+    mesh.setup_buffer();
+
+    bool ok = true;
+
+    // Clean meshes upload nothing
+    ok = check({"no edit", 0, 0}, frame(mesh)) && ok;
+
+    mesh.vertices[20000].x = 1.0f;
+    mesh.mark_vertices_dirty(20000, 1);
+    ok = check({"one vertex", 1, sizeof(Vertex)}, frame(mesh)) && ok;
+
+    for (size_t i = 100; i < 164; i++)
+        mesh.vertices[i].y = 2.0f;
+    mesh.mark_vertices_dirty(100, 64);
+    ok = check({"vertex range", 1, 64 * sizeof(Vertex)}, frame(mesh)) && ok;
+
+    // Separate edits are merged into one span, 500 to 599
+    mesh.mark_vertices_dirty(500, 10);
+    mesh.mark_vertices_dirty(590, 10);
+    ok = check({"merged vertex ranges", 1, 100 * sizeof(Vertex)}, frame(mesh)) &&
+         ok;
+
+    mesh.mark_vertices_dirty(7, 3);
+    mesh.mark_indices_dirty(30, 6);
+    ok = check({"vertices and indices", 1, 3 * sizeof(Vertex) + 6 * sizeof(u16)},
+               frame(mesh)) &&
+         ok;
+
+    // A size change falls back to a full upload
+    mesh.vertices.push_back(Vertex());
+    mesh.mark_vertices_dirty(VERTEX_COUNT, 1);
+    ok = check({"resized", 1,
+                (VERTEX_COUNT + 1) * sizeof(Vertex) + INDEX_COUNT * sizeof(u16)},
+               frame(mesh)) &&
+         ok;
+
+    mesh.delete_data();
+    RenderContext::get().terminate();
+    return ok ? 0 : 1;
+}
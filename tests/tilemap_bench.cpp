@@ -0,0 +1,96 @@
+#include <Graphics/2D/Tilemap.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+using namespace Stardust_Celeste;
+using namespace Stardust_Celeste::Graphics::G2D;
+using namespace Stardust_Celeste::Rendering;
+
+// Times the vertex build generate_map runs for 100k tiles on one thread and
+// on every hardware thread, and checks both give the same vertices. The
+// upload is left out so it runs without a GPU.
+
+constexpr size_t TILE_COUNT = 100000;
+constexpr size_t MAP_WIDTH = 400;
+constexpr u32 RUNS = 20;
+
+class BenchTilemap : public Tilemap {
+  public:
+    // Only handed to the GPU on upload, which this never does
+    BenchTilemap() : Tilemap(1, {16, 16}) {}
+
+    // Threads build_tiles splits a map of count tiles across
+    static auto threads_for(size_t count, u32 maxThreads) -> size_t {
+        return std::max<size_t>(1, std::min<size_t>(maxThreads, count / TILES_PER_THREAD));
+    }
+
+    // generate_map without the upload
+    auto build() -> void {
+        resize_meshes(tileMap.size());
+        build_tiles(tileMap.data(), tileMap.size());
+    }
+
+    auto same_vertices(const BenchTilemap &other) const -> bool {
+        if (meshes.size() != other.meshes.size())
+            return false;
+        for (size_t m = 0; m < meshes.size(); m++) {
+            auto &a = meshes[m]->vertices;
+            auto &b = other.meshes[m]->vertices;
+            if (a.size() != b.size() ||
+                memcmp(a.data(), b.data(), a.size() * sizeof(Vertex)) != 0)
+                return false;
+        }
+        return true;
+    }
+};
+
+// Best of several builds, in milliseconds -- the first warms the capacity
+static auto time_build(BenchTilemap &map) -> double {
+    double best = 0;
+    for (u32 i = 0; i < RUNS; i++) {
+        auto start = std::chrono::steady_clock::now();
+        map.build();
+        std::chrono::duration<double, std::milli> took =
+            std::chrono::steady_clock::now() - start;
+        if (i == 0 || took.count() < best)
+            best = took.count();
+    }
+    return best;
+}
+
+auto main() -> int {
+    std::vector<Tile> tiles(TILE_COUNT);
+    for (size_t i = 0; i < TILE_COUNT; i++) {
+        auto &t = tiles[i];
+        t.bounds = {{(float)(i % MAP_WIDTH) * 16.0f, (float)(i / MAP_WIDTH) * 16.0f},
+                    {16.0f, 16.0f}};
+        t.color.color = 0xFFFFFFFF;
+        t.index = static_cast<u16>(i % 256);
+        t.layer = 0.0f;
+    }
+
+    BenchTilemap single, threaded;
+    single.add_tiles(tiles);
+    threaded.add_tiles(tiles);
+    // At least two, so the split is checked on single core machines too
+    auto threads = std::max(2u, std::thread::hardware_concurrency());
+    single.set_max_threads(1);
+    threaded.set_max_threads(threads);
+
+    auto singleMs = time_build(single);
+    auto threadedMs = time_build(threaded);
+
+    printf("%zu tiles, best of %u builds:\n", TILE_COUNT, RUNS);
+    printf("  1 thread    %8.3f ms\n", singleMs);
+    printf("  %zu threads   %8.3f ms  x%.2f\n",
+           BenchTilemap::threads_for(TILE_COUNT, threads), threadedMs,
+           threadedMs > 0 ? singleMs / threadedMs : 0);
+
+    if (!single.same_vertices(threaded)) {
+        fprintf(stderr, "TEST FAILED! threaded build differs from single thread\n");
+        return 1;
+    }
+    return 0;
+}
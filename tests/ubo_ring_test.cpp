@@ -0,0 +1,79 @@
+#include "gl_context.hpp"
+#include <cstdio>
+#include <vector>
+
+using namespace Stardust_Celeste;
+using namespace Stardust_Celeste::Rendering;
+
+// Each frame draws once with unchanged matrices, then once with a new model.
+// The block the clean draw reads must survive the dirty draw's append, over
+// more frames than the uniform ring has regions.
+
+constexpr u32 FRAMES = 8;
+
+using Matrix = mathfu::Matrix<float, 4>;
+
+struct Binding {
+    GLint buffer = 0, start = 0, size = 0;
+};
+
+static auto bound_block() -> Binding {
+    Binding b;
+    glGetIntegeri_v(GL_UNIFORM_BUFFER_BINDING, 0, &b.buffer);
+    glGetIntegeri_v(GL_UNIFORM_BUFFER_START, 0, &b.start);
+    glGetIntegeri_v(GL_UNIFORM_BUFFER_SIZE, 0, &b.size);
+    return b;
+}
+
+static auto read_block(const Binding &b) -> std::vector<u8> {
+    std::vector<u8> data(b.size);
+    glBindBuffer(GL_UNIFORM_BUFFER, b.buffer);
+    glGetBufferSubData(GL_UNIFORM_BUFFER, b.start, b.size, data.data());
+    return data;
+}
+
+auto main() -> int {
+    if (!init_gl_context()) {
+        printf("No OpenGL 4.0 context, skipping\n");
+        return SKIP_TEST;
+    }
+
+    auto &ctx = RenderContext::get();
+    ctx.set_mode_3D();
+    ctx.matrix_model(Matrix::FromTranslationVector({0.0f, 0.0f, -1.0f}));
+
+    bool ok = true;
+    for (u32 f = 0; f < FRAMES && ok; f++) {
+        ctx.clear();
+
+        // Unchanged since last frame, yet last frame's region is fenced off
+        ctx.set_matrices();
+        if (!GI::uniform_block_current()) {
+            fprintf(stderr, "TEST FAILED! frame %u: clean draw left a stale block bound\n", f);
+            ok = false;
+        }
+        auto clean = bound_block();
+        auto cleanData = read_block(clean);
+
+        ctx.matrix_model(Matrix::FromTranslationVector({(float)f, 0.0f, -1.0f}));
+        ctx.set_matrices();
+        auto dirty = bound_block();
+
+        if (dirty.buffer == clean.buffer && dirty.start < clean.start + clean.size &&
+            clean.start < dirty.start + dirty.size) {
+            fprintf(stderr, "TEST FAILED! frame %u: dirty block overlaps the clean one\n", f);
+            ok = false;
+        }
+        if (read_block(clean) != cleanData) {
+            fprintf(stderr, "TEST FAILED! frame %u: clean block was overwritten\n", f);
+            ok = false;
+        }
+
+        ctx.render();
+    }
+
+    RenderContext::get().terminate();
+    if (ok)
+        printf("Clean and dirty blocks kept apart over %u frames\n", FRAMES);
+    return ok ? 0 : 1;
+}